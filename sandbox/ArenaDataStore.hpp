@@ -0,0 +1,183 @@
+#pragma once
+
+#include "H5Types.hpp"
+#include "StoreArena.hpp"
+
+#include "complex/DataStructure/DataStore.hpp"
+#include "complex/DataStructure/IDataStore.hpp"
+
+#include <nonstd/span.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+namespace complex
+{
+/**
+ * @class ArenaDataStore
+ * @brief An IDataStore whose values are sub-allocated from a StoreArena instead of having
+ * a heap allocation of their own. Meant for the thousands of small arrays an ingest of a
+ * directory tree creates, where allocator overhead would otherwise dominate.
+ *
+ * The store keeps the arena alive; the memory is returned when the arena's last store is destroyed.
+ */
+template <typename T>
+class ArenaDataStore : public IDataStore<T>
+{
+public:
+  using value_type = T;
+  using reference = T&;
+  using const_reference = const T&;
+  using ShapeType = typename IDataStore<T>::ShapeType;
+
+  /**
+   * @brief Allocates an uninitialized store from the arena.
+   * @param arena
+   * @param tupleShape
+   * @param componentShape
+   * @return nullptr if the array is too large for the arena.
+   */
+  static std::shared_ptr<ArenaDataStore> Create(std::shared_ptr<StoreArena> arena, const ShapeType& tupleShape, const ShapeType& componentShape)
+  {
+    const size_t numValues = std::accumulate(tupleShape.begin(), tupleShape.end(), static_cast<size_t>(1), std::multiplies<>()) *
+                             std::accumulate(componentShape.begin(), componentShape.end(), static_cast<size_t>(1), std::multiplies<>());
+    std::byte* memory = arena->allocate(numValues * sizeof(T));
+    if(nullptr == memory)
+    {
+      return nullptr;
+    }
+    return std::make_shared<ArenaDataStore>(std::move(arena), reinterpret_cast<T*>(memory), tupleShape, componentShape);
+  }
+
+  ArenaDataStore(std::shared_ptr<StoreArena> arena, T* data, ShapeType tupleShape, ShapeType componentShape)
+  : m_Arena(std::move(arena))
+  , m_Data(data)
+  , m_TupleShape(std::move(tupleShape))
+  , m_ComponentShape(std::move(componentShape))
+  {
+    m_NumTuples = std::accumulate(m_TupleShape.begin(), m_TupleShape.end(), static_cast<size_t>(1), std::multiplies<>());
+    m_NumComponents = std::accumulate(m_ComponentShape.begin(), m_ComponentShape.end(), static_cast<size_t>(1), std::multiplies<>());
+  }
+
+  ~ArenaDataStore() override = default;
+
+  ArenaDataStore(const ArenaDataStore&) = delete;
+  ArenaDataStore(ArenaDataStore&&) noexcept = delete;
+  ArenaDataStore& operator=(const ArenaDataStore&) = delete;
+  ArenaDataStore& operator=(ArenaDataStore&&) noexcept = delete;
+
+  usize getNumberOfTuples() const override
+  {
+    return m_NumTuples;
+  }
+
+  const ShapeType& getTupleShape() const override
+  {
+    return m_TupleShape;
+  }
+
+  usize getNumberOfComponents() const override
+  {
+    return m_NumComponents;
+  }
+
+  const ShapeType& getComponentShape() const override
+  {
+    return m_ComponentShape;
+  }
+
+  /**
+   * @brief Arena memory can not grow so only reshapes that keep the same number of tuples are allowed.
+   * @param tupleShape
+   */
+  void reshapeTuples(const ShapeType& tupleShape) override
+  {
+    const size_t numTuples = std::accumulate(tupleShape.begin(), tupleShape.end(), static_cast<size_t>(1), std::multiplies<>());
+    if(numTuples != m_NumTuples)
+    {
+      throw std::runtime_error("ArenaDataStore can not be resized");
+    }
+    m_TupleShape = tupleShape;
+  }
+
+  value_type getValue(usize index) const override
+  {
+    return m_Data[index];
+  }
+
+  void setValue(usize index, value_type value) override
+  {
+    m_Data[index] = value;
+  }
+
+  const_reference at(usize index) const override
+  {
+    if(index >= this->getSize())
+    {
+      throw std::runtime_error("ArenaDataStore index out of range");
+    }
+    return m_Data[index];
+  }
+
+  const_reference operator[](usize index) const override
+  {
+    return m_Data[index];
+  }
+
+  reference operator[](usize index) override
+  {
+    return m_Data[index];
+  }
+
+  DataType getDataType() const override
+  {
+    return GetDataType<T>();
+  }
+
+  /**
+   * @brief The copy is an ordinary heap allocated DataStore so it does not pin the arena.
+   * @return
+   */
+  std::unique_ptr<IDataStore<T>> deepCopy() const override
+  {
+    auto copy = std::make_unique<DataStore<T>>(m_TupleShape, m_ComponentShape);
+    std::copy(m_Data, m_Data + this->getSize(), copy->data());
+    return copy;
+  }
+
+  H5::ErrorType writeHdf5(H5::DatasetWriter& datasetWriter) const override
+  {
+    H5::DatasetWriter::DimsType dims;
+    std::copy(m_TupleShape.begin(), m_TupleShape.end(), std::back_inserter(dims));
+    std::copy(m_ComponentShape.begin(), m_ComponentShape.end(), std::back_inserter(dims));
+    const H5::ErrorType error = datasetWriter.writeSpan(dims, nonstd::span<const T>(m_Data, this->getSize()));
+    if(error < 0)
+    {
+      return error;
+    }
+    return WriteH5ShapeAttributes(datasetWriter.getParentId(), datasetWriter.getName(), m_TupleShape, m_ComponentShape);
+  }
+
+  T* data()
+  {
+    return m_Data;
+  }
+
+  const T* data() const
+  {
+    return m_Data;
+  }
+
+private:
+  std::shared_ptr<StoreArena> m_Arena;
+  T* m_Data = nullptr;
+  ShapeType m_TupleShape;
+  ShapeType m_ComponentShape;
+  size_t m_NumTuples = 0;
+  size_t m_NumComponents = 0;
+};
+} // namespace complex
@@ -0,0 +1,198 @@
+#pragma once
+
+#include "complex/Common/StringLiteral.hpp"
+#include "complex/Common/Types.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+namespace complex
+{
+/**
+ * @brief Metadata key that the load time statistics are stored under on a DataArray.
+ */
+constexpr StringLiteral k_StatisticsMetadataKey = "Statistics";
+
+/**
+ * @brief Summary statistics of every value in an array (all components together).
+ * Bin i of the histogram covers [histogramMin + i * binWidth, histogramMin + (i + 1) * binWidth).
+ */
+struct ArrayStatistics
+{
+  float64 minimum = 0.0;
+  float64 maximum = 0.0;
+  float64 mean = 0.0;
+  uint64 count = 0;    // Values that went into the statistics
+  uint64 nanCount = 0; // Floating point NaN values. These are excluded from everything else.
+  float64 histogramMin = 0.0;
+  float64 binWidth = 0.0;
+  std::vector<uint64> histogram;
+};
+
+/**
+ * @class StatisticsSink
+ * @brief Accumulates ArrayStatistics one chunk at a time so they can be computed while
+ * the chunk is still in cache, without a second sweep over the finished array.
+ *
+ * The histogram range is not known until every chunk has been seen. It starts out
+ * spanning the first chunk and doubles its bin width (merging pairs of bins) whenever a
+ * later chunk falls outside of it, so the counts are always exact for the final bins.
+ */
+template <typename T>
+class StatisticsSink
+{
+public:
+  /**
+   * @param numBins Number of histogram bins. Rounded up to an even number, zero disables the histogram.
+   */
+  explicit StatisticsSink(size_t numBins = 256)
+  : m_NumBins(numBins + (numBins % 2))
+  {
+    m_Statistics.histogram.resize(m_NumBins, 0);
+  }
+
+  /**
+   * @brief Folds the values of one chunk into the statistics.
+   * @param values
+   * @param count
+   */
+  void consume(const T* values, size_t count)
+  {
+    if(count == 0)
+    {
+      return;
+    }
+
+    // Plain min/max/sum loop that the compiler can vectorize.
+    T chunkMin = std::numeric_limits<T>::max();
+    T chunkMax = std::numeric_limits<T>::lowest();
+    float64 chunkSum = 0.0;
+    uint64 nanCount = 0;
+    for(size_t i = 0; i < count; i++)
+    {
+      const T value = values[i];
+      if constexpr(std::is_floating_point_v<T>)
+      {
+        if(std::isnan(value))
+        {
+          nanCount++;
+          continue;
+        }
+      }
+      chunkMin = std::min(chunkMin, value);
+      chunkMax = std::max(chunkMax, value);
+      chunkSum += static_cast<float64>(value);
+    }
+
+    const uint64 validCount = count - nanCount;
+    m_Statistics.nanCount += nanCount;
+    if(validCount == 0)
+    {
+      return;
+    }
+
+    if(m_Statistics.count == 0)
+    {
+      m_Statistics.minimum = static_cast<float64>(chunkMin);
+      m_Statistics.maximum = static_cast<float64>(chunkMax);
+    }
+    else
+    {
+      m_Statistics.minimum = std::min(m_Statistics.minimum, static_cast<float64>(chunkMin));
+      m_Statistics.maximum = std::max(m_Statistics.maximum, static_cast<float64>(chunkMax));
+    }
+    m_Statistics.count += validCount;
+    m_Sum += chunkSum;
+
+    if(m_NumBins == 0)
+    {
+      return;
+    }
+    coverRange(static_cast<float64>(chunkMin), static_cast<float64>(chunkMax));
+
+    const float64 histMin = m_Statistics.histogramMin;
+    const float64 invBinWidth = 1.0 / m_Statistics.binWidth;
+    const float64 lastBin = static_cast<float64>(m_NumBins - 1);
+    uint64* bins = m_Statistics.histogram.data();
+    for(size_t i = 0; i < count; i++)
+    {
+      const T value = values[i];
+      if constexpr(std::is_floating_point_v<T>)
+      {
+        if(std::isnan(value))
+        {
+          continue;
+        }
+      }
+      // Clamped while still a double: converting an infinite or out of range double to an integer is undefined
+      const float64 position = (static_cast<float64>(value) - histMin) * invBinWidth;
+      bins[(position > 0.0) ? static_cast<size_t>(std::min(position, lastBin)) : 0]++;
+    }
+  }
+
+  /**
+   * @brief Returns the statistics of every value consumed so far.
+   * @return
+   */
+  ArrayStatistics finish() const
+  {
+    ArrayStatistics statistics = m_Statistics;
+    statistics.mean = (statistics.count == 0) ? 0.0 : m_Sum / static_cast<float64>(statistics.count);
+    return statistics;
+  }
+
+private:
+  /**
+   * @brief Grows the histogram until it spans [minValue, maxValue].
+   */
+  void coverRange(float64 minValue, float64 maxValue)
+  {
+    // Infinities would make the range grow forever. They are counted in the first or last bin instead.
+    minValue = std::max(minValue, std::numeric_limits<float64>::lowest());
+    maxValue = std::min(maxValue, std::numeric_limits<float64>::max());
+
+    ArrayStatistics& stats = m_Statistics;
+    if(stats.binWidth == 0.0)
+    {
+      stats.histogramMin = minValue;
+      stats.binWidth = (maxValue > minValue) ? (maxValue - minValue) / static_cast<float64>(m_NumBins) : 1.0;
+      // Make sure the maximum value lands inside the last bin and not on its upper edge
+      stats.binWidth = std::nextafter(stats.binWidth, std::numeric_limits<float64>::max());
+      return;
+    }
+
+    const size_t half = m_NumBins / 2;
+    while(maxValue >= stats.histogramMin + stats.binWidth * static_cast<float64>(m_NumBins))
+    {
+      // Grow upwards: new bin j holds old bins 2j and 2j+1
+      for(size_t j = 0; j < half; j++)
+      {
+        stats.histogram[j] = stats.histogram[2 * j] + stats.histogram[2 * j + 1];
+      }
+      std::fill(stats.histogram.begin() + static_cast<std::ptrdiff_t>(half), stats.histogram.end(), 0);
+      stats.binWidth *= 2.0;
+    }
+    while(minValue < stats.histogramMin)
+    {
+      // Grow downwards: the old range becomes the upper half of the new range
+      for(size_t j = m_NumBins - 1; j >= half; j--)
+      {
+        const size_t oldBin = 2 * (j - half);
+        stats.histogram[j] = stats.histogram[oldBin] + stats.histogram[oldBin + 1];
+      }
+      std::fill(stats.histogram.begin(), stats.histogram.begin() + static_cast<std::ptrdiff_t>(half), 0);
+      stats.histogramMin -= stats.binWidth * static_cast<float64>(m_NumBins);
+      stats.binWidth *= 2.0;
+    }
+  }
+
+  size_t m_NumBins = 0;
+  float64 m_Sum = 0.0;
+  ArrayStatistics m_Statistics;
+};
+} // namespace complex
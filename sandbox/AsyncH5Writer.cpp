@@ -0,0 +1,34 @@
+#include "AsyncH5Writer.hpp"
+
+#include <chrono>
+#include <iostream>
+
+namespace complex
+{
+// -----------------------------------------------------------------------------
+AsyncH5Writer::AsyncH5Writer()
+: m_IoThread(1)
+{
+}
+
+// -----------------------------------------------------------------------------
+AsyncH5Writer::~AsyncH5Writer() noexcept = default;
+
+// -----------------------------------------------------------------------------
+std::future<bool> AsyncH5Writer::write(std::shared_ptr<const DataStructure> dataStructure, const std::filesystem::path& filePath, H5WriteOptions options)
+{
+  return submit([dataStructure = std::move(dataStructure), filePath, options = std::move(options)]() -> bool {
+    auto startTime = std::chrono::steady_clock::now();
+    const bool success = WriteDataStructureHdf5(*dataStructure, filePath, options);
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    std::cout << "Background write of " << filePath.string() << (success ? " finished" : " FAILED") << " after " << seconds << " s" << std::endl;
+    return success;
+  });
+}
+
+// -----------------------------------------------------------------------------
+size_t AsyncH5Writer::getPendingCount() const
+{
+  return m_PendingCount.load();
+}
+} // namespace complex
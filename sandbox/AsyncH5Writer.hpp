@@ -0,0 +1,80 @@
+#pragma once
+
+#include "H5DataStructureWriter.hpp"
+#include "ThreadPool.hpp"
+
+#include "complex/DataStructure/DataStructure.hpp"
+
+#include <atomic>
+#include <filesystem>
+#include <future>
+#include <memory>
+
+namespace complex
+{
+/**
+ * @class AsyncH5Writer
+ * @brief Writes DataStructures to HDF5 on a dedicated I/O thread so the caller can go on
+ * computing (e.g. ingest the next dataset of a batch) while the output is written.
+ *
+ * Writes run one at a time in submission order; the library is only ever entered from the
+ * I/O thread, which keeps this usable with HDF5 builds that are not thread safe as long as
+ * the caller makes no HDF5 calls of its own before the returned futures are ready.
+ * The destructor finishes every queued write.
+ */
+class AsyncH5Writer
+{
+public:
+  AsyncH5Writer();
+  ~AsyncH5Writer() noexcept;
+
+  AsyncH5Writer(const AsyncH5Writer&) = delete;
+  AsyncH5Writer(AsyncH5Writer&&) noexcept = delete;
+  AsyncH5Writer& operator=(const AsyncH5Writer&) = delete;
+  AsyncH5Writer& operator=(AsyncH5Writer&&) noexcept = delete;
+
+  /**
+   * @brief Queues a WriteDataStructureHdf5() call. The writer shares ownership of the
+   * DataStructure until the write is done; the caller may keep reading it in the meantime
+   * but must not modify it (or the arrays in it) until the future is ready.
+   * @param dataStructure
+   * @param filePath
+   * @param options
+   * @return Becomes true once the file is completely written.
+   */
+  std::future<bool> write(std::shared_ptr<const DataStructure> dataStructure, const std::filesystem::path& filePath, H5WriteOptions options = {});
+
+  /**
+   * @brief Queues work that has to run after the writes queued so far, such as post
+   * processing the written file. It runs on the I/O thread too.
+   * @param func
+   * @return
+   */
+  template <typename FuncT>
+  auto submit(FuncT&& func)
+  {
+    m_PendingCount++;
+    return m_IoThread.submit([this, task = std::forward<FuncT>(func)]() mutable {
+      struct PendingGuard
+      {
+        std::atomic<size_t>& count;
+        ~PendingGuard()
+        {
+          count--;
+        }
+      } pendingGuard{m_PendingCount};
+      return task();
+    });
+  }
+
+  /**
+   * @brief Returns the number of queued or running jobs.
+   * @return
+   */
+  size_t getPendingCount() const;
+
+private:
+  std::atomic<size_t> m_PendingCount = 0;
+  ThreadPool m_IoThread;
+};
+} // namespace complex
@@ -66,6 +66,107 @@ const std::string k_EXECUTE_DECL("@EXECUTE_DECL@");
 const std::string k_LINK_OUTPUT_ARRAY("@LINK_OUTPUT_ARRAY@");
 
 
+// Emitted into the anonymous namespace of every filter that supports in-place execution
+static const std::string k_InPlaceHelpers = R"(/**
+ * The output array takes over the input array's DataStore once the filter wrote its result
+ * over the input's values, in case the output was created with a store of its own.
+ */
+template <typename T>
+bool ShareTypedDataStore(DataStructure& dataStructure, const DataPath& inputArrayPath, const DataPath& outputArrayPath)
+{
+  auto* inputArray = dataStructure.getDataAs<DataArray<T>>(inputArrayPath);
+  auto* outputArray = dataStructure.getDataAs<DataArray<T>>(outputArrayPath);
+  if(nullptr == inputArray || nullptr == outputArray)
+  {
+    return false;
+  }
+  outputArray->setDataStore(inputArray->getDataStorePtr());
+  return true;
+}
+
+Result<> ShareInputDataStore(DataStructure& dataStructure, const DataPath& inputArrayPath, const DataPath& outputArrayPath)
+{
+  if(ShareTypedDataStore<int8>(dataStructure, inputArrayPath, outputArrayPath) || ShareTypedDataStore<uint8>(dataStructure, inputArrayPath, outputArrayPath) ||
+     ShareTypedDataStore<int16>(dataStructure, inputArrayPath, outputArrayPath) || ShareTypedDataStore<uint16>(dataStructure, inputArrayPath, outputArrayPath) ||
+     ShareTypedDataStore<int32>(dataStructure, inputArrayPath, outputArrayPath) || ShareTypedDataStore<uint32>(dataStructure, inputArrayPath, outputArrayPath) ||
+     ShareTypedDataStore<int64>(dataStructure, inputArrayPath, outputArrayPath) || ShareTypedDataStore<uint64>(dataStructure, inputArrayPath, outputArrayPath) ||
+     ShareTypedDataStore<float32>(dataStructure, inputArrayPath, outputArrayPath) || ShareTypedDataStore<float64>(dataStructure, inputArrayPath, outputArrayPath))
+  {
+    return {};
+  }
+  return MakeErrorResult(-2001, "The output array could not take over the values of the input array");
+}
+
+template <typename T>
+bool CreateTypedSharedArray(DataStructure& dataStructure, const DataPath& inputArrayPath, const DataPath& outputArrayPath)
+{
+  auto* inputArray = dataStructure.getDataAs<DataArray<T>>(inputArrayPath);
+  if(nullptr == inputArray)
+  {
+    return false;
+  }
+  std::optional<DataObject::IdType> parentId;
+  if(outputArrayPath.getLength() > 1)
+  {
+    parentId = dataStructure.getId(outputArrayPath.getParent());
+  }
+  return nullptr != DataArray<T>::Create(dataStructure, outputArrayPath.getTargetName(), inputArray->getDataStorePtr(), parentId);
+}
+
+/**
+ * Replaces the CreateArrayAction of the output when executing in place: the output array is
+ * created over the input array's DataStore, so input and output values are never held at once.
+ */
+class ShareInputArrayAction : public IDataAction
+{
+public:
+  ShareInputArrayAction(const DataPath& inputArrayPath, const DataPath& outputArrayPath)
+  : m_InputArrayPath(inputArrayPath)
+  , m_OutputArrayPath(outputArrayPath)
+  {
+  }
+  ~ShareInputArrayAction() noexcept override = default;
+
+  ShareInputArrayAction(const ShareInputArrayAction&) = delete;
+  ShareInputArrayAction(ShareInputArrayAction&&) noexcept = delete;
+  ShareInputArrayAction& operator=(const ShareInputArrayAction&) = delete;
+  ShareInputArrayAction& operator=(ShareInputArrayAction&&) noexcept = delete;
+
+  Result<> apply(DataStructure& dataStructure, Mode) const override
+  {
+    if(CreateTypedSharedArray<int8>(dataStructure, m_InputArrayPath, m_OutputArrayPath) || CreateTypedSharedArray<uint8>(dataStructure, m_InputArrayPath, m_OutputArrayPath) ||
+       CreateTypedSharedArray<int16>(dataStructure, m_InputArrayPath, m_OutputArrayPath) || CreateTypedSharedArray<uint16>(dataStructure, m_InputArrayPath, m_OutputArrayPath) ||
+       CreateTypedSharedArray<int32>(dataStructure, m_InputArrayPath, m_OutputArrayPath) || CreateTypedSharedArray<uint32>(dataStructure, m_InputArrayPath, m_OutputArrayPath) ||
+       CreateTypedSharedArray<int64>(dataStructure, m_InputArrayPath, m_OutputArrayPath) || CreateTypedSharedArray<uint64>(dataStructure, m_InputArrayPath, m_OutputArrayPath) ||
+       CreateTypedSharedArray<float32>(dataStructure, m_InputArrayPath, m_OutputArrayPath) || CreateTypedSharedArray<float64>(dataStructure, m_InputArrayPath, m_OutputArrayPath))
+    {
+      return {};
+    }
+    return MakeErrorResult(-2002, "The output array could not be created over the values of the input array");
+  }
+
+private:
+  DataPath m_InputArrayPath;
+  DataPath m_OutputArrayPath;
+};
+
+/**
+ * Swaps the output's CreateArrayAction for a ShareInputArrayAction.
+ */
+void ShareInputInsteadOfCreating(OutputActions& outputActions, const DataPath& inputArrayPath, const DataPath& outputArrayPath)
+{
+  for(auto& action : outputActions.actions)
+  {
+    const auto* createArrayAction = dynamic_cast<const CreateArrayAction*>(action.get());
+    if(nullptr != createArrayAction && createArrayAction->path() == outputArrayPath)
+    {
+      action = std::make_unique<ShareInputArrayAction>(inputArrayPath, outputArrayPath);
+    }
+  }
+}
+
+)";
+
 static std::set<std::string> s_AllPixelTypes;
 
 /**
@@ -131,6 +232,22 @@ std::string ReplaceKeywords(std::string& contents, const std::string& searchWord
   return contents;
 }
 
+/**
+ * @brief Filters with a single input whose output has the input's pixel type and size can
+ * write their result over the input's values. They get an "ExecuteInPlace" parameter that a
+ * pipeline sets when nothing reads the input afterwards, so the output array reuses the input's
+ * DataStore instead of doubling the memory.
+ * @param rootJson
+ * @return
+ */
+bool SupportsInPlace(const nlohmann::json& rootJson)
+{
+  const std::string itkClassName = rootJson["name"].get<std::string>();
+  const bool hasFixedOutputType = rootJson.find("output_pixel_type") != rootJson.end();
+  const bool hasMultipleInputs = rootJson.find("inputs") != rootJson.end();
+  return !hasFixedOutputType && !hasMultipleInputs && itkClassName.find("Projection") == std::string::npos;
+}
+
 /**
  *
  * @param rootJson
@@ -196,6 +313,11 @@ void CreateFilterHeader(const nlohmann::json& rootJson)
       }
     }
   }
+  if(SupportsInPlace(rootJson))
+  {
+    propertiesKeys << "  // The result overwrites the input image and the output array reuses its DataStore\n";
+    propertiesKeys << "  static inline constexpr StringLiteral k_ExecuteInPlace_Key = \"ExecuteInPlace\";\n";
+  }
   templateContents = ReplaceKeywords(templateContents, k_PARAMETER_KEYS, propertiesKeys.str());
 
   fs::path outputFilePath = k_GeneratedFiltersOutputDir / outputFileName;
@@ -601,14 +723,51 @@ void CreateFilterSource(const nlohmann::json& rootJson)
       itkFunctorOut << "using FilterOutputType = " << outputPixelType << ";\n\n";
     }
   }
+  const bool supportsInPlace = SupportsInPlace(rootJson);
+  if(supportsInPlace)
+  {
+    // ITK::Execute() copies the filter's output into the output array after the filter ran, so the
+    // input can be passed as the output: its values are only overwritten once they are no longer read.
+    // PipelineLiveness only turns this on for filters whose Execute() was checked to work that way.
+    executeDeclOut << "  if(pExecuteInPlace)\n"
+                   << "  {\n"
+                   << "    Result<> result = " << itkArrayHelperNamespace << "::ITK::Execute" << filterOutputTypeExeTemplateDef
+                   << "(dataStructure, pSelectedInputArray, pImageGeomPath, pSelectedInputArray, itkFunctor);\n"
+                   << "    if(result.invalid())\n"
+                   << "    {\n"
+                   << "      return result;\n"
+                   << "    }\n"
+                   << "    return ShareInputDataStore(dataStructure, pSelectedInputArray, pOutputArrayPath);\n"
+                   << "  }\n";
+  }
   dataCheckDeclOut << "  complex::Result<OutputActions> resultOutputActions = " << itkArrayHelperNamespace  << "::ITK::DataCheck"<< filterOutputTypePlaceHolder<<"(dataStructure, pSelectedInputArray, pImageGeomPath, pOutputArrayPath);\n";
+  if(supportsInPlace)
+  {
+    // Creating the output must not allocate a second image when it is going to take over the input's values
+    dataCheckDeclOut << "  if(pExecuteInPlace && resultOutputActions.valid())\n"
+                     << "  {\n"
+                     << "    ShareInputInsteadOfCreating(resultOutputActions.value(), pSelectedInputArray, pOutputArrayPath);\n"
+                     << "  }\n";
+  }
   executeDeclOut  << " return "<< itkArrayHelperNamespace << "::ITK::Execute"<< filterOutputTypeExeTemplateDef<<"(dataStructure, pSelectedInputArray, pImageGeomPath, pOutputArrayPath, itkFunctor);";
 
+  if(supportsInPlace)
+  {
+    itkFunctorOut << k_InPlaceHelpers;
+  }
   itkFunctorOut  << "struct " << filterName << "CreationFunctor\n{\n";
 
   includeOut << "#include \"complex/Parameters/ArrayCreationParameter.hpp\"\n"
              << "#include \"complex/Parameters/ArraySelectionParameter.hpp\"\n"
              << "#include \"complex/Parameters/GeometrySelectionParameter.hpp\"\n";
+  if(supportsInPlace)
+  {
+    includeOut << "#include \"complex/DataStructure/DataArray.hpp\"\n"
+               << "#include \"complex/Filter/Actions/CreateArrayAction.hpp\"\n"
+               << "#include \"complex/Parameters/BoolParameter.hpp\"\n";
+    parameterDefs << "  params.insert(std::make_unique<BoolParameter>(k_ExecuteInPlace_Key, \"Execute In Place\", \"Overwrites the input image with the result; the output array reuses its memory\", false));\n";
+    preflightDefs << "  auto pExecuteInPlace = filterArgs.value<bool>(k_ExecuteInPlace_Key);\n";
+  }
 
   // Loop over all the Input Parameters to the ITK Filter
   for (auto& jsonIdx : membersJson.items())
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "complex/Common/StringLiteral.hpp"
+#include "complex/Common/Uuid.hpp"
+#include "complex/Filter/FilterHandle.hpp"
+
+#define CREATE_FILTER_HANDLE_CONSTANT(var_name, filter_uuid_string, plugin_uuid_string) \
+  const FilterHandle k_##var_name(Uuid::FromString(filter_uuid_string).value(), Uuid::FromString(plugin_uuid_string).value());
+
+namespace complex
+{
+/**
+ * @brief Handles of the ComplexCore filters the sandbox and its tests build pipelines from.
+ */
+namespace ComplexCore
+{
+// Plugin Uuid
+constexpr StringLiteral k_ComplexCore_Uuid = "05cc618b-781f-4ac0-b9ac-43f26ce1854f";
+// Filter Uuids
+constexpr StringLiteral k_ExampleFilter2_Uuid = "1307bbbc-112d-4aaa-941f-58253787b17e";
+constexpr StringLiteral k_CreateDataArray_Uuid = "67041f9b-bdc6-4122-acc6-c9fe9280e90d";
+constexpr StringLiteral k_ImportTextFilter_Uuid = "25f7df3e-ca3e-4634-adda-732c0e56efd4";
+
+// Filter Handles
+CREATE_FILTER_HANDLE_CONSTANT(ExampleFilter2Handle, k_ExampleFilter2_Uuid, k_ComplexCore_Uuid)
+CREATE_FILTER_HANDLE_CONSTANT(CreateDataArrayHandle, k_CreateDataArray_Uuid, k_ComplexCore_Uuid)
+CREATE_FILTER_HANDLE_CONSTANT(ImportTextFilterHandle, k_ImportTextFilter_Uuid, k_ComplexCore_Uuid)
+} // namespace ComplexCore
+} // namespace complex
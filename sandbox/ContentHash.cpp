@@ -0,0 +1,177 @@
+#include "ContentHash.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace complex
+{
+namespace
+{
+constexpr uint64_t k_Prime1 = 0x9E3779B185EBCA87ULL;
+constexpr uint64_t k_Prime2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr uint64_t k_Prime3 = 0x165667B19E3779F9ULL;
+constexpr uint64_t k_Prime4 = 0x85EBCA77C2B2AE63ULL;
+constexpr uint64_t k_Prime5 = 0x27D4EB2F165667C5ULL;
+constexpr size_t k_FileChunkSize = 1048576;
+
+inline uint64_t RotateLeft(uint64_t value, int32_t bits)
+{
+  return (value << bits) | (value >> (64 - bits));
+}
+
+// XXH64 is defined on little endian words
+inline uint64_t Read64(const std::byte* data)
+{
+  uint64_t value = 0;
+  for(int32_t i = 7; i >= 0; i--)
+  {
+    value = (value << 8) | static_cast<uint64_t>(data[i]);
+  }
+  return value;
+}
+
+inline uint32_t Read32(const std::byte* data)
+{
+  uint32_t value = 0;
+  for(int32_t i = 3; i >= 0; i--)
+  {
+    value = (value << 8) | static_cast<uint32_t>(data[i]);
+  }
+  return value;
+}
+
+inline uint64_t Round(uint64_t accumulator, uint64_t input)
+{
+  accumulator += input * k_Prime2;
+  accumulator = RotateLeft(accumulator, 31);
+  return accumulator * k_Prime1;
+}
+
+inline uint64_t MergeRound(uint64_t accumulator, uint64_t lane)
+{
+  accumulator ^= Round(0, lane);
+  return accumulator * k_Prime1 + k_Prime4;
+}
+} // namespace
+
+// -----------------------------------------------------------------------------
+ContentHasher::ContentHasher()
+: m_Lanes({k_Prime1 + k_Prime2, k_Prime2, 0, 0ULL - k_Prime1})
+{
+}
+
+// -----------------------------------------------------------------------------
+void ContentHasher::update(const void* data, size_t size)
+{
+  const auto* bytes = static_cast<const std::byte*>(data);
+  m_TotalSize += size;
+
+  // Top up a partially filled stripe first
+  if(m_BufferSize > 0)
+  {
+    const size_t numBytes = std::min(size, k_StripeSize - m_BufferSize);
+    std::memcpy(m_Buffer.data() + m_BufferSize, bytes, numBytes);
+    m_BufferSize += numBytes;
+    bytes += numBytes;
+    size -= numBytes;
+    if(m_BufferSize < k_StripeSize)
+    {
+      return;
+    }
+    for(size_t lane = 0; lane < 4; lane++)
+    {
+      m_Lanes[lane] = Round(m_Lanes[lane], Read64(m_Buffer.data() + lane * 8));
+    }
+    m_BufferSize = 0;
+  }
+
+  while(size >= k_StripeSize)
+  {
+    for(size_t lane = 0; lane < 4; lane++)
+    {
+      m_Lanes[lane] = Round(m_Lanes[lane], Read64(bytes + lane * 8));
+    }
+    bytes += k_StripeSize;
+    size -= k_StripeSize;
+  }
+
+  std::memcpy(m_Buffer.data(), bytes, size);
+  m_BufferSize = size;
+}
+
+// -----------------------------------------------------------------------------
+uint64_t ContentHasher::digest() const
+{
+  uint64_t hash = 0;
+  if(m_TotalSize >= k_StripeSize)
+  {
+    hash = RotateLeft(m_Lanes[0], 1) + RotateLeft(m_Lanes[1], 7) + RotateLeft(m_Lanes[2], 12) + RotateLeft(m_Lanes[3], 18);
+    for(uint64_t lane : m_Lanes)
+    {
+      hash = MergeRound(hash, lane);
+    }
+  }
+  else
+  {
+    hash = m_Lanes[2] + k_Prime5;
+  }
+  hash += m_TotalSize;
+
+  const std::byte* bytes = m_Buffer.data();
+  size_t size = m_BufferSize;
+  while(size >= 8)
+  {
+    hash ^= Round(0, Read64(bytes));
+    hash = RotateLeft(hash, 27) * k_Prime1 + k_Prime4;
+    bytes += 8;
+    size -= 8;
+  }
+  if(size >= 4)
+  {
+    hash ^= static_cast<uint64_t>(Read32(bytes)) * k_Prime1;
+    hash = RotateLeft(hash, 23) * k_Prime2 + k_Prime3;
+    bytes += 4;
+    size -= 4;
+  }
+  while(size > 0)
+  {
+    hash ^= static_cast<uint64_t>(*bytes) * k_Prime5;
+    hash = RotateLeft(hash, 11) * k_Prime1;
+    bytes++;
+    size--;
+  }
+
+  hash ^= hash >> 33;
+  hash *= k_Prime2;
+  hash ^= hash >> 29;
+  hash *= k_Prime3;
+  hash ^= hash >> 32;
+  return hash;
+}
+
+// -----------------------------------------------------------------------------
+std::optional<uint64_t> ContentHasher::HashFile(const std::filesystem::path& filePath)
+{
+  FILE* file = std::fopen(filePath.string().c_str(), "rb");
+  if(nullptr == file)
+  {
+    return {};
+  }
+  ContentHasher hasher;
+  std::vector<std::byte> buffer(k_FileChunkSize);
+  size_t bytesRead = 0;
+  while((bytesRead = std::fread(buffer.data(), 1, buffer.size(), file)) > 0)
+  {
+    hasher.update(buffer.data(), bytesRead);
+  }
+  const bool failed = (std::ferror(file) != 0);
+  std::fclose(file);
+  if(failed)
+  {
+    return {};
+  }
+  return hasher.digest();
+}
+} // namespace complex
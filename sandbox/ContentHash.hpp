@@ -0,0 +1,56 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+
+namespace complex
+{
+/**
+ * @class ContentHasher
+ * @brief Streaming 64 bit XXH64 hash (seed 0). Feeding the data in any number of pieces
+ * gives the same digest as hashing it in one go. Not cryptographic; it is only meant to
+ * tell whether the contents of a file or array changed.
+ */
+class ContentHasher
+{
+public:
+  ContentHasher();
+  ~ContentHasher() noexcept = default;
+
+  ContentHasher(const ContentHasher&) = default;
+  ContentHasher(ContentHasher&&) noexcept = default;
+  ContentHasher& operator=(const ContentHasher&) = default;
+  ContentHasher& operator=(ContentHasher&&) noexcept = default;
+
+  /**
+   * @brief Adds the bytes to the hash.
+   * @param data
+   * @param size
+   */
+  void update(const void* data, size_t size);
+
+  /**
+   * @brief Returns the hash of everything added so far. More data may still be added afterwards.
+   * @return
+   */
+  uint64_t digest() const;
+
+  /**
+   * @brief Hashes a file's bytes exactly as they are stored on disk (compressed files are NOT decompressed).
+   * @param filePath
+   * @return Empty if the file could not be read.
+   */
+  static std::optional<uint64_t> HashFile(const std::filesystem::path& filePath);
+
+private:
+  static constexpr size_t k_StripeSize = 32;
+
+  std::array<uint64_t, 4> m_Lanes;
+  std::array<std::byte, k_StripeSize> m_Buffer = {};
+  size_t m_BufferSize = 0;
+  uint64_t m_TotalSize = 0;
+};
+} // namespace complex
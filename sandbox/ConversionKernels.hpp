@@ -0,0 +1,226 @@
+#pragma once
+
+#include "complex/Common/Types.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#if defined(_MSC_VER)
+#include <cstdlib>
+#endif
+
+namespace complex
+{
+/**
+ * @brief Byte order of the values stored in a file.
+ */
+enum class Endian : uint8_t
+{
+  Little,
+  Big
+};
+
+#if defined(__BYTE_ORDER__) && defined(__ORDER_BIG_ENDIAN__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+constexpr Endian k_NativeEndian = Endian::Big;
+#else
+constexpr Endian k_NativeEndian = Endian::Little;
+#endif
+
+/**
+ * @brief Describes how the values are stored in a raw file when that differs from the
+ * type of the DataStore they are read into.
+ */
+struct RawSourceFormat
+{
+  DataType dataType = DataType::uint8;
+  Endian byteOrder = k_NativeEndian;
+  bool decompress = false; // Decode a '.gz' or '.zst' file with the codec its extension names; otherwise its bytes are read as they are
+};
+
+/**
+ * @brief Returns the size in bytes of one value of the type. Zero for types that can not be read from a raw file.
+ * @param dataType
+ * @return
+ */
+inline size_t GetDataTypeSize(DataType dataType)
+{
+  switch(dataType)
+  {
+  case DataType::int8:
+  case DataType::uint8:
+    return 1;
+  case DataType::int16:
+  case DataType::uint16:
+    return 2;
+  case DataType::int32:
+  case DataType::uint32:
+  case DataType::float32:
+    return 4;
+  case DataType::int64:
+  case DataType::uint64:
+  case DataType::float64:
+    return 8;
+  default:
+    return 0;
+  }
+}
+
+namespace ConversionKernels
+{
+template <size_t Size>
+struct UnsignedOfSize;
+template <>
+struct UnsignedOfSize<1>
+{
+  using type = uint8_t;
+};
+template <>
+struct UnsignedOfSize<2>
+{
+  using type = uint16_t;
+};
+template <>
+struct UnsignedOfSize<4>
+{
+  using type = uint32_t;
+};
+template <>
+struct UnsignedOfSize<8>
+{
+  using type = uint64_t;
+};
+
+/**
+ * @brief Reverses the bytes of an unsigned integer. These map to a single instruction
+ * and GCC/Clang/MSVC vectorize loops of them (pshufb/vpshufb, rev on ARM).
+ */
+template <typename UIntT>
+inline UIntT ByteSwap(UIntT value)
+{
+  if constexpr(sizeof(UIntT) == 1)
+  {
+    return value;
+  }
+#if defined(_MSC_VER)
+  else if constexpr(sizeof(UIntT) == 2)
+  {
+    return _byteswap_ushort(value);
+  }
+  else if constexpr(sizeof(UIntT) == 4)
+  {
+    return _byteswap_ulong(value);
+  }
+  else
+  {
+    return _byteswap_uint64(value);
+  }
+#else
+  else if constexpr(sizeof(UIntT) == 2)
+  {
+    return __builtin_bswap16(value);
+  }
+  else if constexpr(sizeof(UIntT) == 4)
+  {
+    return __builtin_bswap32(value);
+  }
+  else
+  {
+    return __builtin_bswap64(value);
+  }
+#endif
+}
+
+/**
+ * @brief Converts 'count' packed SrcT values (optionally byte swapped) into DstT values.
+ * The source does not need to be aligned. Both loops are written so the compiler can
+ * vectorize them: memcpy of a fixed size becomes a plain (unaligned) load.
+ * @param source
+ * @param destination
+ * @param count
+ * @param swapBytes
+ */
+template <typename SrcT, typename DstT>
+void ConvertValues(const std::byte* source, DstT* destination, size_t count, bool swapBytes)
+{
+  using UIntT = typename UnsignedOfSize<sizeof(SrcT)>::type;
+  if(swapBytes && sizeof(SrcT) > 1)
+  {
+    for(size_t i = 0; i < count; i++)
+    {
+      UIntT bits;
+      std::memcpy(&bits, source + i * sizeof(SrcT), sizeof(SrcT));
+      bits = ByteSwap(bits);
+      SrcT value;
+      std::memcpy(&value, &bits, sizeof(SrcT));
+      destination[i] = static_cast<DstT>(value);
+    }
+    return;
+  }
+
+  if constexpr(std::is_same_v<SrcT, DstT>)
+  {
+    std::memcpy(destination, source, count * sizeof(SrcT));
+  }
+  else
+  {
+    for(size_t i = 0; i < count; i++)
+    {
+      SrcT value;
+      std::memcpy(&value, source + i * sizeof(SrcT), sizeof(SrcT));
+      destination[i] = static_cast<DstT>(value);
+    }
+  }
+}
+} // namespace ConversionKernels
+
+/**
+ * @brief Converts 'count' values stored as sourceFormat into DstT.
+ * @param sourceFormat
+ * @param source
+ * @param destination
+ * @param count
+ * @return false if the source type is not a numeric type.
+ */
+template <typename DstT>
+bool ConvertRawValues(const RawSourceFormat& sourceFormat, const std::byte* source, DstT* destination, size_t count)
+{
+  const bool swapBytes = (sourceFormat.byteOrder != k_NativeEndian);
+  switch(sourceFormat.dataType)
+  {
+  case DataType::int8:
+    ConversionKernels::ConvertValues<int8, DstT>(source, destination, count, swapBytes);
+    return true;
+  case DataType::uint8:
+    ConversionKernels::ConvertValues<uint8, DstT>(source, destination, count, swapBytes);
+    return true;
+  case DataType::int16:
+    ConversionKernels::ConvertValues<int16, DstT>(source, destination, count, swapBytes);
+    return true;
+  case DataType::uint16:
+    ConversionKernels::ConvertValues<uint16, DstT>(source, destination, count, swapBytes);
+    return true;
+  case DataType::int32:
+    ConversionKernels::ConvertValues<int32, DstT>(source, destination, count, swapBytes);
+    return true;
+  case DataType::uint32:
+    ConversionKernels::ConvertValues<uint32, DstT>(source, destination, count, swapBytes);
+    return true;
+  case DataType::int64:
+    ConversionKernels::ConvertValues<int64, DstT>(source, destination, count, swapBytes);
+    return true;
+  case DataType::uint64:
+    ConversionKernels::ConvertValues<uint64, DstT>(source, destination, count, swapBytes);
+    return true;
+  case DataType::float32:
+    ConversionKernels::ConvertValues<float32, DstT>(source, destination, count, swapBytes);
+    return true;
+  case DataType::float64:
+    ConversionKernels::ConvertValues<float64, DstT>(source, destination, count, swapBytes);
+    return true;
+  default:
+    return false;
+  }
+}
+} // namespace complex
@@ -0,0 +1,221 @@
+#include "DataStructureDelta.hpp"
+
+#include "H5Types.hpp"
+
+#include "complex/DataStructure/DataArray.hpp"
+#include "complex/DataStructure/DataGroup.hpp"
+#include "complex/DataStructure/DataStore.hpp"
+
+#include <algorithm>
+
+namespace complex
+{
+namespace
+{
+/**
+ * @brief Copies any store into a plain DataStore so a delta never holds on to a mapping, a
+ * deferred load or a store that a filter could still modify.
+ */
+template <typename T>
+std::shared_ptr<IDataStore<T>> CopyToDataStore(const IDataStore<T>& store)
+{
+  auto copy = std::make_shared<DataStore<T>>(store.getTupleShape(), store.getComponentShape());
+  T* values = copy->data();
+  if(const auto* dataStore = dynamic_cast<const DataStore<T>*>(&store); nullptr != dataStore)
+  {
+    std::copy(dataStore->data(), dataStore->data() + store.getSize(), values);
+  }
+  else
+  {
+    for(size_t i = 0; i < store.getSize(); i++)
+    {
+      values[i] = store.getValue(i);
+    }
+  }
+  return copy;
+}
+
+std::optional<DataObject::IdType> GetParentId(const DataStructure& dataStructure, const DataPath& dataPath, bool& found)
+{
+  found = true;
+  if(dataPath.getLength() < 2)
+  {
+    return {};
+  }
+  std::optional<DataObject::IdType> parentId = dataStructure.getId(dataPath.getParent());
+  found = parentId.has_value();
+  return parentId;
+}
+
+template <typename T>
+bool ApplyArray(const DataPath& dataPath, const std::shared_ptr<IDataStore<T>>& store, bool copyStore, DataStructure& dataStructure)
+{
+  std::shared_ptr<IDataStore<T>> arrayStore = copyStore ? CopyToDataStore(*store) : store;
+  if(auto* existingArray = dynamic_cast<DataArray<T>*>(dataStructure.getData(dataPath)); nullptr != existingArray)
+  {
+    existingArray->setDataStore(arrayStore);
+    return true;
+  }
+  if(nullptr != dataStructure.getData(dataPath))
+  {
+    return false;
+  }
+  bool parentFound = false;
+  std::optional<DataObject::IdType> parentId = GetParentId(dataStructure, dataPath, parentFound);
+  return parentFound && nullptr != DataArray<T>::Create(dataStructure, dataPath.getTargetName(), arrayStore, parentId);
+}
+} // namespace
+
+// -----------------------------------------------------------------------------
+std::optional<DataStructureDelta> CaptureDataStructureDelta(const DataStructureInventory& before, const DataStructure& dataStructure)
+{
+  DataStructureInventory after = TakeDataStructureInventory(dataStructure, false, before.hashScope);
+  for(const auto& [path, entry] : before.objects)
+  {
+    if(after.objects.count(path) == 0)
+    {
+      return {};
+    }
+  }
+
+  DataStructureDelta delta;
+  for(const auto& [path, entry] : after.objects)
+  {
+    auto previous = before.objects.find(path);
+    if(nullptr == entry.array)
+    {
+      if(previous != before.objects.end())
+      {
+        continue;
+      }
+      if(nullptr == dynamic_cast<const DataGroup*>(entry.object))
+      {
+        return {};
+      }
+      delta.groups.push_back(entry.path);
+      continue;
+    }
+    if(entry.hash.empty())
+    {
+      return {};
+    }
+    if(previous != before.objects.end() && (entry.hash == DataStructureInventory::k_NotHashed || previous->second.hash == entry.hash))
+    {
+      continue;
+    }
+
+    bool captured = false;
+    VisitNumericDataType(entry.array->getDataType(), [&](auto value) {
+      using T = decltype(value);
+      const auto* typedArray = dynamic_cast<const DataArray<T>*>(entry.array);
+      if(nullptr != typedArray && nullptr != typedArray->getDataStore())
+      {
+        std::shared_ptr<IDataStore<T>> store = CopyToDataStore(*typedArray->getDataStore());
+        delta.numBytes += store->getSize() * sizeof(T);
+        delta.arrays.push_back({entry.path, entry.array->getDataType(), std::any(store)});
+        captured = true;
+      }
+    });
+    if(!captured)
+    {
+      return {};
+    }
+  }
+  std::sort(delta.groups.begin(), delta.groups.end(), [](const DataPath& lhs, const DataPath& rhs) { return lhs.getLength() < rhs.getLength(); });
+  return delta;
+}
+
+// -----------------------------------------------------------------------------
+bool ApplyDataStructureDelta(const DataStructureDelta& delta, DataStructure& dataStructure, bool copyStores)
+{
+  for(const DataPath& groupPath : delta.groups)
+  {
+    if(nullptr != dataStructure.getData(groupPath))
+    {
+      continue;
+    }
+    bool parentFound = false;
+    std::optional<DataObject::IdType> parentId = GetParentId(dataStructure, groupPath, parentFound);
+    if(!parentFound || nullptr == DataGroup::Create(dataStructure, groupPath.getTargetName(), parentId))
+    {
+      return false;
+    }
+  }
+  for(const DataStructureDelta::Array& deltaArray : delta.arrays)
+  {
+    bool applied = false;
+    VisitNumericDataType(deltaArray.dataType, [&](auto value) {
+      using T = decltype(value);
+      applied = ApplyArray<T>(deltaArray.path, std::any_cast<std::shared_ptr<IDataStore<T>>>(deltaArray.store), copyStores, dataStructure);
+    });
+    if(!applied)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+bool CopyArrayValues(DataStructure& dataStructure, const std::vector<std::string>& paths)
+{
+  std::vector<DataObject::IdType> arrayIds;
+  for(const auto& [id, dataObject] : dataStructure)
+  {
+    for(const DataPath& dataPath : dataStructure.getDataPathsForId(id))
+    {
+      const std::string path = DataPathToString(dataPath);
+      if(std::any_of(paths.begin(), paths.end(), [&path](const std::string& parentPath) { return IsAtOrBelow(path, parentPath); }))
+      {
+        arrayIds.push_back(id);
+        break;
+      }
+    }
+  }
+
+  for(DataObject::IdType id : arrayIds)
+  {
+    auto* dataArray = dynamic_cast<IDataArray*>(dataStructure.getData(id));
+    if(nullptr == dataArray)
+    {
+      continue;
+    }
+    bool copied = false;
+    VisitNumericDataType(dataArray->getDataType(), [&](auto value) {
+      using T = decltype(value);
+      auto* typedArray = dynamic_cast<DataArray<T>*>(dataArray);
+      if(nullptr != typedArray && nullptr != typedArray->getDataStore())
+      {
+        typedArray->setDataStore(CopyToDataStore(*typedArray->getDataStore()));
+        copied = true;
+      }
+    });
+    if(!copied)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+std::vector<std::string> GetDataPathArguments(const Arguments& arguments)
+{
+  std::vector<std::string> paths;
+  for(const auto& [name, value] : arguments)
+  {
+    if(const auto* dataPath = std::any_cast<DataPath>(&value); nullptr != dataPath)
+    {
+      paths.push_back(DataPathToString(*dataPath));
+    }
+    else if(const auto* dataPaths = std::any_cast<std::vector<DataPath>>(&value); nullptr != dataPaths)
+    {
+      for(const DataPath& path : *dataPaths)
+      {
+        paths.push_back(DataPathToString(path));
+      }
+    }
+  }
+  return paths;
+}
+} // namespace complex
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "DataStructureHash.hpp"
+
+#include "complex/Common/Types.hpp"
+#include "complex/DataStructure/DataPath.hpp"
+#include "complex/DataStructure/DataStructure.hpp"
+#include "complex/Filter/Arguments.hpp"
+
+#include <any>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace complex
+{
+/**
+ * @brief The DataGroups and arrays that something (usually a filter) added to a
+ * DataStructure or changed, with copies of the arrays' values. Applying it to another
+ * DataStructure with the same hierarchy gives the same result as running that thing again.
+ */
+struct DataStructureDelta
+{
+  struct Array
+  {
+    DataPath path;
+    DataType dataType = DataType::uint8;
+    std::any store; // std::shared_ptr<IDataStore<T>> of the dataType, always a DataStore<T>
+  };
+
+  std::vector<DataPath> groups; // Created groups, parents first
+  std::vector<Array> arrays;
+  size_t numBytes = 0;
+};
+
+/**
+ * @brief Compares the DataStructure with an inventory taken earlier. Only arrays inside the
+ * earlier inventory's hash scope are hashed again; existing arrays outside of it are taken
+ * to be unchanged.
+ * @param before
+ * @param dataStructure
+ * @return Empty if objects were removed, an object other than a DataGroup or numeric array
+ * was created, or a changed array can not be copied.
+ */
+std::optional<DataStructureDelta> CaptureDataStructureDelta(const DataStructureInventory& before, const DataStructure& dataStructure);
+
+/**
+ * @brief Creates the delta's groups and arrays; existing arrays get the delta's values.
+ * @param delta
+ * @param dataStructure
+ * @param copyStores False hands the delta's stores to the DataStructure. Only do that when the
+ * delta is not applied again, since the DataStructure may then modify them.
+ * @return false if a parent is missing or a path is taken by an object of another type.
+ */
+bool ApplyDataStructureDelta(const DataStructureDelta& delta, DataStructure& dataStructure, bool copyStores = true);
+
+/**
+ * @brief Gives every numeric array at or below one of the "/a/b/c" paths its own copy of its
+ * values. Copying a DataStructure copies its objects, but the copied arrays share their
+ * DataStore with the original's; this lets the copy modify those arrays on its own.
+ * @param dataStructure
+ * @param paths
+ * @return false if one of the arrays is not a numeric DataArray. The arrays before it were copied.
+ */
+bool CopyArrayValues(DataStructure& dataStructure, const std::vector<std::string>& paths);
+
+/**
+ * @brief Returns the DataPath and std::vector<DataPath> values of the arguments as "/a/b/c"
+ * strings: everything a filter can read or write.
+ * @param arguments
+ * @return
+ */
+std::vector<std::string> GetDataPathArguments(const Arguments& arguments);
+
+} // namespace complex
@@ -0,0 +1,133 @@
+#include "DataStructureHash.hpp"
+
+#include "ContentHash.hpp"
+#include "H5Types.hpp"
+#include "LazyDataStore.hpp"
+
+#include "complex/DataStructure/DataArray.hpp"
+#include "complex/DataStructure/DataStore.hpp"
+
+#include <algorithm>
+#include <sstream>
+#include <vector>
+
+namespace complex
+{
+namespace
+{
+constexpr size_t k_HashBufferValues = 64 * 1024;
+
+template <typename T>
+std::string HashDataStore(const IDataStore<T>& store, bool loadDeferred)
+{
+  if(const auto* lazyStore = dynamic_cast<const LazyDataStore<T>*>(&store); nullptr != lazyStore && !lazyStore->isLoaded() && !loadDeferred)
+  {
+    return DataStructureInventory::k_UnloadedHash;
+  }
+  ContentHasher hasher;
+  const size_t numValues = store.getSize();
+  if(const auto* dataStore = dynamic_cast<const DataStore<T>*>(&store); nullptr != dataStore)
+  {
+    hasher.update(dataStore->data(), numValues * sizeof(T));
+    return HashToString(hasher.digest());
+  }
+  std::vector<T> buffer(std::min(numValues, k_HashBufferValues));
+  for(size_t offset = 0; offset < numValues; offset += buffer.size())
+  {
+    const size_t count = std::min(buffer.size(), numValues - offset);
+    for(size_t i = 0; i < count; i++)
+    {
+      buffer[i] = store.getValue(offset + i);
+    }
+    hasher.update(buffer.data(), count * sizeof(T));
+  }
+  return HashToString(hasher.digest());
+}
+
+std::string ShapeToString(const std::vector<usize>& shape)
+{
+  std::string text;
+  for(usize dim : shape)
+  {
+    text += std::to_string(dim) + "x";
+  }
+  return text;
+}
+} // namespace
+
+// -----------------------------------------------------------------------------
+std::string HashToString(uint64_t hash)
+{
+  std::ostringstream stream;
+  stream << std::hex << hash;
+  return stream.str();
+}
+
+// -----------------------------------------------------------------------------
+std::string DataPathToString(const DataPath& dataPath)
+{
+  return "/" + dataPath.toString("/");
+}
+
+// -----------------------------------------------------------------------------
+std::string HashDataArray(const IDataArray& dataArray, bool loadDeferred)
+{
+  std::string hash;
+  VisitNumericDataType(dataArray.getDataType(), [&](auto value) {
+    using T = decltype(value);
+    const auto* typedArray = dynamic_cast<const DataArray<T>*>(&dataArray);
+    if(nullptr != typedArray && nullptr != typedArray->getDataStore())
+    {
+      hash = HashDataStore<T>(*typedArray->getDataStore(), loadDeferred);
+    }
+  });
+  return hash;
+}
+
+// -----------------------------------------------------------------------------
+DataStructureInventory TakeDataStructureInventory(const DataStructure& dataStructure, bool loadDeferred, std::optional<std::vector<std::string>> hashScope)
+{
+  DataStructureInventory inventory;
+  inventory.hashScope = std::move(hashScope);
+  std::vector<std::string> signatures;
+  for(const auto& [id, dataObject] : dataStructure)
+  {
+    const auto* dataArray = dynamic_cast<const IDataArray*>(dataObject.get());
+    const std::vector<DataPath> dataPaths = dataStructure.getDataPathsForId(id);
+    std::string arrayHash;
+    if(nullptr != dataArray)
+    {
+      const bool inScope = !inventory.hashScope.has_value() || std::any_of(dataPaths.begin(), dataPaths.end(), [&inventory](const DataPath& dataPath) {
+                             const std::string path = DataPathToString(dataPath);
+                             return std::any_of(inventory.hashScope->begin(), inventory.hashScope->end(), [&path](const std::string& scopePath) { return IsAtOrBelow(path, scopePath); });
+                           });
+      arrayHash = inScope ? HashDataArray(*dataArray, loadDeferred) : DataStructureInventory::k_NotHashed;
+    }
+    for(const DataPath& dataPath : dataPaths)
+    {
+      const std::string path = DataPathToString(dataPath);
+      std::string signature = path + "|" + dataObject->getTypeName();
+      if(nullptr != dataArray)
+      {
+        signature += "|" + ShapeToString(dataArray->getTupleShape()) + "|" + ShapeToString(dataArray->getComponentShape());
+      }
+      inventory.objects[path] = {dataPath, dataObject.get(), dataArray, arrayHash};
+      signatures.push_back(std::move(signature));
+    }
+  }
+  std::sort(signatures.begin(), signatures.end());
+  ContentHasher hasher;
+  for(const std::string& signature : signatures)
+  {
+    hasher.update(signature.data(), signature.size() + 1); // Include the terminator so "ab","c" differs from "a","bc"
+  }
+  inventory.structureHash = HashToString(hasher.digest());
+  return inventory;
+}
+
+// -----------------------------------------------------------------------------
+bool IsAtOrBelow(const std::string& path, const std::string& parentPath)
+{
+  return path == parentPath || (path.size() > parentPath.size() && path.compare(0, parentPath.size(), parentPath) == 0 && path[parentPath.size()] == '/');
+}
+} // namespace complex
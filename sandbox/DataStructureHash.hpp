@@ -0,0 +1,85 @@
+#pragma once
+
+#include "complex/DataStructure/DataPath.hpp"
+#include "complex/DataStructure/DataStructure.hpp"
+#include "complex/DataStructure/IDataArray.hpp"
+
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace complex
+{
+/**
+ * @brief Every DataObject of a DataStructure by path, the hashes of the arrays' values and
+ * one hash of the hierarchy itself (paths, object types and array shapes).
+ */
+struct DataStructureInventory
+{
+  struct Entry
+  {
+    DataPath path;
+    const DataObject* object = nullptr;
+    const IDataArray* array = nullptr; // nullptr for objects that are not arrays
+    std::string hash;                  // Hash of the array's values; empty for other objects and arrays that can not be hashed
+  };
+
+  /**
+   * @brief Stands in for the values of a deferred array that has not been loaded yet. It
+   * still holds what it was created with, but that is only known to the one who created it.
+   */
+  static inline constexpr const char* k_UnloadedHash = "unloaded";
+
+  /**
+   * @brief Stands in for the values of an array outside of the inventory's hash scope.
+   */
+  static inline constexpr const char* k_NotHashed = "not hashed";
+
+  std::string structureHash;
+  std::map<std::string, Entry> objects;                // Keyed by DataPathToString()
+  std::optional<std::vector<std::string>> hashScope; // Only arrays at or below one of these paths were hashed; every array if not set
+};
+
+/**
+ * @brief Returns a 64 bit hash as the hex string the inventory and checkpoints store.
+ * @param hash
+ * @return
+ */
+std::string HashToString(uint64_t hash);
+
+/**
+ * @brief Returns the path as "/a/b/c".
+ * @param dataPath
+ * @return
+ */
+std::string DataPathToString(const DataPath& dataPath);
+
+/**
+ * @brief Hashes the values of a numeric DataArray.
+ * @param dataArray
+ * @param loadDeferred If false, an array whose LazyDataStore has not been loaded is not
+ * loaded and hashes to DataStructureInventory::k_UnloadedHash.
+ * @return Empty for arrays that can not be hashed (e.g. bool arrays).
+ */
+std::string HashDataArray(const IDataArray& dataArray, bool loadDeferred = false);
+
+/**
+ * @brief Lists every object of the DataStructure and hashes its arrays. An object with several paths is listed under each.
+ * @param dataStructure
+ * @param loadDeferred See HashDataArray()
+ * @param hashScope If set, only arrays with a path at or below one of these "/a/b/c" paths
+ * are hashed; the rest get DataStructureInventory::k_NotHashed. The hierarchy hash always covers everything.
+ * @return
+ */
+DataStructureInventory TakeDataStructureInventory(const DataStructure& dataStructure, bool loadDeferred = false, std::optional<std::vector<std::string>> hashScope = {});
+
+/**
+ * @brief Returns true if the "/a/b/c" path is the parent path or one of its descendants.
+ * @param path
+ * @param parentPath
+ * @return
+ */
+bool IsAtOrBelow(const std::string& path, const std::string& parentPath);
+} // namespace complex
@@ -0,0 +1,470 @@
+#include "FilterResultCache.hpp"
+
+#include "ContentHash.hpp"
+#include "DataStructureDelta.hpp"
+#include "H5Types.hpp"
+#include "RawFileReader.hpp"
+#include "RawSidecar.hpp"
+
+#include "complex/DataStructure/DataStore.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace fs = std::filesystem;
+
+namespace complex
+{
+namespace
+{
+constexpr const char* k_EntryFileName = "entry.json";
+constexpr const char* k_VersionKey = "version";
+constexpr const char* k_BytesKey = "bytes";
+constexpr const char* k_GroupsKey = "groups";
+constexpr const char* k_ArraysKey = "arrays";
+constexpr const char* k_PathKey = "path";
+constexpr const char* k_FileKey = "file";
+
+/**
+ * @brief Describes the file a path argument names by its size, modified time and contents.
+ * @return Empty for paths that can not be hashed (e.g. directories).
+ */
+std::optional<std::string> DescribeFileArgument(const fs::path& filePath)
+{
+  std::error_code errorCode;
+  if(filePath.empty() || !fs::exists(filePath, errorCode))
+  {
+    // An output file, or an input that is missing and makes the filter fail anyway
+    return "missing:" + filePath.generic_string();
+  }
+  if(!fs::is_regular_file(filePath, errorCode))
+  {
+    return {};
+  }
+  const auto fileSize = fs::file_size(filePath, errorCode);
+  const auto modifiedTime = fs::last_write_time(filePath, errorCode).time_since_epoch().count();
+  std::optional<uint64_t> contentHash = ContentHasher::HashFile(filePath);
+  if(errorCode || !contentHash.has_value())
+  {
+    return {};
+  }
+  std::ostringstream stream;
+  stream << filePath.generic_string() << ":" << fileSize << ":" << modifiedTime << ":" << std::hex << *contentHash;
+  return stream.str();
+}
+
+size_t DirectorySize(const fs::path& directory)
+{
+  size_t numBytes = 0;
+  std::error_code errorCode;
+  for(const auto& entry : fs::recursive_directory_iterator(directory, errorCode))
+  {
+    if(entry.is_regular_file(errorCode))
+    {
+      numBytes += entry.file_size(errorCode);
+    }
+  }
+  return numBytes;
+}
+} // namespace
+
+// -----------------------------------------------------------------------------
+FilterResultCache::FilterResultCache(FilterCacheOptions options)
+: m_Options(std::move(options))
+{
+  if(!m_Options.directory.empty())
+  {
+    std::error_code errorCode;
+    fs::create_directories(m_Options.directory, errorCode);
+    m_Statistics.diskBytes = DirectorySize(m_Options.directory);
+  }
+}
+
+// -----------------------------------------------------------------------------
+bool FilterResultCache::execute(AbstractPipelineNode& node, DataStructure& dataStructure)
+{
+  auto* filterNode = dynamic_cast<PipelineFilter*>(&node);
+  if(nullptr == filterNode)
+  {
+    return node.execute(dataStructure);
+  }
+  const IFilter* filter = filterNode->getFilter();
+  if(nullptr == filter || std::find(m_Options.cacheableFilters.begin(), m_Options.cacheableFilters.end(), filter->uuid()) == m_Options.cacheableFilters.end())
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      m_Statistics.uncacheable++;
+    }
+    return node.execute(dataStructure);
+  }
+
+  // Only the filter's inputs and outputs are hashed; everything else is assumed untouched
+  DataStructureInventory before = TakeDataStructureInventory(dataStructure, false, GetDataPathArguments(filterNode->getArguments()));
+  std::optional<std::string> key = ComputeKey(*filterNode, before);
+  if(!key.has_value())
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      m_Statistics.uncacheable++;
+    }
+    return node.execute(dataStructure);
+  }
+
+  if(std::optional<DataStructureDelta> entry = find(*key); entry.has_value())
+  {
+    if(ApplyDataStructureDelta(*entry, dataStructure))
+    {
+      return true;
+    }
+    std::cout << "Could not restore the cached outputs of " << node.getName() << std::endl;
+    return false;
+  }
+
+  if(!node.execute(dataStructure))
+  {
+    return false;
+  }
+  std::optional<DataStructureDelta> entry = CaptureDataStructureDelta(before, dataStructure);
+  if(entry.has_value())
+  {
+    insert(*key, *entry);
+  }
+  else
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Statistics.uncacheable++;
+  }
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+FilterCacheStatistics FilterResultCache::getStatistics() const
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_Statistics;
+}
+
+// -----------------------------------------------------------------------------
+void FilterResultCache::clear()
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  m_MemoryEntries.clear();
+  m_LruOrder.clear();
+  m_Statistics.memoryBytes = 0;
+  if(!m_Options.directory.empty())
+  {
+    std::error_code errorCode;
+    fs::remove_all(m_Options.directory, errorCode);
+    fs::create_directories(m_Options.directory, errorCode);
+    m_Statistics.diskBytes = 0;
+  }
+}
+
+// -----------------------------------------------------------------------------
+std::optional<std::string> FilterResultCache::DescribeFilter(const PipelineFilter& filterNode)
+{
+  const IFilter* filter = filterNode.getFilter();
+  if(nullptr == filter)
+  {
+    return {};
+  }
+  const Parameters parameters = filterNode.getParameters();
+  nlohmann::json argumentsJson = nlohmann::json::object();
+  std::vector<std::string> files;
+  const Arguments arguments = filterNode.getArguments();
+  for(const auto& [name, value] : arguments)
+  {
+    if(!parameters.contains(name))
+    {
+      return {};
+    }
+    try
+    {
+      argumentsJson[name] = parameters.at(name)->toJson(value);
+    } catch(const std::exception&)
+    {
+      return {};
+    }
+    // The same path may name a file whose contents changed since the result was cached
+    if(const auto* filePath = std::any_cast<fs::path>(&value); nullptr != filePath)
+    {
+      std::optional<std::string> file = DescribeFileArgument(*filePath);
+      if(!file.has_value())
+      {
+        return {};
+      }
+      files.push_back(std::move(*file));
+    }
+  }
+
+  // The json object's keys are sorted so the same arguments always serialize the same way
+  std::string description = filter->uuid().str() + "\n" + argumentsJson.dump();
+  for(const std::string& file : files)
+  {
+    description += "\n" + file;
+  }
+  return description;
+}
+
+// -----------------------------------------------------------------------------
+std::optional<std::string> FilterResultCache::ComputeKey(const PipelineFilter& filterNode, DataStructureInventory& inventory)
+{
+  std::optional<std::string> description = DescribeFilter(filterNode);
+  if(!description.has_value())
+  {
+    return {};
+  }
+  const std::vector<std::string> inputPaths = GetDataPathArguments(filterNode.getArguments());
+
+  ContentHasher hasher;
+  hasher.update(description->data(), description->size() + 1);
+  hasher.update(inventory.structureHash.data(), inventory.structureHash.size() + 1);
+  for(auto& [path, entry] : inventory.objects)
+  {
+    if(nullptr == entry.array || std::none_of(inputPaths.begin(), inputPaths.end(), [&path = path](const std::string& inputPath) { return IsAtOrBelow(path, inputPath); }))
+    {
+      continue;
+    }
+    // The filter is about to read its inputs anyway. Keep the loaded hash so loading does not look like a change.
+    if(entry.hash == DataStructureInventory::k_UnloadedHash)
+    {
+      entry.hash = HashDataArray(*entry.array, true);
+    }
+    if(entry.hash.empty())
+    {
+      return {};
+    }
+    const std::string input = path + "=" + entry.hash;
+    hasher.update(input.data(), input.size() + 1);
+  }
+  std::ostringstream stream;
+  stream << std::hex << hasher.digest();
+  return stream.str();
+}
+
+// -----------------------------------------------------------------------------
+std::optional<DataStructureDelta> FilterResultCache::find(const std::string& key)
+{
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if(auto iter = m_MemoryEntries.find(key); iter != m_MemoryEntries.end())
+    {
+      m_LruOrder.splice(m_LruOrder.begin(), m_LruOrder, iter->second.lruPosition);
+      m_Statistics.hits++;
+      m_Statistics.memoryHits++;
+      return iter->second.entry;
+    }
+  }
+
+  std::optional<DataStructureDelta> entry = readFromDisk(key);
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  if(!entry.has_value())
+  {
+    m_Statistics.misses++;
+    return {};
+  }
+  m_Statistics.hits++;
+  m_Statistics.diskHits++;
+  insertInMemory(key, *entry);
+  return entry;
+}
+
+// -----------------------------------------------------------------------------
+void FilterResultCache::insert(const std::string& key, const DataStructureDelta& entry)
+{
+  if(!m_Options.directory.empty() && entry.numBytes <= m_Options.maxDiskBytes)
+  {
+    writeToDisk(key, entry);
+  }
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  insertInMemory(key, entry);
+  if(!m_Options.directory.empty())
+  {
+    evictFromDisk();
+  }
+}
+
+// -----------------------------------------------------------------------------
+void FilterResultCache::insertInMemory(const std::string& key, DataStructureDelta entry)
+{
+  if(entry.numBytes > m_Options.maxMemoryBytes || m_MemoryEntries.count(key) > 0)
+  {
+    return;
+  }
+  while(!m_LruOrder.empty() && m_Statistics.memoryBytes + entry.numBytes > m_Options.maxMemoryBytes)
+  {
+    auto leastRecent = m_MemoryEntries.find(m_LruOrder.back());
+    m_Statistics.memoryBytes -= leastRecent->second.entry.numBytes;
+    m_MemoryEntries.erase(leastRecent);
+    m_LruOrder.pop_back();
+    m_Statistics.evictions++;
+  }
+  m_Statistics.memoryBytes += entry.numBytes;
+  m_LruOrder.push_front(key);
+  m_MemoryEntries[key] = {std::move(entry), m_LruOrder.begin()};
+}
+
+// -----------------------------------------------------------------------------
+std::optional<DataStructureDelta> FilterResultCache::readFromDisk(const std::string& key) const
+{
+  if(m_Options.directory.empty())
+  {
+    return {};
+  }
+  const fs::path entryDir = m_Options.directory / key;
+  std::ifstream inputFile(entryDir / k_EntryFileName);
+  if(!inputFile.is_open())
+  {
+    return {};
+  }
+
+  DataStructureDelta entry;
+  try
+  {
+    nlohmann::json rootJson = nlohmann::json::parse(inputFile);
+    if(rootJson.at(k_VersionKey).get<int32_t>() != k_Version)
+    {
+      return {};
+    }
+    for(const auto& groupJson : rootJson.at(k_GroupsKey))
+    {
+      entry.groups.emplace_back(groupJson.get<std::vector<std::string>>());
+    }
+    for(const auto& arrayJson : rootJson.at(k_ArraysKey))
+    {
+      const fs::path rawFilePath = entryDir / arrayJson.at(k_FileKey).get<std::string>();
+      std::optional<RawSidecar> sidecar = RawSidecar::Read(rawFilePath, fs::file_size(rawFilePath));
+      if(!sidecar.has_value())
+      {
+        return {};
+      }
+      DataStructureDelta::Array cachedArray = {DataPath(arrayJson.at(k_PathKey).get<std::vector<std::string>>()), sidecar->dataType, {}};
+      VisitNumericDataType(sidecar->dataType, [&](auto value) {
+        using T = decltype(value);
+        std::shared_ptr<IDataStore<T>> store = ReadRawDataStore<T>(rawFilePath, sidecar->tupleDims, sidecar->componentDims, RawReadMode::Copy, nullptr, sidecar->getSourceFormat());
+        if(nullptr != store)
+        {
+          entry.numBytes += store->getSize() * sizeof(T);
+          cachedArray.store = std::any(store);
+        }
+      });
+      if(!cachedArray.store.has_value())
+      {
+        return {};
+      }
+      entry.arrays.push_back(std::move(cachedArray));
+    }
+  } catch(const std::exception& exception)
+  {
+    std::cout << "Error reading cached filter result " << entryDir.string() << ": " << exception.what() << std::endl;
+    return {};
+  }
+
+  // Marks the entry as recently used for evictFromDisk()
+  std::error_code errorCode;
+  fs::last_write_time(entryDir / k_EntryFileName, fs::file_time_type::clock::now(), errorCode);
+  return entry;
+}
+
+// -----------------------------------------------------------------------------
+bool FilterResultCache::writeToDisk(const std::string& key, const DataStructureDelta& entry)
+{
+  const fs::path entryDir = m_Options.directory / key;
+  fs::path tempDir = entryDir;
+  tempDir += ".tmp";
+  std::error_code errorCode;
+  fs::remove_all(tempDir, errorCode);
+  fs::create_directories(tempDir, errorCode);
+
+  nlohmann::json rootJson;
+  rootJson[k_VersionKey] = k_Version;
+  rootJson[k_BytesKey] = entry.numBytes;
+  rootJson[k_GroupsKey] = nlohmann::json::array();
+  for(const DataPath& groupPath : entry.groups)
+  {
+    rootJson[k_GroupsKey].push_back(groupPath.getPathVector());
+  }
+  rootJson[k_ArraysKey] = nlohmann::json::array();
+  bool success = !errorCode;
+  for(size_t i = 0; i < entry.arrays.size() && success; i++)
+  {
+    const DataStructureDelta::Array& cachedArray = entry.arrays[i];
+    const std::string fileName = std::to_string(i) + ".raw";
+    RawSidecar sidecar;
+    sidecar.dataType = cachedArray.dataType;
+    sidecar.byteOrder = k_NativeEndian;
+    sidecar.name = cachedArray.path.getTargetName();
+    VisitNumericDataType(cachedArray.dataType, [&](auto value) {
+      using T = decltype(value);
+      const auto& store = *std::any_cast<std::shared_ptr<IDataStore<T>>>(cachedArray.store);
+      sidecar.tupleDims = store.getTupleShape();
+      sidecar.componentDims = store.getComponentShape();
+      success = WriteRawDataStore<T>(tempDir / fileName, store);
+    });
+    success = success && sidecar.write(tempDir / fileName);
+    rootJson[k_ArraysKey].push_back({{k_PathKey, cachedArray.path.getPathVector()}, {k_FileKey, fileName}});
+  }
+  if(success)
+  {
+    std::ofstream outputFile(tempDir / k_EntryFileName, std::ios::out | std::ios::trunc);
+    outputFile << rootJson.dump(2);
+    success = outputFile.good();
+  }
+  if(success)
+  {
+    fs::remove_all(entryDir, errorCode);
+    fs::rename(tempDir, entryDir, errorCode);
+    success = !errorCode;
+  }
+  if(!success)
+  {
+    std::cout << "Could not write cached filter result " << entryDir.string() << std::endl;
+    fs::remove_all(tempDir, errorCode);
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  m_Statistics.diskBytes = DirectorySize(m_Options.directory);
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+void FilterResultCache::evictFromDisk()
+{
+  if(m_Statistics.diskBytes <= m_Options.maxDiskBytes)
+  {
+    return;
+  }
+  struct DiskEntry
+  {
+    fs::path directory;
+    fs::file_time_type lastUsed;
+    size_t numBytes;
+  };
+  std::vector<DiskEntry> diskEntries;
+  std::error_code errorCode;
+  for(const auto& directoryEntry : fs::directory_iterator(m_Options.directory, errorCode))
+  {
+    const fs::path entryFile = directoryEntry.path() / k_EntryFileName;
+    if(fs::exists(entryFile, errorCode))
+    {
+      diskEntries.push_back({directoryEntry.path(), fs::last_write_time(entryFile, errorCode), DirectorySize(directoryEntry.path())});
+    }
+  }
+  std::sort(diskEntries.begin(), diskEntries.end(), [](const DiskEntry& lhs, const DiskEntry& rhs) { return lhs.lastUsed < rhs.lastUsed; });
+  for(const DiskEntry& diskEntry : diskEntries)
+  {
+    if(m_Statistics.diskBytes <= m_Options.maxDiskBytes)
+    {
+      break;
+    }
+    fs::remove_all(diskEntry.directory, errorCode);
+    m_Statistics.diskBytes -= std::min(m_Statistics.diskBytes, diskEntry.numBytes);
+    m_Statistics.evictions++;
+  }
+}
+} // namespace complex
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "DataStructureDelta.hpp"
+#include "DataStructureHash.hpp"
+
+#include "complex/Common/Uuid.hpp"
+#include "complex/DataStructure/DataPath.hpp"
+#include "complex/DataStructure/DataStructure.hpp"
+#include "complex/Pipeline/AbstractPipelineNode.hpp"
+#include "complex/Pipeline/PipelineFilter.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace complex
+{
+/**
+ * @brief Counters of a FilterResultCache. hits is memoryHits + diskHits.
+ */
+struct FilterCacheStatistics
+{
+  size_t hits = 0;
+  size_t memoryHits = 0;
+  size_t diskHits = 0;
+  size_t misses = 0;
+  size_t uncacheable = 0; // Executions of filters that are not cacheable or whose arguments or outputs can not be cached
+  size_t evictions = 0;
+  size_t memoryBytes = 0;
+  size_t diskBytes = 0;
+};
+
+/**
+ * @brief Size limits, location and the filters a FilterResultCache may cache.
+ */
+struct FilterCacheOptions
+{
+  size_t maxMemoryBytes = 1024ULL * 1024ULL * 1024ULL;
+  std::filesystem::path directory; // Empty keeps the results in memory only
+  size_t maxDiskBytes = 8ULL * 1024ULL * 1024ULL * 1024ULL;
+  std::vector<Uuid> cacheableFilters; // Every other filter is always executed
+};
+
+/**
+ * @class FilterResultCache
+ * @brief Memoizes the outputs of PipelineFilters. A result is keyed on the filter's uuid, its
+ * arguments (serialized by their parameters), the hashes of the arrays its DataPath arguments
+ * point to, the size, modified time and contents of the files its path arguments name, plus
+ * the hash of the hierarchy. On a hit the output arrays are restored instead of executing the
+ * filter, so re-running a pipeline after changing a parameter near its end only executes the
+ * filters downstream of the change.
+ *
+ * Only filters listed in FilterCacheOptions::cacheableFilters are cached. List a filter only
+ * if its outputs depend on nothing but that key, i.e. not on random numbers, the clock or
+ * arrays it finds without a DataPath argument, and if it has no side effects such as writing files.
+ *
+ * The outputs are whatever the execution changed at or below the filter's DataPath arguments:
+ * new DataGroups, new arrays and arrays whose values changed. Only those arrays are hashed,
+ * before and after the execution. A filter that removes objects or creates any other kind of
+ * object is always executed. Results are kept in memory and, when a directory is given, on disk as raw files
+ * with sidecars so they outlive the process. Both tiers evict the least recently used results
+ * once they exceed their size limit.
+ */
+class FilterResultCache
+{
+public:
+  static inline constexpr int32_t k_Version = 1;
+
+  explicit FilterResultCache(FilterCacheOptions options = {});
+  ~FilterResultCache() noexcept = default;
+
+  FilterResultCache(const FilterResultCache&) = delete;
+  FilterResultCache(FilterResultCache&&) noexcept = delete;
+  FilterResultCache& operator=(const FilterResultCache&) = delete;
+  FilterResultCache& operator=(FilterResultCache&&) noexcept = delete;
+
+  /**
+   * @brief Restores the node's cached outputs or executes it and caches them. Nodes that are
+   * not PipelineFilters are just executed. May be called from several threads at once.
+   * @param node
+   * @param dataStructure
+   * @return The result of the execution; true for a hit.
+   */
+  bool execute(AbstractPipelineNode& node, DataStructure& dataStructure);
+
+  FilterCacheStatistics getStatistics() const;
+
+  /**
+   * @brief Drops every result, in memory and on disk.
+   */
+  void clear();
+
+  /**
+   * @brief Describes what a filter does apart from its input arrays: its uuid, its arguments
+   * serialized by its parameters and the size, modified time and contents of the files its
+   * path arguments name.
+   * @param filterNode
+   * @return Empty if the filter is not loaded or an argument can not be serialized or hashed.
+   */
+  static std::optional<std::string> DescribeFilter(const PipelineFilter& filterNode);
+
+private:
+  struct MemoryEntry
+  {
+    DataStructureDelta entry;
+    std::list<std::string>::iterator lruPosition;
+  };
+
+  static std::optional<std::string> ComputeKey(const PipelineFilter& filterNode, DataStructureInventory& inventory);
+
+  std::optional<DataStructureDelta> find(const std::string& key);
+  void insert(const std::string& key, const DataStructureDelta& entry);
+  void insertInMemory(const std::string& key, DataStructureDelta entry);
+  std::optional<DataStructureDelta> readFromDisk(const std::string& key) const;
+  bool writeToDisk(const std::string& key, const DataStructureDelta& entry);
+  void evictFromDisk();
+
+  FilterCacheOptions m_Options;
+  mutable std::mutex m_Mutex;
+  std::unordered_map<std::string, MemoryEntry> m_MemoryEntries;
+  std::list<std::string> m_LruOrder; // Most recently used first
+  FilterCacheStatistics m_Statistics;
+};
+} // namespace complex
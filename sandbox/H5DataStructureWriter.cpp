@@ -0,0 +1,342 @@
+#include "H5DataStructureWriter.hpp"
+
+#include "H5Types.hpp"
+
+#include "complex/DataStructure/DataArray.hpp"
+#include "complex/DataStructure/DataStore.hpp"
+#include "complex/DataStructure/IDataStore.hpp"
+#include "complex/Utilities/Parsing/HDF5/H5FileWriter.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace complex
+{
+namespace
+{
+constexpr H5Z_filter_t k_ZstdFilterId = 32015;
+constexpr hsize_t k_MaxChunkBytes = 0xFFFFFFFFULL; // HDF5 limit for a single chunk
+
+struct LayoutContext
+{
+  const H5WriteOptions& options;
+  H5Compression compression = H5Compression::None; // What is actually applied once filter availability was checked
+};
+
+// -----------------------------------------------------------------------------
+hid_t CreateChunkedLayout(const std::vector<hsize_t>& chunkShape, size_t valueSize, const LayoutContext& context)
+{
+  const hid_t dcplId = H5Pcreate(H5P_DATASET_CREATE);
+  H5Pset_chunk(dcplId, static_cast<int>(chunkShape.size()), chunkShape.data());
+  // Every value is written, so filling the chunks first would only cost time
+  H5Pset_fill_time(dcplId, H5D_FILL_TIME_NEVER);
+  if(context.compression == H5Compression::None)
+  {
+    return dcplId;
+  }
+  if(context.options.shuffle && valueSize > 1)
+  {
+    H5Pset_shuffle(dcplId);
+  }
+  if(context.compression == H5Compression::Zstd)
+  {
+    const unsigned int level = static_cast<unsigned int>(std::clamp(context.options.compressionLevel, 1, 22));
+    H5Pset_filter(dcplId, k_ZstdFilterId, H5Z_FLAG_MANDATORY, 1, &level);
+  }
+  else
+  {
+    H5Pset_deflate(dcplId, static_cast<unsigned int>(std::clamp(context.options.compressionLevel, 1, 9)));
+  }
+  return dcplId;
+}
+
+/**
+ * @brief Stands in for an array's store while the DataStructure is written: it reads the
+ * store's values and writes them straight into a chunked dataset, one row of chunks at a time.
+ */
+template <typename T>
+class ChunkedWriteStore : public IDataStore<T>
+{
+public:
+  using value_type = T;
+  using reference = T&;
+  using const_reference = const T&;
+  using ShapeType = typename IDataStore<T>::ShapeType;
+
+  /**
+   * @param store Must outlive this store
+   * @param context
+   */
+  ChunkedWriteStore(IDataStore<T>& store, const LayoutContext& context)
+  : m_Store(store)
+  , m_Context(context)
+  {
+  }
+
+  ~ChunkedWriteStore() override = default;
+
+  ChunkedWriteStore(const ChunkedWriteStore&) = delete;
+  ChunkedWriteStore(ChunkedWriteStore&&) noexcept = delete;
+  ChunkedWriteStore& operator=(const ChunkedWriteStore&) = delete;
+  ChunkedWriteStore& operator=(ChunkedWriteStore&&) noexcept = delete;
+
+  usize getNumberOfTuples() const override
+  {
+    return m_Store.getNumberOfTuples();
+  }
+
+  const ShapeType& getTupleShape() const override
+  {
+    return m_Store.getTupleShape();
+  }
+
+  usize getNumberOfComponents() const override
+  {
+    return m_Store.getNumberOfComponents();
+  }
+
+  const ShapeType& getComponentShape() const override
+  {
+    return m_Store.getComponentShape();
+  }
+
+  void reshapeTuples(const ShapeType& tupleShape) override
+  {
+    m_Store.reshapeTuples(tupleShape);
+  }
+
+  value_type getValue(usize index) const override
+  {
+    return m_Store.getValue(index);
+  }
+
+  void setValue(usize index, value_type value) override
+  {
+    m_Store.setValue(index, value);
+  }
+
+  const_reference at(usize index) const override
+  {
+    return static_cast<const IDataStore<T>&>(m_Store).at(index);
+  }
+
+  const_reference operator[](usize index) const override
+  {
+    return static_cast<const IDataStore<T>&>(m_Store)[index];
+  }
+
+  reference operator[](usize index) override
+  {
+    return m_Store[index];
+  }
+
+  DataType getDataType() const override
+  {
+    return GetDataType<T>();
+  }
+
+  std::unique_ptr<IDataStore<T>> deepCopy() const override
+  {
+    return m_Store.deepCopy();
+  }
+
+  H5::ErrorType writeHdf5(H5::DatasetWriter& datasetWriter) const override
+  {
+    std::vector<hsize_t> dims;
+    std::copy(getTupleShape().begin(), getTupleShape().end(), std::back_inserter(dims));
+    std::copy(getComponentShape().begin(), getComponentShape().end(), std::back_inserter(dims));
+    const int rank = static_cast<int>(dims.size());
+    if(dims.empty() || m_Store.getSize() == 0)
+    {
+      return m_Store.writeHdf5(datasetWriter);
+    }
+
+    const std::vector<hsize_t> chunkShape = ChooseH5ChunkShape(dims, sizeof(T), m_Context.options);
+    const hid_t typeId = GetH5NativeType<T>();
+    const hid_t spaceId = H5Screate_simple(rank, dims.data(), nullptr);
+    const hid_t dcplId = CreateChunkedLayout(chunkShape, sizeof(T), m_Context);
+    const hid_t datasetId = H5Dcreate2(datasetWriter.getParentId(), datasetWriter.getName().c_str(), typeId, spaceId, H5P_DEFAULT, dcplId, H5P_DEFAULT);
+    H5Pclose(dcplId);
+    if(datasetId < 0)
+    {
+      H5Sclose(spaceId);
+      return -1;
+    }
+
+    // Whole rows of chunks at a time, so a compressed chunk is only written once and memory use is bounded by the chunk shape
+    const size_t rowValues = m_Store.getSize() / static_cast<size_t>(dims[0]);
+    const hsize_t rowsPerBlock = chunkShape[0];
+    const auto* dataStore = dynamic_cast<const DataStore<T>*>(&m_Store);
+    std::vector<T> buffer((nullptr == dataStore) ? static_cast<size_t>(std::min(rowsPerBlock, dims[0])) * rowValues : 0);
+    std::vector<hsize_t> start(dims.size(), 0);
+    std::vector<hsize_t> count = dims;
+    herr_t error = 0;
+    for(hsize_t row = 0; error >= 0 && row < dims[0]; row += rowsPerBlock)
+    {
+      start[0] = row;
+      count[0] = std::min(rowsPerBlock, dims[0] - row);
+      const size_t firstValue = static_cast<size_t>(row) * rowValues;
+      const size_t numValues = static_cast<size_t>(count[0]) * rowValues;
+      const T* values = nullptr;
+      if(nullptr != dataStore)
+      {
+        values = dataStore->data() + firstValue;
+      }
+      else
+      {
+        for(size_t i = 0; i < numValues; i++)
+        {
+          buffer[i] = m_Store.getValue(firstValue + i);
+        }
+        values = buffer.data();
+      }
+      const hid_t memSpaceId = H5Screate_simple(rank, count.data(), nullptr);
+      H5Sselect_hyperslab(spaceId, H5S_SELECT_SET, start.data(), nullptr, count.data(), nullptr);
+      error = H5Dwrite(datasetId, typeId, memSpaceId, spaceId, H5P_DEFAULT, values);
+      H5Sclose(memSpaceId);
+    }
+    H5Dclose(datasetId);
+    H5Sclose(spaceId);
+    if(error < 0)
+    {
+      return error;
+    }
+    return WriteH5ShapeAttributes(datasetWriter.getParentId(), datasetWriter.getName(), getTupleShape(), getComponentShape());
+  }
+
+private:
+  IDataStore<T>& m_Store;
+  const LayoutContext& m_Context;
+};
+
+// -----------------------------------------------------------------------------
+bool WriteH5File(const DataStructure& dataStructure, const std::filesystem::path& filePath)
+{
+  Result<H5::FileWriter> result = H5::FileWriter::CreateFile(filePath);
+  if(result.invalid())
+  {
+    std::cout << "Could not create " << filePath.string() << std::endl;
+    return false;
+  }
+  H5::FileWriter fileWriter = std::move(result.value());
+  return dataStructure.writeHdf5(fileWriter) >= 0;
+}
+} // namespace
+
+// -----------------------------------------------------------------------------
+H5WriteOptions H5WriteOptions::ForImageGeom(const ImageGeom& imageGeom, H5Compression compression, int32_t compressionLevel)
+{
+  H5WriteOptions options;
+  options.imageDims = {imageGeom.getNumZPoints(), imageGeom.getNumYPoints(), imageGeom.getNumXPoints()};
+  options.compression = compression;
+  options.compressionLevel = compressionLevel;
+  return options;
+}
+
+// -----------------------------------------------------------------------------
+bool H5WriteOptions::isDefault() const
+{
+  return chunkShape.empty() && imageDims.empty() && compression == H5Compression::None;
+}
+
+// -----------------------------------------------------------------------------
+std::vector<hsize_t> ChooseH5ChunkShape(const std::vector<hsize_t>& dims, size_t valueSize, const H5WriteOptions& options)
+{
+  std::vector<hsize_t> chunkShape = dims;
+  if(dims.empty())
+  {
+    return chunkShape;
+  }
+  if(options.chunkShape.size() == dims.size())
+  {
+    for(size_t i = 0; i < dims.size(); i++)
+    {
+      chunkShape[i] = std::clamp<hsize_t>(options.chunkShape[i], 1, std::max<hsize_t>(dims[i], 1));
+    }
+    return chunkShape;
+  }
+
+  hsize_t rowValues = 1;
+  for(size_t i = 1; i < dims.size(); i++)
+  {
+    rowValues *= dims[i];
+  }
+  const hsize_t rowBytes = std::max<hsize_t>(rowValues * valueSize, 1);
+
+  if(options.imageDims.size() == 3)
+  {
+    const hsize_t sliceElements = options.imageDims[1] * options.imageDims[2];
+    const hsize_t numElements = options.imageDims[0] * sliceElements;
+    if(dims.size() >= 3 && dims[0] == options.imageDims[0] && dims[1] == options.imageDims[1] && dims[2] == options.imageDims[2])
+    {
+      chunkShape[0] = 1;
+      return chunkShape;
+    }
+    if(numElements > 0 && dims[0] == numElements && sliceElements * rowBytes <= k_MaxChunkBytes)
+    {
+      chunkShape[0] = sliceElements;
+      return chunkShape;
+    }
+  }
+
+  chunkShape[0] = std::clamp<hsize_t>(H5WriteOptions::k_DefaultChunkBytes / rowBytes, 1, std::max<hsize_t>(dims[0], 1));
+  return chunkShape;
+}
+
+// -----------------------------------------------------------------------------
+bool WriteDataStructureHdf5(const DataStructure& dataStructure, const std::filesystem::path& filePath, const H5WriteOptions& options)
+{
+  std::lock_guard<std::recursive_mutex> lock(GetH5LibraryMutex());
+  if(options.isDefault())
+  {
+    return WriteH5File(dataStructure, filePath);
+  }
+
+  LayoutContext context = {options, options.compression};
+  if(context.compression == H5Compression::Zstd && H5Zfilter_avail(k_ZstdFilterId) <= 0)
+  {
+    std::cout << "The HDF5 zstd filter is not available (is HDF5_PLUGIN_PATH set?); using deflate instead" << std::endl;
+    context.compression = H5Compression::Deflate;
+  }
+
+  // The copy shares its arrays' values with the DataStructure. Its numeric arrays that are large
+  // enough to chunk get a store that writes them chunked; everything else is written as usual.
+  DataStructure layoutCopy = dataStructure;
+  std::vector<DataObject::IdType> arrayIds;
+  for(const auto& [id, dataObject] : layoutCopy)
+  {
+    arrayIds.push_back(id);
+  }
+  for(DataObject::IdType id : arrayIds)
+  {
+    auto* dataArray = dynamic_cast<IDataArray*>(layoutCopy.getData(id));
+    if(nullptr == dataArray)
+    {
+      continue;
+    }
+    VisitNumericDataType(dataArray->getDataType(), [&](auto value) {
+      using T = decltype(value);
+      auto* typedArray = dynamic_cast<DataArray<T>*>(dataArray);
+      IDataStore<T>* store = (nullptr != typedArray) ? typedArray->getDataStore() : nullptr;
+      if(nullptr != store && store->getSize() > 0 && store->getSize() * sizeof(T) >= options.minimumChunkedBytes)
+      {
+        typedArray->setDataStore(std::make_shared<ChunkedWriteStore<T>>(*store, context));
+      }
+    });
+  }
+
+  if(!WriteH5File(layoutCopy, filePath))
+  {
+    std::cout << "Could not write " << filePath.string() << std::endl;
+    std::error_code errorCode;
+    std::filesystem::remove(filePath, errorCode);
+    return false;
+  }
+  return true;
+}
+} // namespace complex
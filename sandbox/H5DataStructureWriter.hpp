@@ -0,0 +1,82 @@
+#pragma once
+
+#include "complex/DataStructure/DataStructure.hpp"
+#include "complex/DataStructure/Geometry/ImageGeom.hpp"
+
+#include <hdf5.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+namespace complex
+{
+enum class H5Compression : int32_t
+{
+  None = 0,
+  Deflate = 1, // gzip, always built into HDF5
+  Zstd = 2     // Registered filter 32015; needs the HDF5 zstd plugin (HDF5_PLUGIN_PATH) at write AND read time
+};
+
+/**
+ * @brief Layout and compression of the numeric datasets written by WriteDataStructureHdf5().
+ *
+ * Chunk shapes are picked per dataset, first match wins:
+ *   1. chunkShape, if it has the same rank as the dataset.
+ *   2. One Z-slice when the dataset holds an ImageGeom's cell data, i.e. its shape starts with
+ *      {Z, Y, X} (chunk {1, Y, X, ...}) or it is flattened to {Z*Y*X, ...} (chunk {Y*X, ...}).
+ *   3. Whole rows along the slowest dimension, about k_DefaultChunkBytes per chunk.
+ */
+struct H5WriteOptions
+{
+  static constexpr size_t k_DefaultChunkBytes = 1024 * 1024;
+  static constexpr size_t k_DefaultMinimumChunkedBytes = 64 * 1024;
+
+  std::vector<hsize_t> chunkShape;
+  std::vector<hsize_t> imageDims;      // {Z, Y, X} of the ImageGeom whose cell data is sliced; empty for none
+  H5Compression compression = H5Compression::None;
+  int32_t compressionLevel = 6;        // 1-9 for deflate, 1-22 for zstd
+  bool shuffle = true;                 // Byte shuffle multi-byte values before compressing; usually a large gain for both codecs
+  size_t minimumChunkedBytes = k_DefaultMinimumChunkedBytes; // Smaller datasets stay contiguous; a chunk index would cost more than it saves
+
+  /**
+   * @brief Chunks the cell data of the given geometry one Z-slice at a time.
+   * @param imageGeom
+   * @param compression
+   * @param compressionLevel
+   * @return
+   */
+  static H5WriteOptions ForImageGeom(const ImageGeom& imageGeom, H5Compression compression = H5Compression::Deflate, int32_t compressionLevel = 6);
+
+  /**
+   * @brief Returns true if datasets are written exactly as DataStructure::writeHdf5 writes them.
+   * @return
+   */
+  bool isDefault() const;
+};
+
+/**
+ * @brief Returns the chunk shape H5WriteOptions selects for a dataset.
+ * @param dims Shape of the dataset, slowest dimension first
+ * @param valueSize Bytes per value
+ * @param options
+ * @return
+ */
+std::vector<hsize_t> ChooseH5ChunkShape(const std::vector<hsize_t>& dims, size_t valueSize, const H5WriteOptions& options);
+
+/**
+ * @brief Writes the DataStructure like DataStructure::writeHdf5 does, but with the numeric
+ * datasets chunked and compressed as requested.
+ *
+ * complex's DatasetWriter always creates contiguous datasets, so the DataStructure is
+ * written through a copy of it (which shares the arrays' values) whose numeric arrays of at
+ * least minimumChunkedBytes create their dataset with the chunked layout themselves and
+ * write it one chunk row at a time. Everything else is written by complex as usual. The
+ * values are written once, straight into 'filePath'.
+ * @param dataStructure
+ * @param filePath
+ * @param options
+ * @return false if writing fails. A partially written 'filePath' is removed.
+ */
+bool WriteDataStructureHdf5(const DataStructure& dataStructure, const std::filesystem::path& filePath, const H5WriteOptions& options);
+} // namespace complex
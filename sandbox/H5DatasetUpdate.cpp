@@ -0,0 +1,328 @@
+#include "H5DatasetUpdate.hpp"
+
+#include "RawByteSource.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+namespace complex
+{
+namespace
+{
+// Attributes DataStructure::writeHdf5() writes: the id of every DataObject and, on the root, the id the next one gets
+constexpr const char* k_ObjectIdAttribute = "ObjectId";
+constexpr const char* k_NextObjectIdAttribute = "NextObjectId";
+// Raw files are copied into a dataset about this many bytes at a time
+constexpr size_t k_RawBlockBytes = 1024 * 1024;
+
+// -----------------------------------------------------------------------------
+bool H5ObjectExists(hid_t fileId, const std::string& objectPath)
+{
+  htri_t exists = 0;
+  H5E_BEGIN_TRY
+  {
+    exists = H5Lexists(fileId, objectPath.c_str(), H5P_DEFAULT);
+  }
+  H5E_END_TRY;
+  return exists > 0;
+}
+
+// -----------------------------------------------------------------------------
+bool ReadIdAttribute(hid_t objectId, const char* name, uint64_t& value)
+{
+  if(H5Aexists(objectId, name) <= 0)
+  {
+    return false;
+  }
+  const hid_t attributeId = H5Aopen(objectId, name, H5P_DEFAULT);
+  if(attributeId < 0)
+  {
+    return false;
+  }
+  const herr_t error = H5Aread(attributeId, H5T_NATIVE_UINT64, &value);
+  H5Aclose(attributeId);
+  return error >= 0;
+}
+
+// -----------------------------------------------------------------------------
+bool WriteIdAttribute(hid_t objectId, const char* name, uint64_t value)
+{
+  const hid_t attributeId = H5Aopen(objectId, name, H5P_DEFAULT);
+  if(attributeId < 0)
+  {
+    return false;
+  }
+  const herr_t error = H5Awrite(attributeId, H5T_NATIVE_UINT64, &value);
+  H5Aclose(attributeId);
+  return error >= 0;
+}
+
+// -----------------------------------------------------------------------------
+bool RenumberH5Object(hid_t fileId, const std::string& objectPath, uint64_t& nextId)
+{
+  const hid_t objectId = H5Oopen(fileId, objectPath.c_str(), H5P_DEFAULT);
+  if(objectId < 0)
+  {
+    return false;
+  }
+  uint64_t currentId = 0;
+  bool success = true;
+  if(ReadIdAttribute(objectId, k_ObjectIdAttribute, currentId))
+  {
+    success = WriteIdAttribute(objectId, k_ObjectIdAttribute, nextId++);
+  }
+  H5Oclose(objectId);
+  return success;
+}
+
+// -----------------------------------------------------------------------------
+herr_t CollectLinkNames(hid_t /*groupId*/, const char* name, const H5L_info_t* /*linkInfo*/, void* operatorData)
+{
+  static_cast<std::vector<std::string>*>(operatorData)->emplace_back(name);
+  return 0;
+}
+} // namespace
+
+// -----------------------------------------------------------------------------
+hid_t GetH5RawFileType(const RawSourceFormat& sourceFormat)
+{
+  const bool bigEndian = (sourceFormat.byteOrder == Endian::Big);
+  switch(sourceFormat.dataType)
+  {
+  case DataType::int8:
+    return bigEndian ? H5T_STD_I8BE : H5T_STD_I8LE;
+  case DataType::uint8:
+    return bigEndian ? H5T_STD_U8BE : H5T_STD_U8LE;
+  case DataType::int16:
+    return bigEndian ? H5T_STD_I16BE : H5T_STD_I16LE;
+  case DataType::uint16:
+    return bigEndian ? H5T_STD_U16BE : H5T_STD_U16LE;
+  case DataType::int32:
+    return bigEndian ? H5T_STD_I32BE : H5T_STD_I32LE;
+  case DataType::uint32:
+    return bigEndian ? H5T_STD_U32BE : H5T_STD_U32LE;
+  case DataType::int64:
+    return bigEndian ? H5T_STD_I64BE : H5T_STD_I64LE;
+  case DataType::uint64:
+    return bigEndian ? H5T_STD_U64BE : H5T_STD_U64LE;
+  case DataType::float32:
+    return bigEndian ? H5T_IEEE_F32BE : H5T_IEEE_F32LE;
+  case DataType::float64:
+    return bigEndian ? H5T_IEEE_F64BE : H5T_IEEE_F64LE;
+  default:
+    return H5I_INVALID_HID;
+  }
+}
+
+// -----------------------------------------------------------------------------
+bool OverwriteH5DatasetFromRawFile(hid_t fileId, const std::string& datasetPath, const std::filesystem::path& rawFilePath, const RawSourceFormat& sourceFormat)
+{
+  const hid_t memoryType = GetH5RawFileType(sourceFormat);
+  const size_t valueSize = GetDataTypeSize(sourceFormat.dataType);
+  if(memoryType == H5I_INVALID_HID || valueSize == 0)
+  {
+    return false;
+  }
+
+  // A missing dataset is an expected outcome (the caller falls back to a full write) so keep HDF5 quiet about it
+  hid_t datasetId = H5I_INVALID_HID;
+  H5E_BEGIN_TRY
+  {
+    datasetId = H5Dopen2(fileId, datasetPath.c_str(), H5P_DEFAULT);
+  }
+  H5E_END_TRY;
+  if(datasetId < 0)
+  {
+    return false;
+  }
+
+  const hid_t spaceId = H5Dget_space(datasetId);
+  const int rank = H5Sget_simple_extent_ndims(spaceId);
+  std::unique_ptr<RawByteSource> byteSource = RawByteSource::Open(rawFilePath, sourceFormat.decompress);
+  if(rank <= 0 || nullptr == byteSource)
+  {
+    H5Sclose(spaceId);
+    H5Dclose(datasetId);
+    return false;
+  }
+  std::vector<hsize_t> dims(static_cast<size_t>(rank));
+  H5Sget_simple_extent_dims(spaceId, dims.data(), nullptr);
+  const hssize_t numValues = H5Sget_simple_extent_npoints(spaceId);
+
+  // Whole rows along the slowest dimension: a row of chunks at a time for a chunked dataset, so each
+  // compressed chunk is only written once, otherwise about k_RawBlockBytes
+  const size_t rowBytes = (dims[0] == 0) ? 0 : static_cast<size_t>(numValues) / static_cast<size_t>(dims[0]) * valueSize;
+  hsize_t rowsPerBlock = std::max<hsize_t>(1, k_RawBlockBytes / std::max<size_t>(rowBytes, 1));
+  const hid_t dcplId = H5Dget_create_plist(datasetId);
+  std::vector<hsize_t> chunkShape(dims.size());
+  if(H5Pget_layout(dcplId) == H5D_CHUNKED && H5Pget_chunk(dcplId, rank, chunkShape.data()) == rank)
+  {
+    rowsPerBlock = chunkShape[0];
+  }
+  H5Pclose(dcplId);
+
+  std::vector<std::byte> buffer(static_cast<size_t>(std::min(rowsPerBlock, dims[0])) * rowBytes);
+  std::vector<hsize_t> start(dims.size(), 0);
+  std::vector<hsize_t> count = dims;
+  bool complete = true;
+  herr_t error = 0;
+  for(hsize_t row = 0; complete && error >= 0 && row < dims[0]; row += rowsPerBlock)
+  {
+    start[0] = row;
+    count[0] = std::min(rowsPerBlock, dims[0] - row);
+    const size_t numBytes = static_cast<size_t>(count[0]) * rowBytes;
+    complete = (byteSource->read(buffer.data(), numBytes) == numBytes);
+    if(complete)
+    {
+      const hid_t memSpaceId = H5Screate_simple(rank, count.data(), nullptr);
+      H5Sselect_hyperslab(spaceId, H5S_SELECT_SET, start.data(), nullptr, count.data(), nullptr);
+      error = H5Dwrite(datasetId, memoryType, memSpaceId, spaceId, H5P_DEFAULT, buffer.data());
+      H5Sclose(memSpaceId);
+    }
+  }
+  H5Sclose(spaceId);
+  H5Dclose(datasetId);
+
+  // The dataset has already been partly overwritten by now, but the caller rewrites the whole file when this fails
+  std::byte extraByte;
+  if(!complete || byteSource->read(&extraByte, 1) != 0 || byteSource->hasError())
+  {
+    std::cout << "'" << rawFilePath.string() << "' no longer holds " << numValues << " values for " << datasetPath << std::endl;
+    return false;
+  }
+  return error >= 0;
+}
+
+// -----------------------------------------------------------------------------
+bool LinkH5Dataset(hid_t fileId, const std::string& targetPath, const std::string& linkPath)
+{
+  hid_t targetId = H5I_INVALID_HID;
+  hid_t placeholderId = H5I_INVALID_HID;
+  H5E_BEGIN_TRY
+  {
+    targetId = H5Dopen2(fileId, targetPath.c_str(), H5P_DEFAULT);
+    placeholderId = H5Dopen2(fileId, linkPath.c_str(), H5P_DEFAULT);
+  }
+  H5E_END_TRY;
+
+  bool isPlaceholder = false;
+  if(placeholderId >= 0)
+  {
+    const hid_t dataspaceId = H5Dget_space(placeholderId);
+    isPlaceholder = (H5Sget_simple_extent_npoints(dataspaceId) == 0);
+    H5Sclose(dataspaceId);
+    H5Dclose(placeholderId);
+  }
+  if(targetId >= 0)
+  {
+    H5Dclose(targetId);
+  }
+  if(targetId < 0 || !isPlaceholder)
+  {
+    return false;
+  }
+
+  if(H5Ldelete(fileId, linkPath.c_str(), H5P_DEFAULT) < 0)
+  {
+    return false;
+  }
+  return H5Lcreate_hard(fileId, targetPath.c_str(), fileId, linkPath.c_str(), H5P_DEFAULT, H5P_DEFAULT) >= 0;
+}
+
+// -----------------------------------------------------------------------------
+bool RemoveH5Dataset(hid_t fileId, const std::string& datasetPath)
+{
+  hid_t datasetId = H5I_INVALID_HID;
+  H5E_BEGIN_TRY
+  {
+    datasetId = H5Dopen2(fileId, datasetPath.c_str(), H5P_DEFAULT);
+  }
+  H5E_END_TRY;
+  if(datasetId < 0)
+  {
+    return false;
+  }
+  H5Dclose(datasetId);
+  return H5Ldelete(fileId, datasetPath.c_str(), H5P_DEFAULT) >= 0;
+}
+
+// -----------------------------------------------------------------------------
+bool CopyH5Datasets(hid_t srcFileId, hid_t dstFileId, const std::vector<std::string>& datasetPaths)
+{
+  // The highest copied object of each dataset: the dataset itself or the first group above it that is new
+  std::vector<std::string> copiedPaths;
+  for(const std::string& datasetPath : datasetPaths)
+  {
+    if(H5ObjectExists(dstFileId, datasetPath))
+    {
+      // Already brought along by a group copied for an earlier dataset?
+      const bool isCopied = std::any_of(copiedPaths.begin(), copiedPaths.end(),
+                                        [&datasetPath](const std::string& copiedPath) { return datasetPath.rfind(copiedPath + "/", 0) == 0; });
+      if(!isCopied)
+      {
+        std::cout << datasetPath << " already exists in the destination file" << std::endl;
+        return false;
+      }
+      continue;
+    }
+
+    std::string copyPath = datasetPath;
+    for(size_t separator = datasetPath.find('/', 1); separator != std::string::npos; separator = datasetPath.find('/', separator + 1))
+    {
+      const std::string groupPath = datasetPath.substr(0, separator);
+      if(groupPath.size() >= 2 && groupPath.compare(groupPath.size() - 2, 2, "/.") == 0)
+      {
+        continue;
+      }
+      if(!H5ObjectExists(dstFileId, groupPath))
+      {
+        copyPath = groupPath;
+        break;
+      }
+    }
+    if(H5Ocopy(srcFileId, copyPath.c_str(), dstFileId, copyPath.c_str(), H5P_DEFAULT, H5P_DEFAULT) < 0)
+    {
+      std::cout << "Could not copy " << copyPath << " into the destination file" << std::endl;
+      return false;
+    }
+    copiedPaths.push_back(copyPath);
+  }
+
+  // Without a recorded next id there is nothing to keep consistent
+  uint64_t nextId = 0;
+  const hid_t rootId = H5Oopen(dstFileId, "/", H5P_DEFAULT);
+  if(rootId < 0)
+  {
+    return false;
+  }
+  if(!ReadIdAttribute(rootId, k_NextObjectIdAttribute, nextId))
+  {
+    H5Oclose(rootId);
+    return true;
+  }
+  bool success = true;
+  for(const std::string& copiedPath : copiedPaths)
+  {
+    success = success && RenumberH5Object(dstFileId, copiedPath, nextId);
+    const hid_t objectId = success ? H5Oopen(dstFileId, copiedPath.c_str(), H5P_DEFAULT) : H5I_INVALID_HID;
+    std::vector<std::string> names;
+    if(objectId >= 0)
+    {
+      if(H5Iget_type(objectId) == H5I_GROUP)
+      {
+        success = H5Lvisit(objectId, H5_INDEX_NAME, H5_ITER_INC, CollectLinkNames, &names) >= 0;
+      }
+      H5Oclose(objectId);
+    }
+    for(const std::string& name : names)
+    {
+      success = success && RenumberH5Object(dstFileId, copiedPath + "/" + name, nextId);
+    }
+  }
+  success = success && WriteIdAttribute(rootId, k_NextObjectIdAttribute, nextId);
+  H5Oclose(rootId);
+  return success;
+}
+} // namespace complex
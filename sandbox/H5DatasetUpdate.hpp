@@ -0,0 +1,72 @@
+#pragma once
+
+#include "ConversionKernels.hpp"
+
+#include <hdf5.h>
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace complex
+{
+// The functions that take a file id expect the caller to hold GetH5LibraryMutex() (see H5Types.hpp).
+
+/**
+ * @brief Returns the HDF5 type that describes values of the type and byte order as they are stored in a raw file.
+ * @param sourceFormat
+ * @return A predefined type that must NOT be closed, or H5I_INVALID_HID for types that can not be read from a raw file.
+ */
+hid_t GetH5RawFileType(const RawSourceFormat& sourceFormat);
+
+/**
+ * @brief Replaces the values of an existing dataset with the contents of a raw file,
+ * leaving the rest of the HDF5 file untouched. HDF5 converts the values from the raw
+ * file's type and byte order into the dataset's own type during the write.
+ *
+ * The dataset's shape is not changed, so the raw file has to hold exactly as many
+ * values as the dataset. The file is streamed in blocks of whole rows, so memory use
+ * does not grow with its size. Compressed raw files are decompressed on the fly when
+ * the sourceFormat asks for it.
+ * @param fileId HDF5 file opened with H5F_ACC_RDWR
+ * @param datasetPath Absolute path of the dataset inside the HDF5 file
+ * @param rawFilePath
+ * @param sourceFormat
+ * @return false if the dataset does not exist, the raw file holds a different number of values or any I/O fails.
+ */
+bool OverwriteH5DatasetFromRawFile(hid_t fileId, const std::string& datasetPath, const std::filesystem::path& rawFilePath, const RawSourceFormat& sourceFormat);
+
+/**
+ * @brief Replaces the empty placeholder dataset written for a SharedDataStore link with
+ * a hard link to the dataset that holds the values. Both paths then name the same
+ * dataset, so the values are stored once.
+ * @param fileId HDF5 file opened with H5F_ACC_RDWR
+ * @param targetPath Absolute path of the dataset that holds the values
+ * @param linkPath Absolute path of the placeholder
+ * @return false if either dataset is missing or 'linkPath' is not an empty placeholder. Nothing is changed in that case.
+ */
+bool LinkH5Dataset(hid_t fileId, const std::string& targetPath, const std::string& linkPath);
+
+/**
+ * @brief Removes a dataset's name from an HDF5 file. The dataset itself is only freed once
+ * no other hard link names it, and the file does not shrink: its space is reclaimed by the
+ * next full rewrite.
+ * @param fileId HDF5 file opened with H5F_ACC_RDWR
+ * @param datasetPath Absolute path of the dataset inside the HDF5 file
+ * @return false if there is no dataset at 'datasetPath'. Nothing is changed in that case.
+ */
+bool RemoveH5Dataset(hid_t fileId, const std::string& datasetPath);
+
+/**
+ * @brief Copies datasets from one HDF5 file into the same paths of another, together with
+ * any groups above them that the destination does not have yet, so a DataStructure written
+ * to 'srcFileId' is merged into the one written to 'dstFileId'. Attributes are copied with
+ * the objects. When the destination records its next DataObject id, the copied objects are
+ * given new ids from it so no id is used twice.
+ * @param srcFileId
+ * @param dstFileId HDF5 file opened with H5F_ACC_RDWR
+ * @param datasetPaths Absolute paths of the datasets to copy
+ * @return false if a dataset already exists in the destination or a copy fails. Objects copied before the failure are kept.
+ */
+bool CopyH5Datasets(hid_t srcFileId, hid_t dstFileId, const std::vector<std::string>& datasetPaths);
+} // namespace complex
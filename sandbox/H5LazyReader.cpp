@@ -0,0 +1,300 @@
+#include "H5LazyReader.hpp"
+
+#include "H5SubvolumeReader.hpp"
+#include "H5Types.hpp"
+#include "LazyDataStore.hpp"
+
+#include "complex/DataStructure/DataArray.hpp"
+#include "complex/DataStructure/DataGroup.hpp"
+#include "complex/DataStructure/DataStore.hpp"
+#include "complex/DataStructure/Geometry/ImageGeom.hpp"
+
+#include <hdf5.h>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace complex
+{
+namespace
+{
+struct LazyReadContext
+{
+  std::shared_ptr<DataStructure> dataGraph;
+  std::filesystem::path filePath;
+  size_t numArrays = 0;
+  size_t numSkipped = 0;
+};
+
+struct GroupRead
+{
+  std::optional<DataObject::IdType> parentId;
+  std::string path;
+  LazyReadContext& context;
+};
+
+/**
+ * @brief Reads the whole dataset. Runs when a lazy array's values are first touched.
+ */
+template <typename T>
+std::shared_ptr<IDataStore<T>> ReadH5DataStore(const std::filesystem::path& filePath, const std::string& datasetPath, const typename IDataStore<T>::ShapeType& tupleShape,
+                                               const typename IDataStore<T>::ShapeType& componentShape)
+{
+  auto dataStore = std::make_shared<DataStore<T>>(tupleShape, componentShape);
+  // Deferred reads can start on any thread; HDF5 itself is only entered by one of them at a time
+  std::lock_guard<std::recursive_mutex> lock(GetH5LibraryMutex());
+  const hid_t fileId = H5Fopen(filePath.string().c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+  if(fileId < 0)
+  {
+    std::cout << "Could not open " << filePath.string() << " to read " << datasetPath << std::endl;
+    return nullptr;
+  }
+  const hid_t datasetId = H5Dopen2(fileId, datasetPath.c_str(), H5P_DEFAULT);
+  herr_t err = -1;
+  if(datasetId >= 0)
+  {
+    // The dataset may have changed since the file was opened lazily; never read more values than were promised
+    const hid_t spaceId = H5Dget_space(datasetId);
+    const hssize_t numValues = H5Sget_simple_extent_npoints(spaceId);
+    if(numValues >= 0 && static_cast<size_t>(numValues) == dataStore->getSize())
+    {
+      err = H5Dread(datasetId, GetH5NativeType<T>(), H5S_ALL, H5S_ALL, H5P_DEFAULT, dataStore->data());
+    }
+    H5Sclose(spaceId);
+    H5Dclose(datasetId);
+  }
+  H5Fclose(fileId);
+  if(err < 0)
+  {
+    std::cout << "Could not read " << datasetPath << " from " << filePath.string() << std::endl;
+    return nullptr;
+  }
+  return dataStore;
+}
+
+template <typename T>
+void CreateLazyArray(LazyReadContext& context, const std::string& name, const std::string& datasetPath, std::optional<DataObject::IdType> parentId,
+                     typename IDataStore<T>::ShapeType tupleShape, typename IDataStore<T>::ShapeType componentShape)
+{
+  auto loader = [filePath = context.filePath, datasetPath, tupleShape, componentShape]() { return ReadH5DataStore<T>(filePath, datasetPath, tupleShape, componentShape); };
+  auto dataStore = std::make_shared<LazyDataStore<T>>(std::move(tupleShape), std::move(componentShape), std::move(loader));
+  DataArray<T>::Create(*context.dataGraph, name, dataStore, parentId);
+  context.numArrays++;
+}
+
+/**
+ * @brief Reads a one dimensional attribute of unsigned integers.
+ * @return Empty if the attribute is missing or can not be read.
+ */
+std::vector<usize> ReadShapeAttribute(hid_t objectId, const char* name)
+{
+  if(H5Aexists(objectId, name) <= 0)
+  {
+    return {};
+  }
+  const hid_t attributeId = H5Aopen(objectId, name, H5P_DEFAULT);
+  if(attributeId < 0)
+  {
+    return {};
+  }
+  const hid_t spaceId = H5Aget_space(attributeId);
+  const hssize_t numValues = H5Sget_simple_extent_npoints(spaceId);
+  std::vector<uint64> values(static_cast<size_t>(std::max<hssize_t>(numValues, 0)));
+  const bool success = !values.empty() && H5Aread(attributeId, H5T_NATIVE_UINT64, values.data()) >= 0;
+  H5Sclose(spaceId);
+  H5Aclose(attributeId);
+  if(!success)
+  {
+    return {};
+  }
+  return std::vector<usize>(values.begin(), values.end());
+}
+
+/**
+ * @brief Splits a dataset's dims into the array's tuple and component shapes. The component
+ * shape comes from the dataset's ComponentShape attribute; a dataset without one (or with one
+ * that does not fit its dims) is taken to hold its components in its last dimension.
+ */
+void SplitDatasetShape(const std::vector<hsize_t>& dims, std::vector<usize> componentShape, std::vector<usize>& tupleShape, std::vector<usize>& outComponentShape)
+{
+  const size_t numValues = std::accumulate(dims.begin(), dims.end(), static_cast<size_t>(1), std::multiplies<>());
+  const size_t numComponents = std::accumulate(componentShape.begin(), componentShape.end(), static_cast<size_t>(1), std::multiplies<>());
+  if(!componentShape.empty() && numComponents > 0 && numValues % numComponents == 0)
+  {
+    outComponentShape = std::move(componentShape);
+    if(outComponentShape.size() < dims.size() && std::equal(outComponentShape.rbegin(), outComponentShape.rend(), dims.rbegin()))
+    {
+      tupleShape.assign(dims.begin(), dims.end() - static_cast<std::ptrdiff_t>(outComponentShape.size()));
+    }
+    else
+    {
+      tupleShape = {numValues / numComponents};
+    }
+    return;
+  }
+
+  tupleShape.assign(dims.begin(), dims.end());
+  outComponentShape = {1};
+  if(tupleShape.size() > 1)
+  {
+    outComponentShape = {tupleShape.back()};
+    tupleShape.pop_back();
+  }
+}
+
+// -----------------------------------------------------------------------------
+bool CreateLazyArray(hid_t groupId, const char* name, const std::string& datasetPath, std::optional<DataObject::IdType> parentId, LazyReadContext& context)
+{
+  const hid_t datasetId = H5Dopen2(groupId, name, H5P_DEFAULT);
+  if(datasetId < 0)
+  {
+    return false;
+  }
+  const hid_t typeId = H5Dget_type(datasetId);
+  const hid_t spaceId = H5Dget_space(datasetId);
+  const std::optional<DataType> dataType = GetDataTypeFromH5(typeId);
+  const int rank = H5Sget_simple_extent_ndims(spaceId);
+  std::vector<hsize_t> dims(static_cast<size_t>(std::max(rank, 0)));
+  if(rank > 0)
+  {
+    H5Sget_simple_extent_dims(spaceId, dims.data(), nullptr);
+  }
+  std::vector<usize> storedComponentShape = ReadShapeAttribute(datasetId, k_ComponentShapeAttribute);
+  H5Sclose(spaceId);
+  H5Tclose(typeId);
+  H5Dclose(datasetId);
+
+  if(!dataType.has_value() || rank <= 0)
+  {
+    context.numSkipped++;
+    return true;
+  }
+
+  std::vector<usize> tupleShape;
+  std::vector<usize> componentShape;
+  SplitDatasetShape(dims, std::move(storedComponentShape), tupleShape, componentShape);
+
+  const bool isNumeric = VisitNumericDataType(*dataType, [&](auto value) {
+    using T = decltype(value);
+    CreateLazyArray<T>(context, name, datasetPath, parentId, tupleShape, componentShape);
+  });
+  if(!isNumeric)
+  {
+    context.numSkipped++;
+  }
+  return true;
+}
+
+bool ReadGroupMembers(hid_t groupId, std::optional<DataObject::IdType> parentId, const std::string& path, LazyReadContext& context);
+
+// -----------------------------------------------------------------------------
+herr_t ReadLink(hid_t groupId, const char* name, const H5L_info_t* info, void* groupReadPtr)
+{
+  GroupRead& groupRead = *static_cast<GroupRead*>(groupReadPtr);
+  LazyReadContext& context = groupRead.context;
+  const std::string objectPath = groupRead.path + "/" + name;
+
+  // Soft and external links point at objects that are listed under their own path
+  if(info->type != H5L_TYPE_HARD)
+  {
+    return 0;
+  }
+#if H5_VERSION_GE(1, 12, 0)
+  H5O_info2_t objectInfo;
+  if(H5Oget_info_by_name3(groupId, name, &objectInfo, H5O_INFO_BASIC, H5P_DEFAULT) < 0)
+#else
+  H5O_info_t objectInfo;
+  if(H5Oget_info_by_name2(groupId, name, &objectInfo, H5O_INFO_BASIC, H5P_DEFAULT) < 0)
+#endif
+  {
+    return -1;
+  }
+
+  if(objectInfo.type == H5O_TYPE_GROUP)
+  {
+    const hid_t childId = H5Gopen2(groupId, name, H5P_DEFAULT);
+    if(childId < 0)
+    {
+      return -1;
+    }
+    std::optional<DataObject::IdType> childParentId;
+    // A group with ImageGeom dimensions is turned back into the geometry, the same way ReadImageGeomSubvolume() finds one
+    std::array<uint64, 3> dims = {0, 0, 0};
+    if(ReadVec3Attribute(childId, k_ImageGeomDimensionsAttribute.c_str(), H5T_NATIVE_UINT64, dims))
+    {
+      std::array<float32, 3> spacing = {1.0f, 1.0f, 1.0f};
+      std::array<float32, 3> origin = {0.0f, 0.0f, 0.0f};
+      ReadVec3Attribute(childId, k_ImageGeomSpacingAttribute.c_str(), H5T_NATIVE_FLOAT, spacing);
+      ReadVec3Attribute(childId, k_ImageGeomOriginAttribute.c_str(), H5T_NATIVE_FLOAT, origin);
+      ImageGeom* imageGeom = ImageGeom::Create(*context.dataGraph, name, groupRead.parentId);
+      if(nullptr != imageGeom)
+      {
+        imageGeom->setDimensions({dims[0], dims[1], dims[2]});
+        imageGeom->setSpacing({spacing[0], spacing[1], spacing[2]});
+        imageGeom->setOrigin({origin[0], origin[1], origin[2]});
+        childParentId = imageGeom->getId();
+      }
+    }
+    else if(DataGroup* dataGroup = DataGroup::Create(*context.dataGraph, name, groupRead.parentId); nullptr != dataGroup)
+    {
+      childParentId = dataGroup->getId();
+    }
+    const bool success = childParentId.has_value() && ReadGroupMembers(childId, childParentId, objectPath, context);
+    H5Gclose(childId);
+    if(!childParentId.has_value())
+    {
+      std::cout << "Could not create a DataGroup or ImageGeom for " << objectPath << std::endl;
+    }
+    return success ? 0 : -1;
+  }
+  if(objectInfo.type == H5O_TYPE_DATASET)
+  {
+    return CreateLazyArray(groupId, name, objectPath, groupRead.parentId, context) ? 0 : -1;
+  }
+  return 0;
+}
+
+// -----------------------------------------------------------------------------
+bool ReadGroupMembers(hid_t groupId, std::optional<DataObject::IdType> parentId, const std::string& path, LazyReadContext& context)
+{
+  GroupRead groupRead = {parentId, path, context};
+  hsize_t index = 0;
+  return H5Literate(groupId, H5_INDEX_NAME, H5_ITER_INC, &index, ReadLink, &groupRead) >= 0;
+}
+} // namespace
+
+// -----------------------------------------------------------------------------
+std::shared_ptr<DataStructure> ReadDataStructureHdf5Lazy(const std::filesystem::path& filePath)
+{
+  LazyReadContext context = {std::make_shared<DataStructure>(), filePath};
+  std::lock_guard<std::recursive_mutex> lock(GetH5LibraryMutex());
+  const hid_t fileId = H5Fopen(filePath.string().c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+  if(fileId < 0)
+  {
+    std::cout << "Could not open " << filePath.string() << std::endl;
+    return nullptr;
+  }
+  const hid_t rootId = H5Gopen2(fileId, "/", H5P_DEFAULT);
+  const bool success = ReadGroupMembers(rootId, {}, "", context);
+  H5Gclose(rootId);
+  H5Fclose(fileId);
+  if(!success)
+  {
+    std::cout << "Could not read the hierarchy of " << filePath.string() << std::endl;
+    return nullptr;
+  }
+  if(context.numSkipped > 0)
+  {
+    std::cout << "Skipped " << context.numSkipped << " non-numeric datasets in " << filePath.string() << std::endl;
+  }
+  return context.dataGraph;
+}
+} // namespace complex
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "complex/DataStructure/DataStructure.hpp"
+
+#include <filesystem>
+#include <memory>
+
+namespace complex
+{
+/**
+ * @brief Builds a DataStructure from an HDF5 file's metadata only. Every group becomes a
+ * DataGroup or ImageGeom and every numeric dataset a DataArray backed by a LazyDataStore,
+ * so opening even a very large file reads nothing but the object headers and attributes.
+ * A dataset's values are read the first time anything touches them.
+ *
+ * A dataset's component shape is read from its ComponentShape attribute and the dims in
+ * front of it form the tuple shape. Without that attribute the last dimension is taken as
+ * the component count (a 1D dataset has one component). Datasets that are not integers or
+ * floats (e.g. strings) are skipped. Groups with ImageGeom dimensions become ImageGeoms
+ * with their dimensions, spacing and origin; every other group becomes a DataGroup.
+ *
+ * The file is opened again for every deferred read, so it may be replaced in between;
+ * those reads are serialized because HDF5 may not be built thread safe.
+ * @param filePath
+ * @return nullptr if the file can not be opened or its hierarchy can not be walked.
+ */
+std::shared_ptr<DataStructure> ReadDataStructureHdf5Lazy(const std::filesystem::path& filePath);
+} // namespace complex
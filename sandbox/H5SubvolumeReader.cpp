@@ -0,0 +1,306 @@
+#include "H5SubvolumeReader.hpp"
+
+#include "H5Types.hpp"
+
+#include "complex/DataStructure/DataArray.hpp"
+#include "complex/DataStructure/DataGroup.hpp"
+#include "complex/DataStructure/DataStore.hpp"
+#include "complex/DataStructure/Geometry/ImageGeom.hpp"
+
+#include <hdf5.h>
+
+#include <algorithm>
+#include <array>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace complex
+{
+namespace
+{
+/**
+ * @brief How a cell array's dataset maps onto the geometry's voxels.
+ */
+enum class CellLayout
+{
+  None,   // Not cell data of this geometry
+  Volume, // {Z, Y, X, components...}
+  Flat    // {Z*Y*X, components...}
+};
+
+struct Subvolume
+{
+  SizeVec3 dims = {0, 0, 0}; // Of the whole geometry
+  SizeVec3 min = {0, 0, 0};
+  SizeVec3 extent = {0, 0, 0};
+};
+
+// -----------------------------------------------------------------------------
+herr_t CollectDataset(hid_t groupId, const char* name, const H5L_info_t* info, void* namesPtr)
+{
+  if(info->type != H5L_TYPE_HARD)
+  {
+    return 0;
+  }
+#if H5_VERSION_GE(1, 12, 0)
+  H5O_info2_t objectInfo;
+  if(H5Oget_info_by_name3(groupId, name, &objectInfo, H5O_INFO_BASIC, H5P_DEFAULT) < 0)
+#else
+  H5O_info_t objectInfo;
+  if(H5Oget_info_by_name2(groupId, name, &objectInfo, H5O_INFO_BASIC, H5P_DEFAULT) < 0)
+#endif
+  {
+    return -1;
+  }
+  if(objectInfo.type == H5O_TYPE_DATASET)
+  {
+    static_cast<std::vector<std::string>*>(namesPtr)->push_back(name);
+  }
+  return 0;
+}
+
+// -----------------------------------------------------------------------------
+std::vector<std::string> ListDatasets(hid_t groupId)
+{
+  std::vector<std::string> names;
+  hsize_t index = 0;
+  H5Literate(groupId, H5_INDEX_NAME, H5_ITER_INC, &index, CollectDataset, &names);
+  return names;
+}
+
+// -----------------------------------------------------------------------------
+CellLayout GetCellLayout(const std::vector<hsize_t>& dims, const SizeVec3& geomDims)
+{
+  const hsize_t numVoxels = geomDims[0] * geomDims[1] * geomDims[2];
+  if(dims.size() >= 3 && dims[0] == geomDims[2] && dims[1] == geomDims[1] && dims[2] == geomDims[0])
+  {
+    return CellLayout::Volume;
+  }
+  if(!dims.empty() && dims[0] == numVoxels)
+  {
+    return CellLayout::Flat;
+  }
+  return CellLayout::None;
+}
+
+/**
+ * @brief Selects the subvolume's voxels in the dataset's file space.
+ * @return The number of values selected.
+ */
+hsize_t SelectSubvolume(hid_t spaceId, const std::vector<hsize_t>& dims, CellLayout layout, const Subvolume& subvolume)
+{
+  const size_t rank = dims.size();
+  const size_t firstComponentDim = (layout == CellLayout::Volume) ? 3 : 1;
+  hsize_t numComponents = 1;
+  for(size_t i = firstComponentDim; i < rank; i++)
+  {
+    numComponents *= dims[i];
+  }
+
+  std::vector<hsize_t> start(rank, 0);
+  std::vector<hsize_t> count(dims);
+  if(layout == CellLayout::Volume)
+  {
+    // Dataset dimensions run Z, Y, X; the bounds are X, Y, Z
+    for(size_t i = 0; i < 3; i++)
+    {
+      start[i] = subvolume.min[2 - i];
+      count[i] = subvolume.extent[2 - i];
+    }
+    H5Sselect_hyperslab(spaceId, H5S_SELECT_SET, start.data(), nullptr, count.data(), nullptr);
+  }
+  else
+  {
+    // Flattened voxels: every Z-slice is one regular pattern of extent[1] rows of extent[0] voxels, X voxels apart
+    const hsize_t numX = subvolume.dims[0];
+    const hsize_t sliceVoxels = numX * subvolume.dims[1];
+    std::vector<hsize_t> stride(rank, 1);
+    std::vector<hsize_t> block(dims);
+    stride[0] = numX;
+    count = std::vector<hsize_t>(rank, 1);
+    count[0] = subvolume.extent[1];
+    block[0] = subvolume.extent[0];
+    H5Sselect_none(spaceId);
+    for(hsize_t z = subvolume.min[2]; z < subvolume.min[2] + subvolume.extent[2]; z++)
+    {
+      start[0] = z * sliceVoxels + subvolume.min[1] * numX + subvolume.min[0];
+      H5Sselect_hyperslab(spaceId, H5S_SELECT_OR, start.data(), stride.data(), count.data(), block.data());
+    }
+  }
+  return subvolume.extent[0] * subvolume.extent[1] * subvolume.extent[2] * numComponents;
+}
+
+// -----------------------------------------------------------------------------
+template <typename T>
+std::shared_ptr<DataStore<T>> ReadCellSubvolume(hid_t datasetId, const std::vector<hsize_t>& dims, CellLayout layout, const Subvolume& subvolume)
+{
+  typename IDataStore<T>::ShapeType tupleShape;
+  typename IDataStore<T>::ShapeType componentShape;
+  if(layout == CellLayout::Volume)
+  {
+    tupleShape = {subvolume.extent[2], subvolume.extent[1], subvolume.extent[0]};
+    componentShape.assign(dims.begin() + 3, dims.end());
+  }
+  else
+  {
+    tupleShape = {subvolume.extent[0] * subvolume.extent[1] * subvolume.extent[2]};
+    componentShape.assign(dims.begin() + 1, dims.end());
+  }
+  if(componentShape.empty())
+  {
+    componentShape = {1};
+  }
+  auto dataStore = std::make_shared<DataStore<T>>(tupleShape, componentShape);
+
+  const hid_t fileSpaceId = H5Dget_space(datasetId);
+  const hsize_t numValues = SelectSubvolume(fileSpaceId, dims, layout, subvolume);
+  const hid_t memSpaceId = H5Screate_simple(1, &numValues, nullptr);
+  const herr_t err = H5Dread(datasetId, GetH5NativeType<T>(), memSpaceId, fileSpaceId, H5P_DEFAULT, dataStore->data());
+  H5Sclose(memSpaceId);
+  H5Sclose(fileSpaceId);
+  return err < 0 ? nullptr : dataStore;
+}
+
+/**
+ * @brief Reads the subvolume of every cell array in the group into the DataStructure.
+ */
+bool ReadCellArrays(hid_t groupId, const std::string& groupPath, const Subvolume& subvolume, DataStructure& dataGraph, std::optional<DataObject::IdType> parentId, size_t& numArrays)
+{
+  for(const std::string& name : ListDatasets(groupId))
+  {
+    const hid_t datasetId = H5Dopen2(groupId, name.c_str(), H5P_DEFAULT);
+    if(datasetId < 0)
+    {
+      return false;
+    }
+    const hid_t typeId = H5Dget_type(datasetId);
+    const hid_t spaceId = H5Dget_space(datasetId);
+    const std::optional<DataType> dataType = GetDataTypeFromH5(typeId);
+    std::vector<hsize_t> dims(static_cast<size_t>(std::max(H5Sget_simple_extent_ndims(spaceId), 0)));
+    H5Sget_simple_extent_dims(spaceId, dims.data(), nullptr);
+    H5Sclose(spaceId);
+    H5Tclose(typeId);
+
+    const CellLayout layout = GetCellLayout(dims, subvolume.dims);
+    bool success = true;
+    if(dataType.has_value() && layout != CellLayout::None)
+    {
+      VisitNumericDataType(*dataType, [&](auto value) {
+        using T = decltype(value);
+        std::shared_ptr<DataStore<T>> dataStore = ReadCellSubvolume<T>(datasetId, dims, layout, subvolume);
+        success = (nullptr != dataStore) && (nullptr != DataArray<T>::Create(dataGraph, name, dataStore, parentId));
+      });
+      numArrays++;
+    }
+    H5Dclose(datasetId);
+    if(!success)
+    {
+      std::cout << "Could not read the subvolume of " << groupPath << "/" << name << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+} // namespace
+
+// -----------------------------------------------------------------------------
+std::shared_ptr<DataStructure> ReadImageGeomSubvolume(const std::filesystem::path& filePath, const DataPath& imageGeomPath, const ImageGeomBounds& bounds)
+{
+  const std::vector<std::string> pathParts = imageGeomPath.getPathVector();
+  if(pathParts.empty())
+  {
+    return nullptr;
+  }
+  std::lock_guard<std::recursive_mutex> lock(GetH5LibraryMutex());
+  const hid_t fileId = H5Fopen(filePath.string().c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+  if(fileId < 0)
+  {
+    std::cout << "Could not open " << filePath.string() << std::endl;
+    return nullptr;
+  }
+
+  // Open every group down to the geometry; the parents are mirrored in the new DataStructure
+  auto dataGraph = std::make_shared<DataStructure>();
+  std::vector<hid_t> groupIds = {H5Gopen2(fileId, "/", H5P_DEFAULT)};
+  std::optional<DataObject::IdType> parentId;
+  std::string groupPath;
+  bool success = true;
+  for(size_t i = 0; success && i < pathParts.size(); i++)
+  {
+    const hid_t groupId = (H5Lexists(groupIds.back(), pathParts[i].c_str(), H5P_DEFAULT) > 0) ? H5Gopen2(groupIds.back(), pathParts[i].c_str(), H5P_DEFAULT) : H5I_INVALID_HID;
+    success = (groupId >= 0);
+    if(!success)
+    {
+      std::cout << "'" << groupPath << "/" << pathParts[i] << "' is not a group in " << filePath.string() << std::endl;
+      break;
+    }
+    groupIds.push_back(groupId);
+    groupPath += "/" + pathParts[i];
+    if(i + 1 < pathParts.size())
+    {
+      DataGroup* dataGroup = DataGroup::Create(*dataGraph, pathParts[i], parentId);
+      success = (nullptr != dataGroup);
+      parentId = success ? std::optional<DataObject::IdType>(dataGroup->getId()) : std::nullopt;
+    }
+  }
+
+  Subvolume subvolume;
+  FloatVec3 spacing = {1.0f, 1.0f, 1.0f};
+  FloatVec3 origin = {0.0f, 0.0f, 0.0f};
+  if(success)
+  {
+    const hid_t geomGroupId = groupIds.back();
+    std::array<uint64, 3> dims = {0, 0, 0};
+    std::array<float32, 3> spacingValues = {1.0f, 1.0f, 1.0f};
+    std::array<float32, 3> originValues = {0.0f, 0.0f, 0.0f};
+    success = ReadVec3Attribute(geomGroupId, k_ImageGeomDimensionsAttribute.c_str(), H5T_NATIVE_UINT64, dims);
+    ReadVec3Attribute(geomGroupId, k_ImageGeomSpacingAttribute.c_str(), H5T_NATIVE_FLOAT, spacingValues);
+    ReadVec3Attribute(geomGroupId, k_ImageGeomOriginAttribute.c_str(), H5T_NATIVE_FLOAT, originValues);
+    for(size_t i = 0; success && i < 3; i++)
+    {
+      success = (bounds.min[i] <= bounds.max[i] && bounds.max[i] < dims[i]);
+      subvolume.dims[i] = dims[i];
+      subvolume.min[i] = bounds.min[i];
+      subvolume.extent[i] = bounds.max[i] - bounds.min[i] + 1;
+      spacing[i] = spacingValues[i];
+      origin[i] = originValues[i] + static_cast<float32>(bounds.min[i]) * spacingValues[i];
+    }
+    if(!success)
+    {
+      std::cout << "The bounds are outside of the ImageGeom " << groupPath << " (or it has no " << k_ImageGeomDimensionsAttribute.c_str() << ")" << std::endl;
+    }
+  }
+
+  size_t numArrays = 0;
+  if(success)
+  {
+    ImageGeom* imageGeom = ImageGeom::Create(*dataGraph, pathParts.back(), parentId);
+    success = (nullptr != imageGeom);
+    if(success)
+    {
+      imageGeom->setDimensions({subvolume.extent[0], subvolume.extent[1], subvolume.extent[2]});
+      imageGeom->setSpacing(spacing);
+      imageGeom->setOrigin(origin);
+      // Cell arrays live next to the geometry; the ones stored inside it go back inside it
+      const hid_t parentGroupId = groupIds[groupIds.size() - 2];
+      const std::string parentPath = groupPath.substr(0, groupPath.rfind('/'));
+      success = ReadCellArrays(parentGroupId, parentPath, subvolume, *dataGraph, parentId, numArrays) &&
+                ReadCellArrays(groupIds.back(), groupPath, subvolume, *dataGraph, imageGeom->getId(), numArrays);
+    }
+  }
+
+  for(auto iter = groupIds.rbegin(); iter != groupIds.rend(); ++iter)
+  {
+    H5Gclose(*iter);
+  }
+  H5Fclose(fileId);
+  if(!success)
+  {
+    return nullptr;
+  }
+  std::cout << "Read a " << subvolume.extent[0] << "x" << subvolume.extent[1] << "x" << subvolume.extent[2] << " subvolume of " << numArrays << " cell arrays from " << groupPath << std::endl;
+  return dataGraph;
+}
+} // namespace complex
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "complex/Common/StringLiteral.hpp"
+#include "complex/Common/Types.hpp"
+#include "complex/DataStructure/DataPath.hpp"
+#include "complex/DataStructure/DataStructure.hpp"
+
+#include <filesystem>
+#include <memory>
+
+namespace complex
+{
+/**
+ * @brief Attributes of an ImageGeom group, each holding three values in X, Y, Z order.
+ */
+constexpr StringLiteral k_ImageGeomDimensionsAttribute = "_DIMENSIONS";
+constexpr StringLiteral k_ImageGeomSpacingAttribute = "_SPACING";
+constexpr StringLiteral k_ImageGeomOriginAttribute = "_ORIGIN";
+
+/**
+ * @brief An inclusive box of voxel indices, in X, Y, Z order like ImageGeom dimensions.
+ */
+struct ImageGeomBounds
+{
+  SizeVec3 min = {0, 0, 0};
+  SizeVec3 max = {0, 0, 0};
+};
+
+/**
+ * @brief Reads a region of interest of an ImageGeom from an HDF5 file without reading the
+ * rest of the volume. Only the voxels inside the bounds are selected with hyperslabs, so
+ * the I/O is proportional to the size of the box, not of the file.
+ *
+ * The cell arrays are the numeric datasets next to the geometry or inside it whose shape
+ * starts with {Z, Y, X} or, flattened, with {Z*Y*X}; each keeps its layout and components.
+ * The new DataStructure mirrors the groups above the geometry. Its ImageGeom has the box's
+ * dimensions, the same spacing and an origin moved to the box's first voxel.
+ * @param filePath
+ * @param imageGeomPath Path of the ImageGeom inside the file
+ * @param bounds Must lie inside the geometry
+ * @return nullptr if the geometry is missing, the bounds are outside of it or a read fails.
+ */
+std::shared_ptr<DataStructure> ReadImageGeomSubvolume(const std::filesystem::path& filePath, const DataPath& imageGeomPath, const ImageGeomBounds& bounds);
+} // namespace complex
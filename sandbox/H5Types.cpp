@@ -0,0 +1,89 @@
+#include "H5Types.hpp"
+
+namespace complex
+{
+namespace
+{
+// -----------------------------------------------------------------------------
+herr_t WriteShapeAttribute(hid_t datasetId, const char* name, const std::vector<usize>& shape)
+{
+  if(H5Aexists(datasetId, name) > 0)
+  {
+    H5Adelete(datasetId, name);
+  }
+  const std::vector<uint64> values(shape.begin(), shape.end());
+  const hsize_t numValues = values.size();
+  const hid_t spaceId = H5Screate_simple(1, &numValues, nullptr);
+  const hid_t attributeId = H5Acreate2(datasetId, name, H5T_NATIVE_UINT64, spaceId, H5P_DEFAULT, H5P_DEFAULT);
+  herr_t error = -1;
+  if(attributeId >= 0)
+  {
+    error = H5Awrite(attributeId, H5T_NATIVE_UINT64, values.data());
+    H5Aclose(attributeId);
+  }
+  H5Sclose(spaceId);
+  return error;
+}
+} // namespace
+
+// -----------------------------------------------------------------------------
+std::recursive_mutex& GetH5LibraryMutex()
+{
+  static std::recursive_mutex s_Mutex;
+  return s_Mutex;
+}
+
+// -----------------------------------------------------------------------------
+std::optional<DataType> GetDataTypeFromH5(hid_t typeId)
+{
+  const size_t typeSize = H5Tget_size(typeId);
+  switch(H5Tget_class(typeId))
+  {
+  case H5T_INTEGER: {
+    const bool isSigned = (H5Tget_sign(typeId) == H5T_SGN_2);
+    switch(typeSize)
+    {
+    case 1:
+      return isSigned ? DataType::int8 : DataType::uint8;
+    case 2:
+      return isSigned ? DataType::int16 : DataType::uint16;
+    case 4:
+      return isSigned ? DataType::int32 : DataType::uint32;
+    case 8:
+      return isSigned ? DataType::int64 : DataType::uint64;
+    default:
+      return {};
+    }
+  }
+  case H5T_FLOAT:
+    if(typeSize == 4)
+    {
+      return DataType::float32;
+    }
+    if(typeSize == 8)
+    {
+      return DataType::float64;
+    }
+    return {};
+  default:
+    return {};
+  }
+}
+
+// -----------------------------------------------------------------------------
+herr_t WriteH5ShapeAttributes(hid_t parentId, const std::string& datasetName, const std::vector<usize>& tupleShape, const std::vector<usize>& componentShape)
+{
+  const hid_t datasetId = H5Dopen2(parentId, datasetName.c_str(), H5P_DEFAULT);
+  if(datasetId < 0)
+  {
+    return -1;
+  }
+  herr_t error = WriteShapeAttribute(datasetId, k_TupleShapeAttribute, tupleShape);
+  if(error >= 0)
+  {
+    error = WriteShapeAttribute(datasetId, k_ComponentShapeAttribute, componentShape);
+  }
+  H5Dclose(datasetId);
+  return error;
+}
+} // namespace complex
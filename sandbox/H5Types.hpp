@@ -0,0 +1,178 @@
+#pragma once
+
+#include "complex/Common/Types.hpp"
+
+#include <hdf5.h>
+
+#include <array>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace complex
+{
+/**
+ * @brief Returns the HDF5 memory type of T.
+ * @return A predefined type that must NOT be closed.
+ */
+template <typename T>
+hid_t GetH5NativeType()
+{
+  if constexpr(std::is_same_v<T, int8>)
+  {
+    return H5T_NATIVE_INT8;
+  }
+  else if constexpr(std::is_same_v<T, uint8>)
+  {
+    return H5T_NATIVE_UINT8;
+  }
+  else if constexpr(std::is_same_v<T, int16>)
+  {
+    return H5T_NATIVE_INT16;
+  }
+  else if constexpr(std::is_same_v<T, uint16>)
+  {
+    return H5T_NATIVE_UINT16;
+  }
+  else if constexpr(std::is_same_v<T, int32>)
+  {
+    return H5T_NATIVE_INT32;
+  }
+  else if constexpr(std::is_same_v<T, uint32>)
+  {
+    return H5T_NATIVE_UINT32;
+  }
+  else if constexpr(std::is_same_v<T, int64>)
+  {
+    return H5T_NATIVE_INT64;
+  }
+  else if constexpr(std::is_same_v<T, uint64>)
+  {
+    return H5T_NATIVE_UINT64;
+  }
+  else if constexpr(std::is_same_v<T, float32>)
+  {
+    return H5T_NATIVE_FLOAT;
+  }
+  else
+  {
+    static_assert(std::is_same_v<T, float64>, "GetH5NativeType: unsupported type");
+    return H5T_NATIVE_DOUBLE;
+  }
+}
+
+/**
+ * @brief Maps a dataset's file type onto the complex type it is read as.
+ * @param typeId
+ * @return Nothing for types other than integers and floats.
+ */
+std::optional<DataType> GetDataTypeFromH5(hid_t typeId);
+
+/**
+ * @brief Attributes complex's DataStore writes on an array's dataset. The dataset's dims are
+ * the tuple shape followed by the component shape, so these tell them apart on read-back.
+ */
+constexpr const char* k_TupleShapeAttribute = "TupleShape";
+constexpr const char* k_ComponentShapeAttribute = "ComponentShape";
+
+/**
+ * @brief Writes the TupleShape and ComponentShape attributes on an array's dataset, as
+ * complex's DataStore does. Stores that write their dataset some other way call this so the
+ * array keeps its shape when it is read back.
+ * @param parentId Group that holds the dataset
+ * @param datasetName
+ * @param tupleShape
+ * @param componentShape
+ * @return A negative value if the dataset can not be opened or an attribute can not be written.
+ */
+herr_t WriteH5ShapeAttributes(hid_t parentId, const std::string& datasetName, const std::vector<usize>& tupleShape, const std::vector<usize>& componentShape);
+
+/**
+ * @brief Reads an attribute that holds exactly three values, such as an ImageGeom's dimensions.
+ * @param objectId
+ * @param name
+ * @param memoryType HDF5 memory type of T
+ * @param values Left untouched unless the read succeeds
+ * @return false if the attribute is missing, does not hold three values or can not be read.
+ */
+template <typename T>
+bool ReadVec3Attribute(hid_t objectId, const char* name, hid_t memoryType, std::array<T, 3>& values)
+{
+  if(H5Aexists(objectId, name) <= 0)
+  {
+    return false;
+  }
+  const hid_t attributeId = H5Aopen(objectId, name, H5P_DEFAULT);
+  if(attributeId < 0)
+  {
+    return false;
+  }
+  const hid_t spaceId = H5Aget_space(attributeId);
+  std::array<T, 3> readValues = values;
+  const bool success = (H5Sget_simple_extent_npoints(spaceId) == 3) && H5Aread(attributeId, memoryType, readValues.data()) >= 0;
+  H5Sclose(spaceId);
+  H5Aclose(attributeId);
+  if(success)
+  {
+    values = readValues;
+  }
+  return success;
+}
+
+/**
+ * @brief The HDF5 library may not be built thread safe, so every sandbox reader and writer
+ * holds this mutex while it is inside HDF5. It is recursive because writing a DataStructure
+ * can load a lazy array, which reads from HDF5 on the same thread.
+ * @return
+ */
+std::recursive_mutex& GetH5LibraryMutex();
+
+/**
+ * @brief Calls func with a value of the C++ type that matches the numeric DataType,
+ * e.g. func(float32{}) for DataType::float32, so one generic lambda covers every type.
+ * @param dataType
+ * @param func
+ * @return false (and func is not called) for DataType::boolean.
+ */
+template <typename FuncT>
+bool VisitNumericDataType(DataType dataType, FuncT&& func)
+{
+  switch(dataType)
+  {
+  case DataType::int8:
+    func(int8{});
+    return true;
+  case DataType::uint8:
+    func(uint8{});
+    return true;
+  case DataType::int16:
+    func(int16{});
+    return true;
+  case DataType::uint16:
+    func(uint16{});
+    return true;
+  case DataType::int32:
+    func(int32{});
+    return true;
+  case DataType::uint32:
+    func(uint32{});
+    return true;
+  case DataType::int64:
+    func(int64{});
+    return true;
+  case DataType::uint64:
+    func(uint64{});
+    return true;
+  case DataType::float32:
+    func(float32{});
+    return true;
+  case DataType::float64:
+    func(float64{});
+    return true;
+  default:
+    return false;
+  }
+}
+} // namespace complex
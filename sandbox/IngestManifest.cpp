@@ -0,0 +1,170 @@
+#include "IngestManifest.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace fs = std::filesystem;
+
+namespace complex
+{
+namespace
+{
+constexpr const char* k_VersionKey = "version";
+constexpr const char* k_FilesKey = "files";
+constexpr const char* k_PathKey = "path";
+constexpr const char* k_SizeKey = "size";
+constexpr const char* k_ModifiedTimeKey = "mtime";
+constexpr const char* k_HashKey = "xxh64";
+constexpr const char* k_SidecarKey = "sidecar";
+constexpr const char* k_DatasetKey = "dataset";
+
+// Hashes are stored as hex strings since not every JSON reader handles 64 bit unsigned numbers
+std::string HashToString(uint64_t hash)
+{
+  std::ostringstream stream;
+  stream << std::hex << hash;
+  return stream.str();
+}
+
+uint64_t HashFromString(const std::string& hashString)
+{
+  return std::stoull(hashString, nullptr, 16);
+}
+} // namespace
+
+// -----------------------------------------------------------------------------
+std::optional<IngestManifest> IngestManifest::Load(const fs::path& filePath)
+{
+  std::ifstream inputFile(filePath);
+  if(!inputFile.is_open())
+  {
+    return {};
+  }
+
+  IngestManifest manifest;
+  try
+  {
+    nlohmann::json rootJson = nlohmann::json::parse(inputFile);
+    if(rootJson.at(k_VersionKey).get<int32_t>() != k_Version)
+    {
+      std::cout << "Ignoring manifest " << filePath.string() << " from another version" << std::endl;
+      return {};
+    }
+    for(const auto& fileJson : rootJson.at(k_FilesKey))
+    {
+      IngestManifestEntry entry;
+      entry.path = fileJson.at(k_PathKey).get<std::string>();
+      entry.size = fileJson.at(k_SizeKey).get<uint64_t>();
+      entry.modifiedTime = fileJson.at(k_ModifiedTimeKey).get<int64_t>();
+      if(const auto hashIter = fileJson.find(k_HashKey); hashIter != fileJson.end() && !hashIter->is_null())
+      {
+        entry.contentHash = HashFromString(hashIter->get<std::string>());
+      }
+      entry.sidecarSignature = fileJson.at(k_SidecarKey).get<std::string>();
+      entry.datasetPath = fileJson.at(k_DatasetKey).get<std::string>();
+      manifest.insert(std::move(entry));
+    }
+  } catch(const std::exception& exception)
+  {
+    std::cout << "Error parsing manifest " << filePath.string() << ": " << exception.what() << std::endl;
+    return {};
+  }
+  return manifest;
+}
+
+// -----------------------------------------------------------------------------
+int64_t IngestManifest::ModifiedTime(const fs::path& filePath)
+{
+  std::error_code errorCode;
+  fs::file_time_type modifiedTime = fs::last_write_time(filePath, errorCode);
+  if(errorCode)
+  {
+    return 0;
+  }
+  return static_cast<int64_t>(modifiedTime.time_since_epoch().count());
+}
+
+// -----------------------------------------------------------------------------
+std::string IngestManifest::FileSignature(const fs::path& filePath)
+{
+  std::error_code errorCode;
+  const uintmax_t fileSize = fs::file_size(filePath, errorCode);
+  if(errorCode)
+  {
+    return {};
+  }
+  return std::to_string(fileSize) + ":" + std::to_string(ModifiedTime(filePath));
+}
+
+// -----------------------------------------------------------------------------
+bool IngestManifest::save(const fs::path& filePath) const
+{
+  nlohmann::json filesJson = nlohmann::json::array();
+  for(const auto& [path, entry] : m_Entries)
+  {
+    nlohmann::json fileJson;
+    fileJson[k_PathKey] = entry.path;
+    fileJson[k_SizeKey] = entry.size;
+    fileJson[k_ModifiedTimeKey] = entry.modifiedTime;
+    if(entry.contentHash.has_value())
+    {
+      fileJson[k_HashKey] = HashToString(*entry.contentHash);
+    }
+    fileJson[k_SidecarKey] = entry.sidecarSignature;
+    fileJson[k_DatasetKey] = entry.datasetPath;
+    filesJson.push_back(std::move(fileJson));
+  }
+  nlohmann::json rootJson;
+  rootJson[k_VersionKey] = k_Version;
+  rootJson[k_FilesKey] = std::move(filesJson);
+
+  fs::path tempPath = filePath;
+  tempPath += ".tmp";
+  {
+    std::ofstream outputFile(tempPath, std::ios::out | std::ios::trunc);
+    outputFile << rootJson.dump(2);
+    if(!outputFile.good())
+    {
+      std::cout << "Error writing manifest " << tempPath.string() << std::endl;
+      return false;
+    }
+  }
+  std::error_code errorCode;
+  fs::rename(tempPath, filePath, errorCode);
+  if(errorCode)
+  {
+    std::cout << "Error writing manifest " << filePath.string() << ": " << errorCode.message() << std::endl;
+    return false;
+  }
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+const IngestManifestEntry* IngestManifest::find(const std::string& path) const
+{
+  auto iter = m_Entries.find(path);
+  return (iter != m_Entries.end()) ? &iter->second : nullptr;
+}
+
+// -----------------------------------------------------------------------------
+void IngestManifest::insert(IngestManifestEntry entry)
+{
+  std::string path = entry.path;
+  m_Entries[path] = std::move(entry);
+}
+
+// -----------------------------------------------------------------------------
+const std::map<std::string, IngestManifestEntry>& IngestManifest::getEntries() const
+{
+  return m_Entries;
+}
+
+// -----------------------------------------------------------------------------
+size_t IngestManifest::size() const
+{
+  return m_Entries.size();
+}
+} // namespace complex
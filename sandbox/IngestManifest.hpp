@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <string>
+
+namespace complex
+{
+/**
+ * @brief What was known about one ingested file when its dataset was last written.
+ */
+struct IngestManifestEntry
+{
+  std::string path;                    // Path of the file relative to the ingested directory
+  uint64_t size = 0;                   // Bytes on disk
+  int64_t modifiedTime = 0;            // std::filesystem::last_write_time() in file clock ticks
+  std::optional<uint64_t> contentHash; // ContentHasher digest of the bytes on disk. Only files that needed it were hashed
+  std::string sidecarSignature;        // Size and modified time of the file's RawSidecar, empty if it has none
+  std::string datasetPath;             // HDF5 path of the dataset the file was written to
+};
+
+/**
+ * @class IngestManifest
+ * @brief Remembers which files went into an HDF5 file so a later ingest of the same
+ * directory can tell which files are new, removed or changed and only rewrite those.
+ * It is stored as JSON next to the HDF5 file.
+ */
+class IngestManifest
+{
+public:
+  static inline constexpr int32_t k_Version = 1;
+
+  /**
+   * @brief Reads a manifest written by save().
+   * @param filePath
+   * @return Empty if the file does not exist, can not be parsed or is from another version.
+   */
+  static std::optional<IngestManifest> Load(const std::filesystem::path& filePath);
+
+  /**
+   * @brief Returns the modified time of the file in the units stored in IngestManifestEntry::modifiedTime.
+   * @param filePath
+   * @return Zero if the time can not be read.
+   */
+  static int64_t ModifiedTime(const std::filesystem::path& filePath);
+
+  /**
+   * @brief Returns a signature that changes whenever the file's size or modified time does.
+   * @param filePath
+   * @return Empty if the file does not exist.
+   */
+  static std::string FileSignature(const std::filesystem::path& filePath);
+
+  IngestManifest() = default;
+  ~IngestManifest() noexcept = default;
+
+  IngestManifest(const IngestManifest&) = default;
+  IngestManifest(IngestManifest&&) noexcept = default;
+  IngestManifest& operator=(const IngestManifest&) = default;
+  IngestManifest& operator=(IngestManifest&&) noexcept = default;
+
+  /**
+   * @brief Writes the manifest to a temporary file and renames it into place so an
+   * interrupted save never leaves a truncated manifest behind.
+   * @param filePath
+   * @return false on I/O error
+   */
+  bool save(const std::filesystem::path& filePath) const;
+
+  /**
+   * @brief Returns the entry for the path or nullptr.
+   * @param path
+   * @return
+   */
+  const IngestManifestEntry* find(const std::string& path) const;
+
+  /**
+   * @brief Adds the entry, replacing any entry with the same path.
+   * @param entry
+   */
+  void insert(IngestManifestEntry entry);
+
+  const std::map<std::string, IngestManifestEntry>& getEntries() const;
+
+  size_t size() const;
+
+private:
+  std::map<std::string, IngestManifestEntry> m_Entries;
+};
+} // namespace complex
@@ -0,0 +1,170 @@
+#pragma once
+
+#include "complex/DataStructure/IDataStore.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+namespace complex
+{
+/**
+ * @class LazyDataStore
+ * @brief An IDataStore that knows its shape and type up front but does not load its
+ * values until they are first accessed. Shape queries (all that preflight needs) never
+ * trigger the load, so arrays that a pipeline never touches cost no I/O at all.
+ *
+ * The loader runs exactly once, on whichever thread touches the values first. After
+ * that every call is forwarded to the loaded store.
+ */
+template <typename T>
+class LazyDataStore : public IDataStore<T>
+{
+public:
+  using value_type = T;
+  using reference = T&;
+  using const_reference = const T&;
+  using ShapeType = typename IDataStore<T>::ShapeType;
+  using LoaderType = std::function<std::shared_ptr<IDataStore<T>>()>;
+
+  /**
+   * @param tupleShape
+   * @param componentShape
+   * @param loader Creates the real store. Must return a store of the same shape; nullptr is treated as an I/O error.
+   */
+  LazyDataStore(ShapeType tupleShape, ShapeType componentShape, LoaderType loader)
+  : m_TupleShape(std::move(tupleShape))
+  , m_ComponentShape(std::move(componentShape))
+  , m_Loader(std::move(loader))
+  {
+    m_NumTuples = std::accumulate(m_TupleShape.begin(), m_TupleShape.end(), static_cast<size_t>(1), std::multiplies<>());
+    m_NumComponents = std::accumulate(m_ComponentShape.begin(), m_ComponentShape.end(), static_cast<size_t>(1), std::multiplies<>());
+  }
+
+  ~LazyDataStore() override = default;
+
+  LazyDataStore(const LazyDataStore&) = delete;
+  LazyDataStore(LazyDataStore&&) noexcept = delete;
+  LazyDataStore& operator=(const LazyDataStore&) = delete;
+  LazyDataStore& operator=(LazyDataStore&&) noexcept = delete;
+
+  usize getNumberOfTuples() const override
+  {
+    return m_NumTuples;
+  }
+
+  const ShapeType& getTupleShape() const override
+  {
+    return m_TupleShape;
+  }
+
+  usize getNumberOfComponents() const override
+  {
+    return m_NumComponents;
+  }
+
+  const ShapeType& getComponentShape() const override
+  {
+    return m_ComponentShape;
+  }
+
+  void reshapeTuples(const ShapeType& tupleShape) override
+  {
+    store().reshapeTuples(tupleShape);
+    m_TupleShape = tupleShape;
+    m_NumTuples = std::accumulate(m_TupleShape.begin(), m_TupleShape.end(), static_cast<size_t>(1), std::multiplies<>());
+  }
+
+  value_type getValue(usize index) const override
+  {
+    return store().getValue(index);
+  }
+
+  void setValue(usize index, value_type value) override
+  {
+    store().setValue(index, value);
+  }
+
+  const_reference at(usize index) const override
+  {
+    return store().at(index);
+  }
+
+  const_reference operator[](usize index) const override
+  {
+    return store()[index];
+  }
+
+  reference operator[](usize index) override
+  {
+    return store()[index];
+  }
+
+  DataType getDataType() const override
+  {
+    return GetDataType<T>();
+  }
+
+  /**
+   * @brief A copy of a store that has not been loaded yet is just another lazy store with the same loader.
+   * @return
+   */
+  std::unique_ptr<IDataStore<T>> deepCopy() const override
+  {
+    if(!isLoaded())
+    {
+      return std::make_unique<LazyDataStore>(m_TupleShape, m_ComponentShape, m_Loader);
+    }
+    return store().deepCopy();
+  }
+
+  H5::ErrorType writeHdf5(H5::DatasetWriter& datasetWriter) const override
+  {
+    return store().writeHdf5(datasetWriter);
+  }
+
+  /**
+   * @brief Returns true once the values have been loaded.
+   * @return
+   */
+  bool isLoaded() const
+  {
+    return m_Loaded.load(std::memory_order_acquire);
+  }
+
+  /**
+   * @brief Returns the real store, loading it if this is the first access.
+   * @return
+   */
+  IDataStore<T>& store() const
+  {
+    if(!m_Loaded.load(std::memory_order_acquire))
+    {
+      std::call_once(m_LoadFlag, [this]() {
+        m_Store = m_Loader();
+        if(nullptr == m_Store || m_Store->getSize() != this->getSize())
+        {
+          throw std::runtime_error("LazyDataStore could not load its values");
+        }
+        m_Loaded.store(true, std::memory_order_release);
+      });
+    }
+    return *m_Store;
+  }
+
+private:
+  ShapeType m_TupleShape;
+  ShapeType m_ComponentShape;
+  size_t m_NumTuples = 0;
+  size_t m_NumComponents = 0;
+  LoaderType m_Loader;
+  mutable std::once_flag m_LoadFlag;
+  mutable std::atomic<bool> m_Loaded = false;
+  mutable std::shared_ptr<IDataStore<T>> m_Store;
+};
+} // namespace complex
@@ -0,0 +1,155 @@
+#include "MappedFile.hpp"
+
+#include <iostream>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace complex
+{
+namespace
+{
+size_t GetAllocationGranularity()
+{
+#if defined(_WIN32)
+  SYSTEM_INFO sysInfo;
+  GetSystemInfo(&sysInfo);
+  return static_cast<size_t>(sysInfo.dwAllocationGranularity);
+#else
+  return static_cast<size_t>(sysconf(_SC_PAGE_SIZE));
+#endif
+}
+} // namespace
+
+// -----------------------------------------------------------------------------
+std::shared_ptr<MappedFile> MappedFile::Map(const fs::path& filePath, Access access, size_t offset, size_t length)
+{
+  std::shared_ptr<MappedFile> mappedFile = std::shared_ptr<MappedFile>(new MappedFile);
+  mappedFile->m_Access = access;
+  mappedFile->m_FilePath = filePath;
+  mappedFile->m_Size = length;
+
+  // Nothing to map. mmap() rejects zero length mappings so just hand back an empty region.
+  if(length == 0)
+  {
+    return mappedFile;
+  }
+
+  // The OS wants the mapping to start on a page (or allocation granularity) boundary.
+  const size_t granularity = GetAllocationGranularity();
+  const size_t alignedOffset = offset - (offset % granularity);
+  const size_t delta = offset - alignedOffset;
+  mappedFile->m_MapLength = length + delta;
+
+#if defined(_WIN32)
+  HANDLE fileHandle = CreateFileW(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if(fileHandle == INVALID_HANDLE_VALUE)
+  {
+    std::cout << "Could not open file for mapping:'" << filePath << "'" << std::endl;
+    return nullptr;
+  }
+  mappedFile->m_FileHandle = fileHandle;
+
+  const DWORD protection = (access == Access::ReadOnly) ? PAGE_READONLY : PAGE_WRITECOPY;
+  HANDLE mappingHandle = CreateFileMappingW(fileHandle, nullptr, protection, 0, 0, nullptr);
+  if(mappingHandle == nullptr)
+  {
+    std::cout << "Could not create file mapping:'" << filePath << "'" << std::endl;
+    return nullptr;
+  }
+  mappedFile->m_MappingHandle = mappingHandle;
+
+  const DWORD desiredAccess = (access == Access::ReadOnly) ? FILE_MAP_READ : FILE_MAP_COPY;
+  const uint64_t offset64 = alignedOffset;
+  void* mapBase = MapViewOfFile(mappingHandle, desiredAccess, static_cast<DWORD>(offset64 >> 32), static_cast<DWORD>(offset64 & 0xFFFFFFFF), mappedFile->m_MapLength);
+  if(mapBase == nullptr)
+  {
+    std::cout << "Could not map view of file:'" << filePath << "'" << std::endl;
+    return nullptr;
+  }
+#else
+  int fd = ::open(filePath.c_str(), O_RDONLY);
+  if(fd < 0)
+  {
+    std::cout << "Could not open file for mapping:'" << filePath << "'" << std::endl;
+    return nullptr;
+  }
+
+  // A private, writable mapping of a read-only descriptor is allowed and gives copy-on-write pages.
+  const int protection = (access == Access::ReadOnly) ? PROT_READ : (PROT_READ | PROT_WRITE);
+  const int flags = (access == Access::ReadOnly) ? MAP_SHARED : MAP_PRIVATE;
+  void* mapBase = ::mmap(nullptr, mappedFile->m_MapLength, protection, flags, fd, static_cast<off_t>(alignedOffset));
+  // The mapping keeps its own reference to the file so the descriptor can be closed right away.
+  ::close(fd);
+  if(mapBase == MAP_FAILED)
+  {
+    std::cout << "Could not map file:'" << filePath << "'" << std::endl;
+    return nullptr;
+  }
+  // The raw arrays are nearly always swept front to back.
+  ::madvise(mapBase, mappedFile->m_MapLength, MADV_SEQUENTIAL);
+#endif
+
+  mappedFile->m_MapBase = mapBase;
+  mappedFile->m_Data = reinterpret_cast<std::byte*>(mapBase) + delta;
+  return mappedFile;
+}
+
+// -----------------------------------------------------------------------------
+MappedFile::~MappedFile() noexcept
+{
+#if defined(_WIN32)
+  if(m_MapBase != nullptr)
+  {
+    UnmapViewOfFile(m_MapBase);
+  }
+  if(m_MappingHandle != nullptr)
+  {
+    CloseHandle(m_MappingHandle);
+  }
+  if(m_FileHandle != nullptr)
+  {
+    CloseHandle(m_FileHandle);
+  }
+#else
+  if(m_MapBase != nullptr)
+  {
+    ::munmap(m_MapBase, m_MapLength);
+  }
+#endif
+}
+
+// -----------------------------------------------------------------------------
+std::byte* MappedFile::data() const
+{
+  return m_Data;
+}
+
+// -----------------------------------------------------------------------------
+size_t MappedFile::size() const
+{
+  return m_Size;
+}
+
+// -----------------------------------------------------------------------------
+MappedFile::Access MappedFile::access() const
+{
+  return m_Access;
+}
+
+// -----------------------------------------------------------------------------
+const fs::path& MappedFile::filePath() const
+{
+  return m_FilePath;
+}
+} // namespace complex
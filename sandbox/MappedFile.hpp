@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+
+namespace complex
+{
+/**
+ * @class MappedFile
+ * @brief Maps a region of a file into the address space of the process. The mapping
+ * is released when the last owner of the MappedFile goes away so that several
+ * DataStores may share a single mapping.
+ */
+class MappedFile
+{
+public:
+  enum class Access : uint8_t
+  {
+    ReadOnly,   // Pages are shared with the page cache and every other process that maps the file. Writes are not allowed.
+    CopyOnWrite // Pages are shared until written. Written pages become private to this process and never reach the file.
+  };
+
+  /**
+   * @brief Maps 'length' bytes of the file starting at 'offset'. The offset does NOT
+   * need to be page aligned.
+   * @param filePath
+   * @param access
+   * @param offset
+   * @param length
+   * @return nullptr if the file could not be opened or mapped.
+   */
+  static std::shared_ptr<MappedFile> Map(const std::filesystem::path& filePath, Access access, size_t offset, size_t length);
+
+  ~MappedFile() noexcept;
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile(MappedFile&&) noexcept = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+  MappedFile& operator=(MappedFile&&) noexcept = delete;
+
+  /**
+   * @brief Returns a pointer to the first requested byte (NOT the page aligned start of the mapping).
+   * @return
+   */
+  std::byte* data() const;
+
+  /**
+   * @brief Returns the number of requested bytes.
+   * @return
+   */
+  size_t size() const;
+
+  Access access() const;
+
+  const std::filesystem::path& filePath() const;
+
+private:
+  MappedFile() = default;
+
+  void* m_MapBase = nullptr;
+  size_t m_MapLength = 0;
+  std::byte* m_Data = nullptr;
+  size_t m_Size = 0;
+  Access m_Access = Access::ReadOnly;
+  std::filesystem::path m_FilePath;
+#if defined(_WIN32)
+  void* m_FileHandle = nullptr;
+  void* m_MappingHandle = nullptr;
+#endif
+};
+} // namespace complex
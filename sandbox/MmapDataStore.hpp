@@ -0,0 +1,224 @@
+#pragma once
+
+#include "H5Types.hpp"
+#include "MappedFile.hpp"
+
+#include "complex/DataStructure/DataStore.hpp"
+#include "complex/DataStructure/IDataStore.hpp"
+
+#include <nonstd/span.hpp>
+
+#include <algorithm>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+namespace complex
+{
+/**
+ * @class MmapDataStore
+ * @brief An IDataStore whose values live in a memory mapped file instead of a heap
+ * allocation. Creating one costs no copy and the pages are shared with the page cache
+ * (and every other process that maps the same file).
+ *
+ * A ReadOnly store throws on any attempt to modify a value, including non-const
+ * operator[] and data(), so it only suits callers that never hand it to a filter.
+ * A CopyOnWrite store may be modified freely; the modified pages become private and
+ * the file on disk is never changed. Stores put in a DataStructure should be CopyOnWrite.
+ */
+template <typename T>
+class MmapDataStore : public IDataStore<T>
+{
+public:
+  using value_type = T;
+  using reference = T&;
+  using const_reference = const T&;
+  using ShapeType = typename IDataStore<T>::ShapeType;
+
+  /**
+   * @brief Maps the file and wraps it in a MmapDataStore. The file must hold at least
+   * (offset + numTuples * numComponents * sizeof(T)) bytes.
+   * @param filePath
+   * @param tupleShape
+   * @param componentShape
+   * @param access
+   * @param offset Byte offset of the first value in the file
+   * @return nullptr if the file is too small or could not be mapped.
+   */
+  static std::shared_ptr<MmapDataStore> Open(const std::filesystem::path& filePath, const ShapeType& tupleShape, const ShapeType& componentShape, MappedFile::Access access, size_t offset = 0)
+  {
+    const size_t numValues = std::accumulate(tupleShape.begin(), tupleShape.end(), static_cast<size_t>(1), std::multiplies<>()) *
+                             std::accumulate(componentShape.begin(), componentShape.end(), static_cast<size_t>(1), std::multiplies<>());
+    const size_t numBytes = numValues * sizeof(T);
+    std::error_code errorCode;
+    const auto fileSize = static_cast<size_t>(std::filesystem::file_size(filePath, errorCode));
+    if(errorCode || fileSize < offset + numBytes)
+    {
+      return nullptr;
+    }
+    std::shared_ptr<MappedFile> mappedFile = MappedFile::Map(filePath, access, offset, numBytes);
+    if(nullptr == mappedFile)
+    {
+      return nullptr;
+    }
+    return std::make_shared<MmapDataStore>(mappedFile, tupleShape, componentShape);
+  }
+
+  /**
+   * @brief Wraps an existing mapping. The mapping must hold at least
+   * numTuples * numComponents * sizeof(T) bytes.
+   * @param mappedFile
+   * @param tupleShape
+   * @param componentShape
+   */
+  MmapDataStore(std::shared_ptr<MappedFile> mappedFile, ShapeType tupleShape, ShapeType componentShape)
+  : m_MappedFile(std::move(mappedFile))
+  , m_TupleShape(std::move(tupleShape))
+  , m_ComponentShape(std::move(componentShape))
+  {
+    m_Data = reinterpret_cast<T*>(m_MappedFile->data());
+    m_NumTuples = std::accumulate(m_TupleShape.begin(), m_TupleShape.end(), static_cast<size_t>(1), std::multiplies<>());
+    m_NumComponents = std::accumulate(m_ComponentShape.begin(), m_ComponentShape.end(), static_cast<size_t>(1), std::multiplies<>());
+  }
+
+  ~MmapDataStore() override = default;
+
+  usize getNumberOfTuples() const override
+  {
+    return m_NumTuples;
+  }
+
+  const ShapeType& getTupleShape() const override
+  {
+    return m_TupleShape;
+  }
+
+  usize getNumberOfComponents() const override
+  {
+    return m_NumComponents;
+  }
+
+  const ShapeType& getComponentShape() const override
+  {
+    return m_ComponentShape;
+  }
+
+  /**
+   * @brief The mapping is a fixed size so only reshapes that keep the same number of tuples are allowed.
+   * @param tupleShape
+   */
+  void reshapeTuples(const ShapeType& tupleShape) override
+  {
+    const size_t numTuples = std::accumulate(tupleShape.begin(), tupleShape.end(), static_cast<size_t>(1), std::multiplies<>());
+    if(numTuples != m_NumTuples)
+    {
+      throw std::runtime_error("MmapDataStore can not be resized");
+    }
+    m_TupleShape = tupleShape;
+  }
+
+  value_type getValue(usize index) const override
+  {
+    return m_Data[index];
+  }
+
+  void setValue(usize index, value_type value) override
+  {
+    checkWritable();
+    m_Data[index] = value;
+  }
+
+  const_reference at(usize index) const override
+  {
+    if(index >= this->getSize())
+    {
+      throw std::runtime_error("MmapDataStore index out of range");
+    }
+    return m_Data[index];
+  }
+
+  const_reference operator[](usize index) const override
+  {
+    return m_Data[index];
+  }
+
+  reference operator[](usize index) override
+  {
+    checkWritable();
+    return m_Data[index];
+  }
+
+  DataType getDataType() const override
+  {
+    return GetDataType<T>();
+  }
+
+  /**
+   * @brief Returns an in-memory DataStore<T> holding a copy of the mapped values.
+   * @return
+   */
+  std::unique_ptr<IDataStore<T>> deepCopy() const override
+  {
+    auto copy = std::make_unique<DataStore<T>>(m_TupleShape, m_ComponentShape);
+    std::copy(m_Data, m_Data + this->getSize(), copy->data());
+    return copy;
+  }
+
+  H5::ErrorType writeHdf5(H5::DatasetWriter& datasetWriter) const override
+  {
+    H5::DatasetWriter::DimsType dims;
+    std::copy(m_TupleShape.begin(), m_TupleShape.end(), std::back_inserter(dims));
+    std::copy(m_ComponentShape.begin(), m_ComponentShape.end(), std::back_inserter(dims));
+    const H5::ErrorType error = datasetWriter.writeSpan(dims, nonstd::span<const T>(m_Data, this->getSize()));
+    if(error < 0)
+    {
+      return error;
+    }
+    return WriteH5ShapeAttributes(datasetWriter.getParentId(), datasetWriter.getName(), m_TupleShape, m_ComponentShape);
+  }
+
+  /**
+   * @brief Direct pointer to the mapped values. Writing through this pointer on a ReadOnly store is undefined.
+   * @return
+   */
+  const T* data() const
+  {
+    return m_Data;
+  }
+
+  T* data()
+  {
+    checkWritable();
+    return m_Data;
+  }
+
+  MappedFile::Access access() const
+  {
+    return m_MappedFile->access();
+  }
+
+  const std::shared_ptr<MappedFile>& getMappedFile() const
+  {
+    return m_MappedFile;
+  }
+
+private:
+  void checkWritable() const
+  {
+    if(m_MappedFile->access() == MappedFile::Access::ReadOnly)
+    {
+      throw std::runtime_error("Attempting to modify a read-only MmapDataStore");
+    }
+  }
+
+  std::shared_ptr<MappedFile> m_MappedFile;
+  T* m_Data = nullptr;
+  ShapeType m_TupleShape;
+  ShapeType m_ComponentShape;
+  size_t m_NumTuples = 0;
+  size_t m_NumComponents = 0;
+};
+} // namespace complex
@@ -0,0 +1,344 @@
+#include "ParallelPipelineExecutor.hpp"
+
+#include "DataStructureDelta.hpp"
+#include "DataStructureHash.hpp"
+
+#include "complex/Pipeline/PipelineFilter.hpp"
+
+#include <algorithm>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <set>
+
+namespace complex
+{
+namespace
+{
+struct NodeOutcome
+{
+  bool isolated = true; // False if the node could not run on a copy and has to run on the DataStructure itself
+  bool executed = false;
+  std::optional<DataStructureDelta> delta; // Empty if the node's changes could not be captured
+  std::vector<std::string> changedPaths;
+};
+
+std::set<std::string> ListDataPaths(const DataStructure& dataStructure)
+{
+  std::set<std::string> paths;
+  for(const auto& [id, dataObject] : dataStructure)
+  {
+    for(const DataPath& dataPath : dataStructure.getDataPathsForId(id))
+    {
+      paths.insert(DataPathToString(dataPath));
+    }
+  }
+  return paths;
+}
+
+bool Overlaps(const std::vector<std::string>& lhs, const std::vector<std::string>& rhs)
+{
+  for(const std::string& lhsPath : lhs)
+  {
+    for(const std::string& rhsPath : rhs)
+    {
+      if(IsAtOrBelow(lhsPath, rhsPath) || IsAtOrBelow(rhsPath, lhsPath))
+      {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+bool Touches(const PipelineNodeAccess& access, const std::vector<std::string>& paths)
+{
+  return access.barrier || Overlaps(access.reads, paths) || Overlaps(access.writes, paths);
+}
+
+/**
+ * @brief Returns the paths whose arrays are hashed to find what the node changed: everything
+ * for a barrier, otherwise its read and write set.
+ */
+std::optional<std::vector<std::string>> HashScope(const PipelineNodeAccess& access)
+{
+  if(access.barrier)
+  {
+    return {};
+  }
+  std::vector<std::string> paths = access.reads;
+  paths.insert(paths.end(), access.writes.begin(), access.writes.end());
+  return paths;
+}
+
+/**
+ * @brief Returns the paths that were created, removed or whose values changed.
+ */
+std::vector<std::string> ChangedPaths(const DataStructureInventory& before, const DataStructureInventory& after)
+{
+  std::vector<std::string> paths;
+  for(const auto& [path, entry] : after.objects)
+  {
+    auto previous = before.objects.find(path);
+    if(previous == before.objects.end() || entry.hash.empty() || previous->second.hash != entry.hash)
+    {
+      paths.push_back(path);
+    }
+  }
+  for(const auto& [path, entry] : before.objects)
+  {
+    if(after.objects.count(path) == 0)
+    {
+      paths.push_back(path);
+    }
+  }
+  return paths;
+}
+
+std::vector<std::string> DeltaPaths(const DataStructureDelta& delta)
+{
+  std::vector<std::string> paths;
+  for(const DataPath& groupPath : delta.groups)
+  {
+    paths.push_back(DataPathToString(groupPath));
+  }
+  for(const DataStructureDelta::Array& deltaArray : delta.arrays)
+  {
+    paths.push_back(DataPathToString(deltaArray.path));
+  }
+  return paths;
+}
+} // namespace
+
+// -----------------------------------------------------------------------------
+bool PipelineNodeAccess::conflictsWith(const PipelineNodeAccess& other) const
+{
+  if(barrier || other.barrier)
+  {
+    return true;
+  }
+  return Overlaps(writes, other.writes) || Overlaps(writes, other.reads) || Overlaps(reads, other.writes);
+}
+
+// -----------------------------------------------------------------------------
+ParallelPipelineExecutor::ParallelPipelineExecutor(ThreadPool& threadPool)
+: m_ThreadPool(threadPool)
+{
+}
+
+// -----------------------------------------------------------------------------
+void ParallelPipelineExecutor::setResultCache(FilterResultCache* resultCache)
+{
+  m_ResultCache = resultCache;
+}
+
+// -----------------------------------------------------------------------------
+void ParallelPipelineExecutor::setTracer(PipelineTracer* tracer)
+{
+  m_Tracer = tracer;
+}
+
+// -----------------------------------------------------------------------------
+void ParallelPipelineExecutor::setLiveness(PipelineLiveness* liveness)
+{
+  m_Liveness = liveness;
+}
+
+// -----------------------------------------------------------------------------
+size_t ParallelPipelineExecutor::getMaxConcurrency() const
+{
+  return m_MaxConcurrency;
+}
+
+// -----------------------------------------------------------------------------
+std::optional<std::vector<PipelineNodeAccess>> ParallelPipelineExecutor::FindNodeAccesses(Pipeline& pipeline, const DataStructure& dataStructure)
+{
+  std::vector<PipelineNodeAccess> accesses;
+  accesses.reserve(pipeline.size());
+  DataStructure preflightGraph = dataStructure;
+  for(size_t index = 0; index < pipeline.size(); index++)
+  {
+    AbstractPipelineNode* node = pipeline.at(index);
+    const std::set<std::string> before = ListDataPaths(preflightGraph);
+    if(!node->preflight(preflightGraph))
+    {
+      std::cout << "Filter " << index << " (" << node->getName() << ") failed preflight" << std::endl;
+      return {};
+    }
+
+    PipelineNodeAccess access;
+    const auto* filterNode = dynamic_cast<const PipelineFilter*>(node);
+    if(nullptr == filterNode)
+    {
+      access.barrier = true;
+      accesses.push_back(std::move(access));
+      continue;
+    }
+    for(const std::string& path : ListDataPaths(preflightGraph))
+    {
+      if(before.count(path) == 0)
+      {
+        access.writes.push_back(path);
+      }
+    }
+    for(std::string& path : GetDataPathArguments(filterNode->getArguments()))
+    {
+      (before.count(path) > 0 ? access.reads : access.writes).push_back(std::move(path));
+    }
+    accesses.push_back(std::move(access));
+  }
+  return accesses;
+}
+
+// -----------------------------------------------------------------------------
+std::vector<std::vector<size_t>> ParallelPipelineExecutor::BuildDependencies(const std::vector<PipelineNodeAccess>& accesses)
+{
+  std::vector<std::vector<size_t>> dependencies(accesses.size());
+  for(size_t index = 0; index < accesses.size(); index++)
+  {
+    for(size_t earlier = 0; earlier < index; earlier++)
+    {
+      if(accesses[index].conflictsWith(accesses[earlier]))
+      {
+        dependencies[index].push_back(earlier);
+      }
+    }
+  }
+  return dependencies;
+}
+
+// -----------------------------------------------------------------------------
+bool ParallelPipelineExecutor::executeNode(size_t index, AbstractPipelineNode& node, DataStructure& dataStructure)
+{
+  auto run = [this, &node, &dataStructure]() { return (nullptr != m_ResultCache) ? m_ResultCache->execute(node, dataStructure) : node.execute(dataStructure); };
+  return (nullptr != m_Tracer) ? m_Tracer->record(PipelineTracer::Phase::Execute, index, node, dataStructure, run) : run();
+}
+
+// -----------------------------------------------------------------------------
+bool ParallelPipelineExecutor::execute(Pipeline& pipeline, DataStructure& dataStructure)
+{
+  m_MaxConcurrency = 0;
+  std::optional<std::vector<PipelineNodeAccess>> accesses = FindNodeAccesses(pipeline, dataStructure);
+  if(!accesses.has_value())
+  {
+    return false;
+  }
+  const std::vector<std::vector<size_t>> dependencies = BuildDependencies(*accesses);
+  const size_t numNodes = accesses->size();
+
+  std::vector<std::future<NodeOutcome>> outcomes(numNodes);
+  std::vector<bool> started(numNodes, false);
+  std::vector<size_t> copiedAt(numNodes, 0); // Number of nodes applied when the node's copy was made
+  std::vector<std::vector<std::string>> changedPaths(numNodes);
+
+  // The copy shares the values of every array with the DataStructure. The arrays the node reads get their own values
+  // here, while nothing else runs on the DataStructure, and the rest are left alone by the node.
+  auto launch = [&](size_t index, size_t numApplied) {
+    const PipelineNodeAccess& access = (*accesses)[index];
+    auto copy = std::make_shared<DataStructure>(dataStructure);
+    const bool isolated = !access.barrier && CopyArrayValues(*copy, access.reads);
+    AbstractPipelineNode* node = pipeline.at(index);
+    started[index] = true;
+    copiedAt[index] = numApplied;
+    outcomes[index] = m_ThreadPool.submit([this, index, node, copy, isolated, hashScope = HashScope(access)]() -> NodeOutcome {
+      NodeOutcome outcome;
+      outcome.isolated = isolated;
+      if(!isolated)
+      {
+        return outcome;
+      }
+      DataStructureInventory before = TakeDataStructureInventory(*copy, false, hashScope);
+      outcome.executed = executeNode(index, *node, *copy);
+      if(outcome.executed)
+      {
+        outcome.delta = CaptureDataStructureDelta(before, *copy);
+        if(outcome.delta.has_value())
+        {
+          outcome.changedPaths = DeltaPaths(*outcome.delta);
+        }
+      }
+      return outcome;
+    });
+  };
+
+  bool success = true;
+  // 'next' is the node to apply to the DataStructure; every node before it has been applied
+  for(size_t next = 0; next < numNodes && success; next++)
+  {
+    std::vector<size_t> ready;
+    bool othersRunning = false;
+    for(size_t index = next; index < numNodes; index++)
+    {
+      othersRunning = othersRunning || (index > next && started[index]);
+      const bool dependenciesApplied = std::all_of(dependencies[index].begin(), dependencies[index].end(), [next](size_t dependency) { return dependency < next; });
+      if(!started[index] && dependenciesApplied)
+      {
+        ready.push_back(index);
+      }
+    }
+    // With nothing to overlap with, the next node runs on the DataStructure itself and needs no copy
+    const bool runInPlace = !started[next] && !othersRunning && ready.size() == 1;
+    if(!runInPlace)
+    {
+      for(size_t index : ready)
+      {
+        launch(index, next);
+      }
+    }
+    m_MaxConcurrency = std::max(m_MaxConcurrency, static_cast<size_t>(std::count(started.begin() + static_cast<std::ptrdiff_t>(next), started.end(), true)) + (runInPlace ? 1 : 0));
+
+    AbstractPipelineNode* node = pipeline.at(next);
+    bool rerun = runInPlace;
+    NodeOutcome outcome;
+    if(!runInPlace)
+    {
+      outcome = outcomes[next].get();
+      // A node applied after this one's copy was made changed something it touches (an in-place
+      // modification preflight could not predict), or its own changes could not be captured
+      for(size_t earlier = copiedAt[next]; earlier < next && !rerun; earlier++)
+      {
+        rerun = Touches((*accesses)[next], changedPaths[earlier]);
+      }
+      rerun = rerun || !outcome.isolated || (outcome.executed && !outcome.delta.has_value());
+    }
+
+    // Nodes that are running on copies check what this one changed, within its read and write set
+    if(rerun)
+    {
+      DataStructureInventory before;
+      if(othersRunning || !runInPlace)
+      {
+        before = TakeDataStructureInventory(dataStructure, false, HashScope((*accesses)[next]));
+      }
+      success = executeNode(next, *node, dataStructure);
+      if(success && (othersRunning || !runInPlace))
+      {
+        changedPaths[next] = ChangedPaths(before, TakeDataStructureInventory(dataStructure, false, before.hashScope));
+      }
+    }
+    else
+    {
+      success = outcome.executed && ApplyDataStructureDelta(*outcome.delta, dataStructure, false);
+      changedPaths[next] = std::move(outcome.changedPaths);
+    }
+    if(!success)
+    {
+      std::cout << "Filter " << next << " (" << node->getName() << ") failed" << std::endl;
+    }
+    else if(nullptr != m_Liveness)
+    {
+      m_Liveness->release(next, dataStructure);
+    }
+  }
+
+  // The nodes still running on copies use the pipeline's nodes; they must finish before it can go away
+  for(size_t index = 0; index < numNodes; index++)
+  {
+    if(outcomes[index].valid())
+    {
+      outcomes[index].wait();
+    }
+  }
+  return success;
+}
+} // namespace complex
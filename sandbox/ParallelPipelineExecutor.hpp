@@ -0,0 +1,122 @@
+#pragma once
+
+#include "FilterResultCache.hpp"
+#include "PipelineLiveness.hpp"
+#include "PipelineTrace.hpp"
+#include "ThreadPool.hpp"
+
+#include "complex/DataStructure/DataStructure.hpp"
+#include "complex/Pipeline/Pipeline.hpp"
+
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace complex
+{
+/**
+ * @brief The DataObjects a pipeline node touches, as "/a/b/c" paths.
+ */
+struct PipelineNodeAccess
+{
+  std::vector<std::string> reads;  // DataPath arguments that exist before the node runs
+  std::vector<std::string> writes; // Paths the node's preflight creates, and DataPath arguments that do not exist yet
+  bool barrier = false;            // The node is not a PipelineFilter, so what it touches is unknown
+
+  /**
+   * @brief Returns true if running the two nodes in either order could give different results.
+   * @param other
+   * @return
+   */
+  bool conflictsWith(const PipelineNodeAccess& other) const;
+};
+
+/**
+ * @class ParallelPipelineExecutor
+ * @brief Executes the nodes of a Pipeline concurrently when they touch disjoint DataPaths,
+ * with the same results as executing them one after another.
+ *
+ * The read and write sets come from each filter's DataPath arguments and from what its
+ * preflight creates; a node depends on every earlier node it conflicts with. A DataStructure
+ * is not safe to modify from several threads, so a node that runs alongside others executes
+ * on its own copy of the DataStructure and what it changed is applied to the real one in
+ * pipeline order.
+ *
+ * Copying a DataStructure copies its objects but not the arrays' values, which stay shared.
+ * The arrays in a node's read set get a copy of their values before it starts; it does not
+ * touch the others. Only the read and write set is hashed before and after the node runs to
+ * find what it changed. A node that modifies an existing array in place is only noticed once
+ * it ran; a later node that already started on a copy without that change is executed again.
+ * The next node in pipeline order with nothing else to overlap runs on the real DataStructure
+ * directly, so a pipeline without independent filters costs no copies.
+ */
+class ParallelPipelineExecutor
+{
+public:
+  explicit ParallelPipelineExecutor(ThreadPool& threadPool);
+  ~ParallelPipelineExecutor() noexcept = default;
+
+  ParallelPipelineExecutor(const ParallelPipelineExecutor&) = delete;
+  ParallelPipelineExecutor(ParallelPipelineExecutor&&) noexcept = delete;
+  ParallelPipelineExecutor& operator=(const ParallelPipelineExecutor&) = delete;
+  ParallelPipelineExecutor& operator=(ParallelPipelineExecutor&&) noexcept = delete;
+
+  /**
+   * @brief Preflights the pipeline on a copy of the DataStructure to find what each node
+   * touches and then executes it.
+   * @param pipeline
+   * @param dataStructure
+   * @return false if preflight or a node fails. The nodes before the failed one have been applied.
+   */
+  bool execute(Pipeline& pipeline, DataStructure& dataStructure);
+
+  /**
+   * @brief Nodes are executed through the cache. See PipelineCheckpointer::setResultCache().
+   * @param resultCache Not owned. nullptr executes every node.
+   */
+  void setResultCache(FilterResultCache* resultCache);
+
+  /**
+   * @brief Records every executed node, on whichever thread it runs. Re-executions are recorded too.
+   * @param tracer Not owned. nullptr records nothing.
+   */
+  void setTracer(PipelineTracer* tracer);
+
+  /**
+   * @brief Releases the arrays no later node reads once a node was applied to the DataStructure.
+   * Nodes still running on copies keep their copy's arrays until they finish.
+   * @param liveness Not owned and already analyzed for the pipeline. nullptr releases nothing.
+   */
+  void setLiveness(PipelineLiveness* liveness);
+
+  /**
+   * @brief Returns the largest number of nodes that ran at the same time during the last execute().
+   * @return
+   */
+  size_t getMaxConcurrency() const;
+
+  /**
+   * @brief Preflights each node on a copy of the DataStructure and records what it touches.
+   * @param pipeline
+   * @param dataStructure
+   * @return Empty if a node fails preflight.
+   */
+  static std::optional<std::vector<PipelineNodeAccess>> FindNodeAccesses(Pipeline& pipeline, const DataStructure& dataStructure);
+
+  /**
+   * @brief Returns, for each node, the earlier nodes it has to wait for.
+   * @param accesses
+   * @return
+   */
+  static std::vector<std::vector<size_t>> BuildDependencies(const std::vector<PipelineNodeAccess>& accesses);
+
+private:
+  bool executeNode(size_t index, AbstractPipelineNode& node, DataStructure& dataStructure);
+
+  ThreadPool& m_ThreadPool;
+  FilterResultCache* m_ResultCache = nullptr;
+  PipelineTracer* m_Tracer = nullptr;
+  PipelineLiveness* m_Liveness = nullptr;
+  size_t m_MaxConcurrency = 0;
+};
+} // namespace complex
@@ -0,0 +1,165 @@
+#include "PipelineBatchRunner.hpp"
+
+#include "ConversionKernels.hpp"
+
+#include "complex/DataStructure/IDataArray.hpp"
+#include "complex/Pipeline/PipelineFilter.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <future>
+#include <mutex>
+
+namespace complex
+{
+// -----------------------------------------------------------------------------
+PipelineBatchRunner::PipelineBatchRunner(ThreadPool& threadPool, BatchOptions options)
+: m_ThreadPool(threadPool)
+, m_Options(options)
+{
+  if(0 == m_Options.maxConcurrentDatasets)
+  {
+    m_Options.maxConcurrentDatasets = m_ThreadPool.size();
+  }
+}
+
+// -----------------------------------------------------------------------------
+size_t PipelineBatchRunner::getMaxConcurrency() const
+{
+  return m_MaxConcurrency;
+}
+
+// -----------------------------------------------------------------------------
+size_t PipelineBatchRunner::getPeakResidentBytes() const
+{
+  return m_PeakResidentBytes;
+}
+
+// -----------------------------------------------------------------------------
+bool PipelineBatchRunner::ExecutePipeline(const Pipeline& pipeline, DataStructure& dataStructure, std::string& message)
+{
+  for(const std::shared_ptr<AbstractPipelineNode>& node : pipeline)
+  {
+    if(const auto* nestedPipeline = dynamic_cast<const Pipeline*>(node.get()); nullptr != nestedPipeline)
+    {
+      if(!ExecutePipeline(*nestedPipeline, dataStructure, message))
+      {
+        return false;
+      }
+      continue;
+    }
+    const auto* filterNode = dynamic_cast<const PipelineFilter*>(node.get());
+    const IFilter* filter = (nullptr != filterNode) ? filterNode->getFilter() : nullptr;
+    if(nullptr == filter)
+    {
+      message = "The pipeline holds a node that is neither a filter nor a pipeline";
+      return false;
+    }
+    // IFilter::execute() preflights with the arguments itself before it executes
+    Result<> result = filter->execute(dataStructure, filterNode->getArguments());
+    if(result.invalid())
+    {
+      message = filter->humanName() + " failed:";
+      for(const Error& error : result.errors())
+      {
+        message += " " + error.message;
+      }
+      return false;
+    }
+  }
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+size_t PipelineBatchRunner::EstimateResidentBytes(const DataStructure& preflightedDataStructure)
+{
+  size_t numBytes = 0;
+  for(const auto& [id, dataObject] : preflightedDataStructure)
+  {
+    if(const auto* dataArray = dynamic_cast<const IDataArray*>(dataObject.get()); nullptr != dataArray)
+    {
+      numBytes += dataArray->getSize() * GetDataTypeSize(dataArray->getDataType());
+    }
+  }
+  return numBytes;
+}
+
+// -----------------------------------------------------------------------------
+BatchResult PipelineBatchRunner::process(const Pipeline& pipeline, const BatchDataset& dataset) const
+{
+  BatchResult result;
+  result.name = dataset.name;
+  const auto startTime = std::chrono::steady_clock::now();
+  // A dataset that throws fails alone; the others and the admission bookkeeping carry on
+  try
+  {
+    std::shared_ptr<DataStructure> dataStructure = dataset.load();
+    if(nullptr == dataStructure)
+    {
+      result.message = "Could not be loaded";
+    }
+    else if(ExecutePipeline(pipeline, *dataStructure, result.message))
+    {
+      result.succeeded = (nullptr == dataset.store) || dataset.store(*dataStructure);
+      if(!result.succeeded)
+      {
+        result.message = "Could not be stored";
+      }
+    }
+  } catch(const std::exception& exception)
+  {
+    result.succeeded = false;
+    result.message = exception.what();
+  }
+  result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+  return result;
+}
+
+// -----------------------------------------------------------------------------
+std::vector<BatchResult> PipelineBatchRunner::run(const Pipeline& pipeline, const std::vector<BatchDataset>& datasets)
+{
+  m_MaxConcurrency = 0;
+  m_PeakResidentBytes = 0;
+
+  std::mutex mutex;
+  std::condition_variable released;
+  size_t numAdmitted = 0;
+  size_t residentBytes = 0;
+
+  std::vector<std::future<BatchResult>> results;
+  results.reserve(datasets.size());
+  for(const BatchDataset& dataset : datasets)
+  {
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      released.wait(lock, [&]() {
+        return 0 == numAdmitted || (numAdmitted < m_Options.maxConcurrentDatasets && residentBytes + dataset.residentBytes <= m_Options.maxResidentBytes);
+      });
+      numAdmitted++;
+      residentBytes += dataset.residentBytes;
+      m_MaxConcurrency = std::max(m_MaxConcurrency, numAdmitted);
+      m_PeakResidentBytes = std::max(m_PeakResidentBytes, residentBytes);
+    }
+    results.push_back(m_ThreadPool.submit([this, &pipeline, &dataset, &mutex, &released, &numAdmitted, &residentBytes]() {
+      BatchResult result = process(pipeline, dataset);
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        numAdmitted--;
+        residentBytes -= dataset.residentBytes;
+      }
+      released.notify_all();
+      return result;
+    }));
+  }
+
+  std::vector<BatchResult> batchResults;
+  batchResults.reserve(results.size());
+  for(std::future<BatchResult>& result : results)
+  {
+    batchResults.push_back(result.get());
+  }
+  return batchResults;
+}
+} // namespace complex
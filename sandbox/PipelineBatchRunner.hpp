@@ -0,0 +1,121 @@
+#pragma once
+
+#include "ThreadPool.hpp"
+
+#include "complex/DataStructure/DataStructure.hpp"
+#include "complex/Pipeline/Pipeline.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace complex
+{
+/**
+ * @brief One independent input of a batch run.
+ */
+struct BatchDataset
+{
+  std::string name;
+  size_t residentBytes = 0;                               // Memory the dataset is expected to need while it is processed
+  std::function<std::shared_ptr<DataStructure>()> load;   // Builds the DataStructure; nullptr fails the dataset
+  std::function<bool(const DataStructure&)> store;        // Optional. Called with the result once the pipeline succeeded
+};
+
+struct BatchOptions
+{
+  size_t maxResidentBytes = 4ULL * 1024 * 1024 * 1024; // Sum of residentBytes of the datasets loaded at once
+  size_t maxConcurrentDatasets = 0;                    // Zero means one per thread of the pool
+};
+
+/**
+ * @brief What happened to one dataset of a batch run.
+ */
+struct BatchResult
+{
+  std::string name;
+  bool succeeded = false;
+  std::string message; // Why the dataset failed
+  double seconds = 0.0; // Load, execute and store
+};
+
+/**
+ * @class PipelineBatchRunner
+ * @brief Executes one Pipeline against many independent DataStructures concurrently, so the
+ * plugins are loaded and the pipeline is built once for the whole batch.
+ *
+ * The pipeline's nodes are shared by every dataset and are not modified: each filter is
+ * executed through its IFilter (which is const) with a copy of the node's arguments, so the
+ * warnings and errors a PipelineFilter keeps are not written from several threads.
+ *
+ * Datasets are admitted in order. One waits until fewer than maxConcurrentDatasets are
+ * loaded and its residentBytes fit under maxResidentBytes next to theirs; a dataset larger
+ * than the cap on its own still runs, but alone. Its DataStructure is released before the
+ * next dataset is admitted in its place.
+ */
+class PipelineBatchRunner
+{
+public:
+  /**
+   * @param threadPool Runs one task per dataset. load and store run on its workers, so they
+   * must not wait for tasks of the same pool, and anything they do in HDF5 must hold
+   * GetH5LibraryMutex() (WriteDataStructureHdf5() does).
+   * @param options
+   */
+  explicit PipelineBatchRunner(ThreadPool& threadPool, BatchOptions options = {});
+  ~PipelineBatchRunner() noexcept = default;
+
+  PipelineBatchRunner(const PipelineBatchRunner&) = delete;
+  PipelineBatchRunner(PipelineBatchRunner&&) noexcept = delete;
+  PipelineBatchRunner& operator=(const PipelineBatchRunner&) = delete;
+  PipelineBatchRunner& operator=(PipelineBatchRunner&&) noexcept = delete;
+
+  /**
+   * @brief Loads, executes and stores every dataset and waits for all of them.
+   * @param pipeline
+   * @param datasets
+   * @return One result per dataset, in the same order. A failed dataset does not stop the others.
+   */
+  std::vector<BatchResult> run(const Pipeline& pipeline, const std::vector<BatchDataset>& datasets);
+
+  /**
+   * @brief Returns the largest number of datasets that were loaded at the same time during the last run().
+   * @return
+   */
+  size_t getMaxConcurrency() const;
+
+  /**
+   * @brief Returns the largest sum of residentBytes that was admitted at the same time during the last run().
+   * @return
+   */
+  size_t getPeakResidentBytes() const;
+
+  /**
+   * @brief Executes every filter of the pipeline, and of the pipelines nested in it, on the
+   * DataStructure without modifying the pipeline.
+   * @param pipeline
+   * @param dataStructure
+   * @param message Set to the failed filter and its errors
+   * @return false at the first filter that fails.
+   */
+  static bool ExecutePipeline(const Pipeline& pipeline, DataStructure& dataStructure, std::string& message);
+
+  /**
+   * @brief Returns the size of the values of every array in a DataStructure the pipeline was
+   * preflighted on, i.e. what one dataset needs with every input loaded and every output created.
+   * @param preflightedDataStructure
+   * @return
+   */
+  static size_t EstimateResidentBytes(const DataStructure& preflightedDataStructure);
+
+private:
+  BatchResult process(const Pipeline& pipeline, const BatchDataset& dataset) const;
+
+  ThreadPool& m_ThreadPool;
+  BatchOptions m_Options;
+  size_t m_MaxConcurrency = 0;
+  size_t m_PeakResidentBytes = 0;
+};
+} // namespace complex
@@ -0,0 +1,463 @@
+#include "PipelineCheckpoint.hpp"
+
+#include "ContentHash.hpp"
+#include "DataStructureHash.hpp"
+#include "H5Types.hpp"
+
+#include "complex/DataStructure/DataArray.hpp"
+#include "complex/DataStructure/DataStore.hpp"
+#include "complex/DataStructure/IDataArray.hpp"
+#include "complex/Pipeline/PipelineFilter.hpp"
+#include "complex/Utilities/Parsing/HDF5/H5FileReader.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <hdf5.h>
+
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace complex
+{
+namespace
+{
+constexpr const char* k_CheckpointFileName = "checkpoint.h5";
+constexpr const char* k_ManifestFileName = "checkpoint.json";
+constexpr const char* k_VersionKey = "version";
+constexpr const char* k_CompleteKey = "complete";
+constexpr const char* k_FilterCountKey = "filters";
+constexpr const char* k_PipelineKey = "pipeline";
+constexpr const char* k_InputsKey = "inputs";
+constexpr const char* k_StructureKey = "structure";
+constexpr const char* k_ArraysKey = "arrays";
+
+/**
+ * @brief Array path -> hash of its values.
+ */
+std::map<std::string, std::string> GetArrayHashes(const DataStructureInventory& inventory)
+{
+  std::map<std::string, std::string> arrayHashes;
+  for(const auto& [path, entry] : inventory.objects)
+  {
+    if(nullptr != entry.array)
+    {
+      arrayHashes[path] = entry.hash;
+    }
+  }
+  return arrayHashes;
+}
+
+/**
+ * @brief Describes a filter (see FilterResultCache::DescribeFilter()) or the nodes of a nested pipeline.
+ * @return Empty for nodes that can not be described.
+ */
+std::optional<std::string> DescribeNode(const AbstractPipelineNode& node)
+{
+  if(const auto* filterNode = dynamic_cast<const PipelineFilter*>(&node); nullptr != filterNode)
+  {
+    return FilterResultCache::DescribeFilter(*filterNode);
+  }
+  const auto* nestedPipeline = dynamic_cast<const Pipeline*>(&node);
+  if(nullptr == nestedPipeline)
+  {
+    return {};
+  }
+  std::string description = "[";
+  for(const auto& childNode : *nestedPipeline)
+  {
+    std::optional<std::string> childDescription = DescribeNode(*childNode);
+    if(!childDescription.has_value())
+    {
+      return {};
+    }
+    description += *childDescription + "\n";
+  }
+  return description + "]";
+}
+
+template <typename T>
+bool OverwriteH5Dataset(hid_t fileId, const std::string& datasetPath, const IDataStore<T>& store)
+{
+  const hid_t datasetId = H5Dopen2(fileId, datasetPath.c_str(), H5P_DEFAULT);
+  if(datasetId < 0)
+  {
+    return false;
+  }
+  const hid_t spaceId = H5Dget_space(datasetId);
+  const hssize_t numValues = H5Sget_simple_extent_npoints(spaceId);
+  H5Sclose(spaceId);
+  herr_t err = -1;
+  if(numValues >= 0 && static_cast<size_t>(numValues) == store.getSize())
+  {
+    if(const auto* dataStore = dynamic_cast<const DataStore<T>*>(&store); nullptr != dataStore)
+    {
+      err = H5Dwrite(datasetId, GetH5NativeType<T>(), H5S_ALL, H5S_ALL, H5P_DEFAULT, dataStore->data());
+    }
+    else
+    {
+      std::vector<T> values(store.getSize());
+      for(size_t i = 0; i < values.size(); i++)
+      {
+        values[i] = store.getValue(i);
+      }
+      err = H5Dwrite(datasetId, GetH5NativeType<T>(), H5S_ALL, H5S_ALL, H5P_DEFAULT, values.data());
+    }
+  }
+  H5Dclose(datasetId);
+  return err >= 0;
+}
+
+bool OverwriteH5Dataset(hid_t fileId, const std::string& datasetPath, const IDataArray& dataArray)
+{
+  bool success = false;
+  VisitNumericDataType(dataArray.getDataType(), [&](auto value) {
+    using T = decltype(value);
+    const auto* typedArray = dynamic_cast<const DataArray<T>*>(&dataArray);
+    success = (nullptr != typedArray && nullptr != typedArray->getDataStore()) && OverwriteH5Dataset<T>(fileId, datasetPath, *typedArray->getDataStore());
+  });
+  return success;
+}
+} // namespace
+
+// -----------------------------------------------------------------------------
+bool CheckpointPolicy::shouldCheckpoint(size_t filterIndex) const
+{
+  return !directory.empty() && (afterFilters.empty() || afterFilters.count(filterIndex) > 0);
+}
+
+// -----------------------------------------------------------------------------
+PipelineCheckpointer::PipelineCheckpointer(CheckpointPolicy policy)
+: m_Policy(std::move(policy))
+{
+}
+
+// -----------------------------------------------------------------------------
+fs::path PipelineCheckpointer::checkpointPath() const
+{
+  return m_Policy.directory / k_CheckpointFileName;
+}
+
+// -----------------------------------------------------------------------------
+fs::path PipelineCheckpointer::manifestPath() const
+{
+  return m_Policy.directory / k_ManifestFileName;
+}
+
+// -----------------------------------------------------------------------------
+std::optional<PipelineCheckpointer::Manifest> PipelineCheckpointer::loadManifest() const
+{
+  std::ifstream inputFile(manifestPath());
+  if(!inputFile.is_open())
+  {
+    return {};
+  }
+  Manifest manifest;
+  try
+  {
+    nlohmann::json rootJson = nlohmann::json::parse(inputFile);
+    if(rootJson.at(k_VersionKey).get<int32_t>() != k_Version)
+    {
+      std::cout << "Ignoring checkpoint manifest " << manifestPath().string() << " from another version" << std::endl;
+      return {};
+    }
+    manifest.complete = rootJson.at(k_CompleteKey).get<bool>();
+    manifest.filterCount = rootJson.at(k_FilterCountKey).get<size_t>();
+    manifest.pipelineHash = rootJson.at(k_PipelineKey).get<std::string>();
+    manifest.inputHash = rootJson.at(k_InputsKey).get<std::string>();
+    manifest.structureHash = rootJson.at(k_StructureKey).get<std::string>();
+    manifest.arrayHashes = rootJson.at(k_ArraysKey).get<std::map<std::string, std::string>>();
+  } catch(const std::exception& exception)
+  {
+    std::cout << "Error parsing checkpoint manifest " << manifestPath().string() << ": " << exception.what() << std::endl;
+    return {};
+  }
+  return manifest;
+}
+
+// -----------------------------------------------------------------------------
+bool PipelineCheckpointer::saveManifest(const Manifest& manifest) const
+{
+  nlohmann::json rootJson;
+  rootJson[k_VersionKey] = k_Version;
+  rootJson[k_CompleteKey] = manifest.complete;
+  rootJson[k_FilterCountKey] = manifest.filterCount;
+  rootJson[k_PipelineKey] = manifest.pipelineHash;
+  rootJson[k_InputsKey] = manifest.inputHash;
+  rootJson[k_StructureKey] = manifest.structureHash;
+  rootJson[k_ArraysKey] = manifest.arrayHashes;
+
+  fs::path tempPath = manifestPath();
+  tempPath += ".tmp";
+  {
+    std::ofstream outputFile(tempPath, std::ios::out | std::ios::trunc);
+    outputFile << rootJson.dump(2);
+    if(!outputFile.good())
+    {
+      std::cout << "Error writing checkpoint manifest " << tempPath.string() << std::endl;
+      return false;
+    }
+  }
+  std::error_code errorCode;
+  fs::rename(tempPath, manifestPath(), errorCode);
+  if(errorCode)
+  {
+    std::cout << "Error writing checkpoint manifest " << manifestPath().string() << ": " << errorCode.message() << std::endl;
+    return false;
+  }
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+std::optional<size_t> PipelineCheckpointer::getCheckpointedFilterCount() const
+{
+  std::optional<Manifest> manifest = loadManifest();
+  if(!manifest.has_value() || !manifest->complete || !fs::exists(checkpointPath()))
+  {
+    return {};
+  }
+  return manifest->filterCount;
+}
+
+// -----------------------------------------------------------------------------
+void PipelineCheckpointer::setResultCache(FilterResultCache* resultCache)
+{
+  m_ResultCache = resultCache;
+}
+
+// -----------------------------------------------------------------------------
+void PipelineCheckpointer::setTracer(PipelineTracer* tracer)
+{
+  m_Tracer = tracer;
+}
+
+// -----------------------------------------------------------------------------
+void PipelineCheckpointer::setLiveness(PipelineLiveness* liveness)
+{
+  m_Liveness = liveness;
+}
+
+// -----------------------------------------------------------------------------
+void PipelineCheckpointer::takeFingerprint(const Pipeline& pipeline, const DataStructure& dataStructure)
+{
+  // Deferred arrays are loaded; an unloaded one only says its shape, not what it holds
+  const DataStructureInventory inventory = TakeDataStructureInventory(dataStructure, true);
+  ContentHasher inputHasher;
+  inputHasher.update(inventory.structureHash.data(), inventory.structureHash.size() + 1);
+  for(const auto& [path, entry] : inventory.objects)
+  {
+    const std::string input = path + "=" + entry.hash;
+    inputHasher.update(input.data(), input.size() + 1);
+  }
+  m_InputHash = HashToString(inputHasher.digest());
+
+  ContentHasher pipelineHasher;
+  bool describable = true;
+  m_PipelineHashes.assign(1, HashToString(pipelineHasher.digest()));
+  for(const auto& node : pipeline)
+  {
+    std::optional<std::string> description = DescribeNode(*node);
+    describable = describable && description.has_value();
+    if(describable)
+    {
+      pipelineHasher.update(description->data(), description->size() + 1);
+    }
+    m_PipelineHashes.push_back(describable ? HashToString(pipelineHasher.digest()) : std::string());
+  }
+}
+
+// -----------------------------------------------------------------------------
+bool PipelineCheckpointer::execute(Pipeline& pipeline, DataStructure& dataStructure)
+{
+  // Without checkpoints there is nothing to fingerprint the inputs for
+  if(m_Policy.directory.empty())
+  {
+    return executeFrom(0, pipeline, dataStructure);
+  }
+  takeFingerprint(pipeline, dataStructure);
+  return restart(pipeline, dataStructure);
+}
+
+// -----------------------------------------------------------------------------
+bool PipelineCheckpointer::restart(Pipeline& pipeline, DataStructure& dataStructure)
+{
+  std::error_code errorCode;
+  fs::create_directories(m_Policy.directory, errorCode);
+  fs::remove(manifestPath(), errorCode);
+  fs::remove(checkpointPath(), errorCode);
+  return executeFrom(0, pipeline, dataStructure);
+}
+
+// -----------------------------------------------------------------------------
+bool PipelineCheckpointer::resume(Pipeline& pipeline, DataStructure& dataStructure)
+{
+  if(m_Policy.directory.empty())
+  {
+    return execute(pipeline, dataStructure);
+  }
+  takeFingerprint(pipeline, dataStructure);
+  std::optional<Manifest> manifest = loadManifest();
+  if(!manifest.has_value() || !manifest->complete || !fs::exists(checkpointPath()) || manifest->filterCount > pipeline.size())
+  {
+    std::cout << "No usable checkpoint in " << m_Policy.directory.string() << "; executing the whole pipeline" << std::endl;
+    return restart(pipeline, dataStructure);
+  }
+  const size_t filterCount = manifest->filterCount;
+  if(manifest->pipelineHash.empty() || manifest->pipelineHash != m_PipelineHashes[filterCount])
+  {
+    std::cout << "The filters before checkpoint " << checkpointPath().string() << " or their arguments changed; executing the whole pipeline" << std::endl;
+    return restart(pipeline, dataStructure);
+  }
+  if(manifest->inputHash != m_InputHash)
+  {
+    std::cout << "Checkpoint " << checkpointPath().string() << " was written for other inputs; executing the whole pipeline" << std::endl;
+    return restart(pipeline, dataStructure);
+  }
+
+  // Read aside so the inputs are still there if the checkpoint can not be read
+  H5::ErrorType err = 0;
+  std::optional<DataStructure> checkpoint;
+  {
+    std::lock_guard<std::recursive_mutex> lock(GetH5LibraryMutex());
+    H5::FileReader fileReader(checkpointPath());
+    checkpoint = DataStructure::readFromHdf5(fileReader, err);
+  }
+  if(err < 0)
+  {
+    std::cout << "Could not read checkpoint " << checkpointPath().string() << "; executing the whole pipeline" << std::endl;
+    return restart(pipeline, dataStructure);
+  }
+  dataStructure = std::move(*checkpoint);
+  std::cout << "Resuming after filter " << filterCount << " of " << pipeline.size() << " from " << checkpointPath().string() << std::endl;
+  return executeFrom(filterCount, pipeline, dataStructure);
+}
+
+// -----------------------------------------------------------------------------
+bool PipelineCheckpointer::executeFrom(size_t startIndex, Pipeline& pipeline, DataStructure& dataStructure)
+{
+  for(size_t index = 0; index < startIndex && nullptr != m_Liveness; index++)
+  {
+    m_Liveness->release(index, dataStructure);
+  }
+  for(size_t index = startIndex; index < pipeline.size(); index++)
+  {
+    AbstractPipelineNode* node = pipeline.at(index);
+    // A filter whose input dies with it may overwrite that input; the node gets its own arguments back afterwards
+    auto* filterNode = dynamic_cast<PipelineFilter*>(node);
+    std::optional<Arguments> inPlaceArguments = (nullptr != m_Liveness && nullptr != filterNode) ? m_Liveness->getInPlaceArguments(index, *filterNode) : std::nullopt;
+    const Arguments nodeArguments = inPlaceArguments.has_value() ? filterNode->getArguments() : Arguments();
+    if(inPlaceArguments.has_value())
+    {
+      filterNode->setArguments(*inPlaceArguments);
+    }
+    auto run = [this, node, &dataStructure]() { return (nullptr != m_ResultCache) ? m_ResultCache->execute(*node, dataStructure) : node->execute(dataStructure); };
+    const bool executed = (nullptr != m_Tracer) ? m_Tracer->record(PipelineTracer::Phase::Execute, index, *node, dataStructure, run) : run();
+    if(inPlaceArguments.has_value())
+    {
+      filterNode->setArguments(nodeArguments);
+    }
+    if(!executed)
+    {
+      std::cout << "Filter " << index << " (" << node->getName() << ") failed";
+      if(std::optional<size_t> filterCount = getCheckpointedFilterCount(); filterCount.has_value())
+      {
+        std::cout << "; resume() continues after filter " << *filterCount;
+      }
+      std::cout << std::endl;
+      return false;
+    }
+    // A failed checkpoint costs resumability but not the results, so keep going
+    if(m_Policy.shouldCheckpoint(index) && !writeCheckpoint(index + 1, dataStructure))
+    {
+      std::cout << "Could not checkpoint after filter " << index << " (" << node->getName() << ")" << std::endl;
+    }
+    if(nullptr != m_Liveness)
+    {
+      m_Liveness->release(index, dataStructure);
+    }
+  }
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+bool PipelineCheckpointer::writeCheckpoint(size_t filterCount, const DataStructure& dataStructure)
+{
+  std::optional<Manifest> previous = loadManifest();
+  const bool canUpdate = m_Policy.incremental && previous.has_value() && previous->complete && fs::exists(checkpointPath());
+
+  Manifest manifest;
+  manifest.filterCount = filterCount;
+  manifest.pipelineHash = (filterCount < m_PipelineHashes.size()) ? m_PipelineHashes[filterCount] : std::string();
+  manifest.inputHash = m_InputHash;
+
+  if(canUpdate)
+  {
+    DataStructureInventory inventory = TakeDataStructureInventory(dataStructure);
+    if(inventory.structureHash == previous->structureHash)
+    {
+      // Mark the checkpoint unusable until every changed dataset is rewritten
+      previous->complete = false;
+      if(!saveManifest(*previous))
+      {
+        return false;
+      }
+      std::lock_guard<std::recursive_mutex> lock(GetH5LibraryMutex());
+      const hid_t fileId = H5Fopen(checkpointPath().string().c_str(), H5F_ACC_RDWR, H5P_DEFAULT);
+      bool success = (fileId >= 0);
+      size_t numChanged = 0;
+      for(const auto& [path, entry] : inventory.objects)
+      {
+        auto previousHash = previous->arrayHashes.find(path);
+        if(!success || nullptr == entry.array || (!entry.hash.empty() && previousHash != previous->arrayHashes.end() && previousHash->second == entry.hash))
+        {
+          continue;
+        }
+        success = OverwriteH5Dataset(fileId, path, *entry.array);
+        numChanged++;
+      }
+      if(fileId >= 0)
+      {
+        success = (H5Fclose(fileId) >= 0) && success;
+      }
+      if(success)
+      {
+        manifest.complete = true;
+        manifest.structureHash = std::move(inventory.structureHash);
+        manifest.arrayHashes = GetArrayHashes(inventory);
+        std::cout << "Checkpoint after filter " << filterCount << ": rewrote " << numChanged << " changed arrays" << std::endl;
+        return saveManifest(manifest);
+      }
+      std::cout << "Could not update checkpoint " << checkpointPath().string() << " in place; rewriting it" << std::endl;
+    }
+  }
+
+  // Full checkpoint. Until the new file is renamed into place and the manifest says so, neither file is resumed from.
+  if(previous.has_value() && previous->complete)
+  {
+    previous->complete = false;
+    saveManifest(*previous);
+  }
+  fs::path tempPath = checkpointPath();
+  tempPath += ".tmp";
+  if(!WriteDataStructureHdf5(dataStructure, tempPath, m_Policy.writeOptions))
+  {
+    return false;
+  }
+  std::error_code errorCode;
+  fs::rename(tempPath, checkpointPath(), errorCode);
+  if(errorCode)
+  {
+    std::cout << "Could not move checkpoint into place: " << errorCode.message() << std::endl;
+    return false;
+  }
+  // Hashed after writing since the write loads deferred arrays and the next update should see them as loaded
+  DataStructureInventory inventory = TakeDataStructureInventory(dataStructure);
+  manifest.complete = true;
+  manifest.structureHash = std::move(inventory.structureHash);
+  manifest.arrayHashes = GetArrayHashes(inventory);
+  std::cout << "Checkpoint after filter " << filterCount << ": wrote " << checkpointPath().string() << std::endl;
+  return saveManifest(manifest);
+}
+} // namespace complex
@@ -0,0 +1,140 @@
+#pragma once
+
+#include "FilterResultCache.hpp"
+#include "H5DataStructureWriter.hpp"
+#include "PipelineLiveness.hpp"
+#include "PipelineTrace.hpp"
+
+#include "complex/DataStructure/DataStructure.hpp"
+#include "complex/Pipeline/Pipeline.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace complex
+{
+/**
+ * @brief When and how PipelineCheckpointer saves the DataStructure.
+ */
+struct CheckpointPolicy
+{
+  std::filesystem::path directory;  // Holds checkpoint.h5 and its checkpoint.json manifest; empty writes no checkpoints
+  std::set<size_t> afterFilters;    // Pipeline indices to checkpoint after; empty means after every filter
+  bool incremental = true;          // Rewrite only the arrays that changed when the hierarchy is the same as at the last checkpoint
+  H5WriteOptions writeOptions;      // Layout of full checkpoints
+
+  /**
+   * @brief Returns true if a checkpoint is due once the filter at this index has executed.
+   * @param filterIndex
+   * @return
+   */
+  bool shouldCheckpoint(size_t filterIndex) const;
+};
+
+/**
+ * @class PipelineCheckpointer
+ * @brief Executes a Pipeline one filter at a time, saving the DataStructure after the
+ * filters selected by the CheckpointPolicy, so a failed or killed run can be resumed from
+ * the last checkpoint instead of from the beginning.
+ *
+ * There is a single checkpoint file. A full checkpoint is written to a temporary file and
+ * renamed into place; an incremental one overwrites the datasets of the changed arrays
+ * (found by hashing their values) in that file. The manifest is marked incomplete while
+ * the file is being changed, so a checkpoint interrupted half way is never resumed from.
+ *
+ * The manifest also records a hash of the filters the checkpoint covers (see
+ * FilterResultCache::DescribeFilter()) and of the DataStructure the run started from, every
+ * array's values included. resume() only uses a checkpoint when both still match.
+ */
+class PipelineCheckpointer
+{
+public:
+  static inline constexpr int32_t k_Version = 2;
+
+  explicit PipelineCheckpointer(CheckpointPolicy policy);
+  ~PipelineCheckpointer() noexcept = default;
+
+  PipelineCheckpointer(const PipelineCheckpointer&) = delete;
+  PipelineCheckpointer(PipelineCheckpointer&&) noexcept = delete;
+  PipelineCheckpointer& operator=(const PipelineCheckpointer&) = delete;
+  PipelineCheckpointer& operator=(PipelineCheckpointer&&) noexcept = delete;
+
+  /**
+   * @brief Executes every filter, starting over: checkpoints of an earlier run are discarded.
+   * @param pipeline
+   * @param dataStructure
+   * @return false if a filter fails. The checkpoints written up to then are kept for resume().
+   */
+  bool execute(Pipeline& pipeline, DataStructure& dataStructure);
+
+  /**
+   * @brief Replaces the DataStructure with the last complete checkpoint and executes the
+   * filters after it. Without a usable checkpoint this is the same as execute(). A checkpoint
+   * is not used if the filters it covers or their arguments changed, or if the DataStructure
+   * is not the one the checkpointed run started from; its values are hashed to tell.
+   * @param pipeline
+   * @param dataStructure The pipeline's inputs, as they would be passed to execute()
+   * @return
+   */
+  bool resume(Pipeline& pipeline, DataStructure& dataStructure);
+
+  /**
+   * @brief Returns the number of filters the last complete checkpoint covers.
+   * @return Empty if there is no usable checkpoint.
+   */
+  std::optional<size_t> getCheckpointedFilterCount() const;
+
+  /**
+   * @brief Filters are executed through the cache, so filters whose results it holds are not executed again.
+   * @param resultCache Not owned; must outlive the executions. nullptr executes every filter.
+   */
+  void setResultCache(FilterResultCache* resultCache);
+
+  /**
+   * @brief Records every executed filter (see PipelineTracer). Checkpoint writes are not part of the filters' events.
+   * @param tracer Not owned. nullptr records nothing.
+   */
+  void setTracer(PipelineTracer* tracer);
+
+  /**
+   * @brief Releases the arrays no later node reads once a node executed and its checkpoint, if
+   * any, was written. A resumed run releases the ones that died before the checkpoint first.
+   * Filters that support it execute in place when their input dies with them.
+   * @param liveness Not owned and already analyzed for the pipeline. nullptr releases nothing.
+   */
+  void setLiveness(PipelineLiveness* liveness);
+
+private:
+  struct Manifest
+  {
+    bool complete = false;
+    size_t filterCount = 0;
+    std::string pipelineHash; // Covers the first filterCount nodes; empty if one of them can not be described
+    std::string inputHash;    // The DataStructure the run started from
+    std::string structureHash;
+    std::map<std::string, std::string> arrayHashes; // Array path -> hash of its values
+  };
+
+  std::filesystem::path checkpointPath() const;
+  std::filesystem::path manifestPath() const;
+  std::optional<Manifest> loadManifest() const;
+  bool saveManifest(const Manifest& manifest) const;
+
+  void takeFingerprint(const Pipeline& pipeline, const DataStructure& dataStructure);
+  bool restart(Pipeline& pipeline, DataStructure& dataStructure);
+  bool executeFrom(size_t startIndex, Pipeline& pipeline, DataStructure& dataStructure);
+  bool writeCheckpoint(size_t filterCount, const DataStructure& dataStructure);
+
+  CheckpointPolicy m_Policy;
+  FilterResultCache* m_ResultCache = nullptr;
+  PipelineTracer* m_Tracer = nullptr;
+  PipelineLiveness* m_Liveness = nullptr;
+  std::string m_InputHash;
+  std::vector<std::string> m_PipelineHashes; // [i] covers the first i nodes
+};
+} // namespace complex
@@ -0,0 +1,210 @@
+#include "PipelineLiveness.hpp"
+
+#include "DataStructureDelta.hpp"
+#include "DataStructureHash.hpp"
+#include "H5Types.hpp"
+#include "LazyDataStore.hpp"
+#include "ParallelPipelineExecutor.hpp"
+#include "RawFileReader.hpp"
+
+#include "complex/DataStructure/DataArray.hpp"
+#include "complex/DataStructure/IDataArray.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <map>
+
+namespace fs = std::filesystem;
+
+namespace complex
+{
+namespace
+{
+bool Uses(const PipelineNodeAccess& access, const std::string& path)
+{
+  auto overlaps = [&path](const std::string& accessPath) { return IsAtOrBelow(path, accessPath) || IsAtOrBelow(accessPath, path); };
+  return access.barrier || std::any_of(access.reads.begin(), access.reads.end(), overlaps) || std::any_of(access.writes.begin(), access.writes.end(), overlaps);
+}
+
+std::optional<DataObject::IdType> FindId(const DataStructure& dataStructure, const std::string& path)
+{
+  for(const auto& [id, dataObject] : dataStructure)
+  {
+    for(const DataPath& dataPath : dataStructure.getDataPathsForId(id))
+    {
+      if(DataPathToString(dataPath) == path)
+      {
+        return id;
+      }
+    }
+  }
+  return {};
+}
+} // namespace
+
+// -----------------------------------------------------------------------------
+PipelineLiveness::PipelineLiveness(LivenessPolicy policy)
+: m_Policy(std::move(policy))
+{
+}
+
+// -----------------------------------------------------------------------------
+bool PipelineLiveness::analyze(Pipeline& pipeline, const DataStructure& dataStructure)
+{
+  m_ReleasePaths.clear();
+  m_InPlaceInputs.clear();
+  m_ReleasedArrayCount = 0;
+  m_ReleasedBytes = 0;
+  std::optional<std::vector<PipelineNodeAccess>> accesses = ParallelPipelineExecutor::FindNodeAccesses(pipeline, dataStructure);
+  if(!accesses.has_value())
+  {
+    return false;
+  }
+
+  std::vector<std::string> outputs;
+  for(const DataPath& output : m_Policy.outputs)
+  {
+    outputs.push_back(DataPathToString(output));
+  }
+
+  // The first node that writes a path that did not exist before the pipeline creates it
+  std::map<std::string, size_t> lastUses;
+  for(size_t index = 0; index < accesses->size(); index++)
+  {
+    for(const std::string& path : (*accesses)[index].writes)
+    {
+      if(std::none_of(outputs.begin(), outputs.end(), [&path](const std::string& output) { return IsAtOrBelow(path, output); }))
+      {
+        lastUses.emplace(path, index);
+      }
+    }
+  }
+  const std::map<std::string, size_t> createdBy = lastUses;
+  for(auto& [path, lastUse] : lastUses)
+  {
+    for(size_t index = lastUse + 1; index < accesses->size(); index++)
+    {
+      if(Uses((*accesses)[index], path))
+      {
+        lastUse = index;
+      }
+    }
+  }
+
+  // Without outputs, what no later node reads is taken to be the pipeline's result and kept
+  m_ReleasePaths.resize(accesses->size());
+  for(const auto& [path, lastUse] : lastUses)
+  {
+    if(!m_Policy.outputs.empty() || lastUse != createdBy.at(path))
+    {
+      m_ReleasePaths[lastUse].push_back(path);
+    }
+  }
+  if(m_Policy.mode == ArrayReleaseMode::Spill)
+  {
+    std::error_code errorCode;
+    fs::create_directories(m_Policy.spillDirectory, errorCode);
+  }
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+size_t PipelineLiveness::release(size_t index, DataStructure& dataStructure)
+{
+  size_t numBytes = 0;
+  for(const std::string& path : getReleasePaths(index))
+  {
+    std::optional<DataObject::IdType> id = FindId(dataStructure, path);
+    auto* dataArray = id.has_value() ? dynamic_cast<IDataArray*>(dataStructure.getData(*id)) : nullptr;
+    // Groups cost nothing to keep; the arrays below them are released on their own
+    if(nullptr == dataArray)
+    {
+      continue;
+    }
+    const size_t arrayBytes = dataArray->getSize() * GetDataTypeSize(dataArray->getDataType());
+    const bool spillArray = m_Policy.mode == ArrayReleaseMode::Spill && m_InPlaceInputs.count(path) == 0;
+    const bool released = spillArray ? spill(*id, *dataArray) : dataStructure.removeData(*id);
+    if(released)
+    {
+      numBytes += arrayBytes;
+      m_ReleasedArrayCount++;
+    }
+  }
+  m_ReleasedBytes += numBytes;
+  return numBytes;
+}
+
+// -----------------------------------------------------------------------------
+bool PipelineLiveness::spill(DataObject::IdType id, IDataArray& dataArray)
+{
+  const fs::path spillPath = m_Policy.spillDirectory / (std::to_string(id) + ".raw");
+  bool spilled = false;
+  VisitNumericDataType(dataArray.getDataType(), [&](auto value) {
+    using T = decltype(value);
+    auto* typedArray = dynamic_cast<DataArray<T>*>(&dataArray);
+    if(nullptr == typedArray || nullptr == typedArray->getDataStore())
+    {
+      return;
+    }
+    // Values that were never loaded are not resident in the first place
+    if(const auto* lazyStore = dynamic_cast<const LazyDataStore<T>*>(typedArray->getDataStore()); nullptr != lazyStore && !lazyStore->isLoaded())
+    {
+      return;
+    }
+    if(!WriteRawDataStore<T>(spillPath, *typedArray->getDataStore()))
+    {
+      std::cout << "Could not spill " << dataArray.getName() << " to " << spillPath.string() << std::endl;
+      return;
+    }
+    const std::vector<size_t> tupleShape = typedArray->getDataStore()->getTupleShape();
+    const std::vector<size_t> componentShape = typedArray->getDataStore()->getComponentShape();
+    typedArray->setDataStore(std::make_shared<LazyDataStore<T>>(tupleShape, componentShape, [spillPath, tupleShape, componentShape]() {
+      return ReadRawDataStore<T>(spillPath, tupleShape, componentShape, RawReadMode::MemoryMapCopyOnWrite);
+    }));
+    spilled = true;
+  });
+  return spilled;
+}
+
+// -----------------------------------------------------------------------------
+const std::vector<std::string>& PipelineLiveness::getReleasePaths(size_t index) const
+{
+  static const std::vector<std::string> k_None;
+  return index < m_ReleasePaths.size() ? m_ReleasePaths[index] : k_None;
+}
+
+// -----------------------------------------------------------------------------
+std::optional<Arguments> PipelineLiveness::getInPlaceArguments(size_t index, const PipelineFilter& filterNode)
+{
+  const Arguments nodeArguments = filterNode.getArguments();
+  const auto* inputPath = nodeArguments.contains(k_InPlaceInputKey) ? std::any_cast<DataPath>(&nodeArguments.at(k_InPlaceInputKey)) : nullptr;
+  const IFilter* filter = filterNode.getFilter();
+  if(!filterNode.getParameters().contains(k_ExecuteInPlaceKey) || nullptr == inputPath || nullptr == filter ||
+     std::find(m_Policy.inPlaceFilters.begin(), m_Policy.inPlaceFilters.end(), filter->uuid()) == m_Policy.inPlaceFilters.end())
+  {
+    return {};
+  }
+  const std::vector<std::string>& releasePaths = getReleasePaths(index);
+  const std::string path = DataPathToString(*inputPath);
+  if(std::find(releasePaths.begin(), releasePaths.end(), path) == releasePaths.end())
+  {
+    return {};
+  }
+  m_InPlaceInputs.insert(path);
+  Arguments arguments = nodeArguments;
+  arguments.insertOrAssign(k_ExecuteInPlaceKey, std::make_any<bool>(true));
+  return arguments;
+}
+
+// -----------------------------------------------------------------------------
+size_t PipelineLiveness::getReleasedArrayCount() const
+{
+  return m_ReleasedArrayCount;
+}
+
+// -----------------------------------------------------------------------------
+size_t PipelineLiveness::getReleasedBytes() const
+{
+  return m_ReleasedBytes;
+}
+} // namespace complex
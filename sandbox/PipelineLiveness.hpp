@@ -0,0 +1,124 @@
+#pragma once
+
+#include "complex/Common/Uuid.hpp"
+#include "complex/DataStructure/DataPath.hpp"
+#include "complex/DataStructure/DataStructure.hpp"
+#include "complex/DataStructure/IDataArray.hpp"
+#include "complex/Filter/Arguments.hpp"
+#include "complex/Pipeline/Pipeline.hpp"
+#include "complex/Pipeline/PipelineFilter.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace complex
+{
+/**
+ * @brief What happens to an intermediate array once no later node reads it.
+ */
+enum class ArrayReleaseMode : uint8_t
+{
+  Free, // Remove it from the DataStructure
+  Spill // Write its values to a raw file and leave a LazyDataStore that reads them back if anything touches it again
+};
+
+struct LivenessPolicy
+{
+  ArrayReleaseMode mode = ArrayReleaseMode::Free;
+  std::vector<DataPath> outputs;        // Arrays (or groups of arrays) the pipeline's caller wants kept. Empty keeps every array no later node reads
+  std::filesystem::path spillDirectory; // Only used by ArrayReleaseMode::Spill
+  std::vector<Uuid> inPlaceFilters;     // Filters verified to run correctly with their input passed as their output
+};
+
+/**
+ * @class PipelineLiveness
+ * @brief Finds, from a preflight of the pipeline, the last node that uses each array the
+ * pipeline creates, and releases the array as soon as that node has executed.
+ *
+ * A node uses a path when it is one of its DataPath arguments or when its preflight created
+ * it; an argument naming a group uses everything below it. A node that is not a PipelineFilter
+ * may use anything, so nothing created before it is released until it ran. Arrays that
+ * existed before the pipeline (its inputs) and outputs are never released. Without outputs,
+ * an array is only released when a later node read it, so whatever the pipeline leaves
+ * unread is kept as its result.
+ *
+ * Like the other runners' hooks it wraps the nodes from outside: PipelineCheckpointer and
+ * ParallelPipelineExecutor call release() after each node when they are given a liveness.
+ *
+ * A filter that declares a k_ExecuteInPlaceKey bool parameter (the generated ITK filters whose
+ * output matches their input's type and size) can write its result over its input image and
+ * hand the input's DataStore to its output. That relies on the filter reading all of its input
+ * before it writes its output, so it is only turned on for filters listed in
+ * LivenessPolicy::inPlaceFilters. getInPlaceArguments() turns it on for a node whose input
+ * dies with it, and release() then drops the input array without spilling it. Only
+ * PipelineCheckpointer asks for it: ParallelPipelineExecutor gives a node that runs on a copy
+ * its own copy of the input's values anyway, so overwriting them would save nothing.
+ */
+class PipelineLiveness
+{
+public:
+  static inline constexpr const char* k_ExecuteInPlaceKey = "ExecuteInPlace";
+  static inline constexpr const char* k_InPlaceInputKey = "InputImageDataPath";
+
+  explicit PipelineLiveness(LivenessPolicy policy);
+  ~PipelineLiveness() noexcept = default;
+
+  PipelineLiveness(const PipelineLiveness&) = delete;
+  PipelineLiveness(PipelineLiveness&&) noexcept = delete;
+  PipelineLiveness& operator=(const PipelineLiveness&) = delete;
+  PipelineLiveness& operator=(PipelineLiveness&&) noexcept = delete;
+
+  /**
+   * @brief Preflights the pipeline on a copy of the DataStructure and plans the releases.
+   * @param pipeline
+   * @param dataStructure The structure the pipeline is going to execute on
+   * @return false if a node fails preflight. Nothing is released then.
+   */
+  bool analyze(Pipeline& pipeline, const DataStructure& dataStructure);
+
+  /**
+   * @brief Releases the arrays whose last use was the node. Call it once the node executed.
+   * @param index Position of the node in the pipeline
+   * @param dataStructure
+   * @return The bytes of values released
+   */
+  size_t release(size_t index, DataStructure& dataStructure);
+
+  /**
+   * @brief Returns the "/a/b/c" paths the pipeline created whose last use is the node. release()
+   * acts on the arrays among them.
+   * @param index
+   * @return
+   */
+  const std::vector<std::string>& getReleasePaths(size_t index) const;
+
+  /**
+   * @brief Returns the node's arguments with in-place execution turned on if the filter supports
+   * it, is listed in LivenessPolicy::inPlaceFilters and its input image is an array the
+   * pipeline created that no later node uses.
+   * @param index Position of the node in the pipeline
+   * @param filterNode
+   * @return Empty if the node has to execute as it is.
+   */
+  std::optional<Arguments> getInPlaceArguments(size_t index, const PipelineFilter& filterNode);
+
+  /**
+   * @brief Returns the number of arrays and bytes of values released since analyze().
+   */
+  size_t getReleasedArrayCount() const;
+  size_t getReleasedBytes() const;
+
+private:
+  bool spill(DataObject::IdType id, IDataArray& dataArray);
+
+  LivenessPolicy m_Policy;
+  std::vector<std::vector<std::string>> m_ReleasePaths;
+  std::set<std::string> m_InPlaceInputs; // Their values were overwritten and their stores handed on
+  size_t m_ReleasedArrayCount = 0;
+  size_t m_ReleasedBytes = 0;
+};
+} // namespace complex
@@ -0,0 +1,178 @@
+#include "PipelineTrace.hpp"
+
+#include "ConversionKernels.hpp"
+
+#include "complex/DataStructure/IDataArray.hpp"
+
+#include <fstream>
+#include <iostream>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <time.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace complex
+{
+namespace
+{
+int64_t ThreadCpuMicroseconds()
+{
+#if defined(__linux__) || defined(__APPLE__)
+  timespec cpuTime = {};
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpuTime);
+  return static_cast<int64_t>(cpuTime.tv_sec) * 1000000 + cpuTime.tv_nsec / 1000;
+#else
+  return 0;
+#endif
+}
+
+int64_t ResidentBytes()
+{
+#if defined(__linux__)
+  std::ifstream statm("/proc/self/statm");
+  int64_t totalPages = 0;
+  int64_t residentPages = 0;
+  statm >> totalPages >> residentPages;
+  return residentPages * static_cast<int64_t>(sysconf(_SC_PAGESIZE));
+#else
+  return 0;
+#endif
+}
+
+/**
+ * @brief Ids of the arrays in the DataStructure and the size of their values.
+ */
+std::map<DataObject::IdType, size_t> ListArrays(const DataStructure& dataStructure)
+{
+  std::map<DataObject::IdType, size_t> arrays;
+  for(const auto& [id, dataObject] : dataStructure)
+  {
+    if(const auto* dataArray = dynamic_cast<const IDataArray*>(dataObject.get()); nullptr != dataArray)
+    {
+      arrays[id] = dataArray->getSize() * GetDataTypeSize(dataArray->getDataType());
+    }
+  }
+  return arrays;
+}
+
+const char* PhaseName(FilterTraceEvent::Phase phase)
+{
+  return phase == FilterTraceEvent::Phase::Preflight ? "preflight" : "execute";
+}
+} // namespace
+
+// -----------------------------------------------------------------------------
+PipelineTracer::PipelineTracer()
+: m_StartTime(std::chrono::steady_clock::now())
+{
+}
+
+// -----------------------------------------------------------------------------
+size_t PipelineTracer::getThreadIndex()
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_ThreadIndices.emplace(std::this_thread::get_id(), m_ThreadIndices.size()).first->second;
+}
+
+// -----------------------------------------------------------------------------
+bool PipelineTracer::record(Phase phase, size_t index, AbstractPipelineNode& node, const DataStructure& dataStructure, const std::function<bool()>& run)
+{
+  FilterTraceEvent event;
+  event.name = node.getName();
+  event.phase = phase;
+  event.index = index;
+  event.threadIndex = getThreadIndex();
+
+  const std::map<DataObject::IdType, size_t> arraysBefore = ListArrays(dataStructure);
+  const int64_t residentBefore = ResidentBytes();
+  const int64_t cpuBefore = ThreadCpuMicroseconds();
+  const auto startTime = std::chrono::steady_clock::now();
+
+  event.succeeded = run();
+
+  const auto endTime = std::chrono::steady_clock::now();
+  event.cpuMicroseconds = ThreadCpuMicroseconds() - cpuBefore;
+  event.processResidentBytesDelta = ResidentBytes() - residentBefore;
+  event.startMicroseconds = std::chrono::duration_cast<std::chrono::microseconds>(startTime - m_StartTime).count();
+  event.wallMicroseconds = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count();
+  for(const auto& [id, numBytes] : ListArrays(dataStructure))
+  {
+    if(arraysBefore.count(id) == 0)
+    {
+      event.arraysCreated++;
+      event.createdArrayBytes += numBytes;
+    }
+  }
+
+  const bool succeeded = event.succeeded;
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  m_Events.push_back(std::move(event));
+  return succeeded;
+}
+
+// -----------------------------------------------------------------------------
+bool PipelineTracer::preflight(Pipeline& pipeline, DataStructure& dataStructure)
+{
+  for(size_t index = 0; index < pipeline.size(); index++)
+  {
+    AbstractPipelineNode* node = pipeline.at(index);
+    if(!record(Phase::Preflight, index, *node, dataStructure, [node, &dataStructure]() { return node->preflight(dataStructure); }))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+std::vector<FilterTraceEvent> PipelineTracer::getEvents() const
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_Events;
+}
+
+// -----------------------------------------------------------------------------
+nlohmann::json PipelineTracer::toChromeTrace() const
+{
+  nlohmann::json traceEvents = nlohmann::json::array();
+  for(const FilterTraceEvent& event : getEvents())
+  {
+    nlohmann::json eventJson;
+    eventJson["name"] = event.name;
+    eventJson["cat"] = PhaseName(event.phase);
+    eventJson["ph"] = "X";
+    eventJson["ts"] = event.startMicroseconds;
+    eventJson["dur"] = event.wallMicroseconds;
+    eventJson["pid"] = 1;
+    eventJson["tid"] = event.threadIndex;
+    eventJson["args"] = {{"index", event.index},
+                         {"succeeded", event.succeeded},
+                         {"cpu_us", event.cpuMicroseconds},
+                         {"arrays_created", event.arraysCreated},
+                         {"created_array_bytes", event.createdArrayBytes},
+                         {"process_resident_bytes_delta", event.processResidentBytesDelta}};
+    traceEvents.push_back(std::move(eventJson));
+  }
+
+  nlohmann::json rootJson;
+  rootJson["traceEvents"] = std::move(traceEvents);
+  rootJson["displayTimeUnit"] = "ms";
+  return rootJson;
+}
+
+// -----------------------------------------------------------------------------
+bool PipelineTracer::writeChromeTrace(const fs::path& filePath) const
+{
+  std::ofstream outputFile(filePath, std::ios::out | std::ios::trunc);
+  outputFile << toChromeTrace().dump(1);
+  if(!outputFile.good())
+  {
+    std::cout << "Error writing pipeline trace " << filePath.string() << std::endl;
+    return false;
+  }
+  return true;
+}
+} // namespace complex
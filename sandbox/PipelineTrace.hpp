@@ -0,0 +1,115 @@
+#pragma once
+
+#include "complex/DataStructure/DataStructure.hpp"
+#include "complex/Pipeline/AbstractPipelineNode.hpp"
+#include "complex/Pipeline/Pipeline.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace complex
+{
+/**
+ * @brief What one preflight or execution of a pipeline node cost.
+ */
+struct FilterTraceEvent
+{
+  enum class Phase : uint8_t
+  {
+    Preflight,
+    Execute
+  };
+
+  std::string name;
+  Phase phase = Phase::Execute;
+  size_t index = 0;             // Position of the node in the pipeline
+  bool succeeded = false;
+  int64_t startMicroseconds = 0; // Since the tracer was created
+  int64_t wallMicroseconds = 0;
+  int64_t cpuMicroseconds = 0;   // CPU time of the calling thread; threads the filter starts itself are not included
+  size_t arraysCreated = 0;
+  size_t createdArrayBytes = 0;          // Size of the values of the arrays the node created, not what was actually allocated
+  int64_t processResidentBytesDelta = 0; // Change of the whole process' resident set size, including other threads' nodes
+  size_t threadIndex = 0;                // Small number per thread that ran nodes, in order of appearance
+};
+
+/**
+ * @class PipelineTracer
+ * @brief Records wall time, CPU time, memory and the arrays created for every pipeline node
+ * that is preflighted or executed through it, and exports them as Chrome trace-event JSON
+ * (load the file in chrome://tracing or Perfetto to see the filters on a timeline).
+ *
+ * Allocations are not measured. The memory figures are approximations: createdArrayBytes
+ * counts the arrays a node leaves behind but not its temporaries, and lazily or memory mapped
+ * arrays may never be resident. processResidentBytesDelta is process-wide, so nodes that run
+ * concurrently, other threads and freed memory the allocator keeps all show up in it.
+ *
+ * Pipeline itself is not instrumented; the sandbox's runners (PipelineCheckpointer,
+ * ParallelPipelineExecutor) call record() around each node when they are given a tracer.
+ * Events may be recorded from several threads at once.
+ */
+class PipelineTracer
+{
+public:
+  using Phase = FilterTraceEvent::Phase;
+
+  PipelineTracer();
+  ~PipelineTracer() noexcept = default;
+
+  PipelineTracer(const PipelineTracer&) = delete;
+  PipelineTracer(PipelineTracer&&) noexcept = delete;
+  PipelineTracer& operator=(const PipelineTracer&) = delete;
+  PipelineTracer& operator=(PipelineTracer&&) noexcept = delete;
+
+  /**
+   * @brief Runs the preflight or execution of one node and records what it cost.
+   * @param phase
+   * @param index Position of the node in the pipeline
+   * @param node
+   * @param dataStructure The DataStructure the node runs on; it is compared before and after to find the arrays it created
+   * @param run Preflights or executes the node
+   * @return The result of run
+   */
+  bool record(Phase phase, size_t index, AbstractPipelineNode& node, const DataStructure& dataStructure, const std::function<bool()>& run);
+
+  /**
+   * @brief Preflights the pipeline one node at a time, recording each node. Stops at the first node that fails.
+   * @param pipeline
+   * @param dataStructure
+   * @return
+   */
+  bool preflight(Pipeline& pipeline, DataStructure& dataStructure);
+
+  std::vector<FilterTraceEvent> getEvents() const;
+
+  /**
+   * @brief Returns the events in Chrome's trace-event format: complete ("X") events whose args hold the measurements.
+   * @return
+   */
+  nlohmann::json toChromeTrace() const;
+
+  /**
+   * @brief Writes toChromeTrace() to the file.
+   * @param filePath
+   * @return false if the file could not be written.
+   */
+  bool writeChromeTrace(const std::filesystem::path& filePath) const;
+
+private:
+  size_t getThreadIndex();
+
+  std::chrono::steady_clock::time_point m_StartTime;
+  mutable std::mutex m_Mutex;
+  std::vector<FilterTraceEvent> m_Events;
+  std::map<std::thread::id, size_t> m_ThreadIndices;
+};
+} // namespace complex
@@ -0,0 +1,287 @@
+#include "RawByteSource.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+#ifdef SANDBOX_ENABLE_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef SANDBOX_ENABLE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace complex
+{
+namespace
+{
+constexpr size_t k_DecodeBufferSize = 1048576;
+
+/**
+ * @brief Uncompressed files
+ */
+class FileByteSource : public RawByteSource
+{
+public:
+  explicit FileByteSource(FILE* file)
+  : m_File(file)
+  {
+  }
+
+  ~FileByteSource() noexcept override
+  {
+    fclose(m_File);
+  }
+
+  size_t read(std::byte* buffer, size_t numBytes) override
+  {
+    size_t total = 0;
+    while(total < numBytes)
+    {
+      size_t bytesRead = std::fread(buffer + total, sizeof(std::byte), numBytes - total, m_File);
+      if(bytesRead == 0)
+      {
+        m_HasError = (std::ferror(m_File) != 0);
+        break;
+      }
+      total += bytesRead;
+    }
+    return total;
+  }
+
+  bool hasError() const override
+  {
+    return m_HasError;
+  }
+
+  Compression compression() const override
+  {
+    return Compression::None;
+  }
+
+private:
+  FILE* m_File = nullptr;
+  bool m_HasError = false;
+};
+
+#ifdef SANDBOX_ENABLE_ZLIB
+/**
+ * @brief gzip (and raw zlib) files. gzread() streams the inflate into the caller's buffer.
+ */
+class GzipByteSource : public RawByteSource
+{
+public:
+  explicit GzipByteSource(gzFile file)
+  : m_File(file)
+  {
+    gzbuffer(m_File, static_cast<unsigned>(k_DecodeBufferSize));
+  }
+
+  ~GzipByteSource() noexcept override
+  {
+    gzclose(m_File);
+  }
+
+  size_t read(std::byte* buffer, size_t numBytes) override
+  {
+    size_t total = 0;
+    while(total < numBytes)
+    {
+      // gzread() takes an unsigned length so very large requests are split up
+      const auto request = static_cast<unsigned>(std::min(numBytes - total, static_cast<size_t>(std::numeric_limits<int>::max())));
+      int bytesRead = gzread(m_File, buffer + total, request);
+      if(bytesRead <= 0)
+      {
+        m_HasError = (bytesRead < 0);
+        break;
+      }
+      total += static_cast<size_t>(bytesRead);
+    }
+    return total;
+  }
+
+  bool hasError() const override
+  {
+    return m_HasError;
+  }
+
+  Compression compression() const override
+  {
+    return Compression::Gzip;
+  }
+
+private:
+  gzFile m_File = nullptr;
+  bool m_HasError = false;
+};
+#endif
+
+#ifdef SANDBOX_ENABLE_ZSTD
+/**
+ * @brief Zstandard files. Only the compressed input is buffered; frames are decoded straight into the caller's buffer.
+ */
+class ZstdByteSource : public RawByteSource
+{
+public:
+  explicit ZstdByteSource(FILE* file)
+  : m_File(file)
+  , m_Context(ZSTD_createDCtx())
+  , m_InputBuffer(ZSTD_DStreamInSize())
+  {
+  }
+
+  ~ZstdByteSource() noexcept override
+  {
+    ZSTD_freeDCtx(m_Context);
+    fclose(m_File);
+  }
+
+  size_t read(std::byte* buffer, size_t numBytes) override
+  {
+    ZSTD_outBuffer output = {buffer, numBytes, 0};
+    while(output.pos < output.size && !m_HasError)
+    {
+      if(m_Input.pos == m_Input.size)
+      {
+        m_Input.size = std::fread(m_InputBuffer.data(), sizeof(std::byte), m_InputBuffer.size(), m_File);
+        m_Input.src = m_InputBuffer.data();
+        m_Input.pos = 0;
+        if(m_Input.size == 0)
+        {
+          // A truncated file ends in the middle of a frame
+          m_HasError = (std::ferror(m_File) != 0) || (m_LastResult != 0);
+          break;
+        }
+      }
+      m_LastResult = ZSTD_decompressStream(m_Context, &output, &m_Input);
+      if(ZSTD_isError(m_LastResult) != 0U)
+      {
+        std::cout << "Zstd decode error: " << ZSTD_getErrorName(m_LastResult) << std::endl;
+        m_HasError = true;
+      }
+    }
+    return output.pos;
+  }
+
+  bool hasError() const override
+  {
+    return m_HasError;
+  }
+
+  Compression compression() const override
+  {
+    return Compression::Zstd;
+  }
+
+private:
+  FILE* m_File = nullptr;
+  ZSTD_DCtx* m_Context = nullptr;
+  std::vector<std::byte> m_InputBuffer;
+  ZSTD_inBuffer m_Input = {nullptr, 0, 0};
+  size_t m_LastResult = 0;
+  bool m_HasError = false;
+};
+#endif
+} // namespace
+
+// -----------------------------------------------------------------------------
+RawByteSource::~RawByteSource() noexcept = default;
+
+// -----------------------------------------------------------------------------
+RawByteSource::Compression RawByteSource::CompressionFromPath(const fs::path& filePath)
+{
+  const fs::path extension = filePath.extension();
+  if(extension == ".gz")
+  {
+    return Compression::Gzip;
+  }
+  if(extension == ".zst")
+  {
+    return Compression::Zstd;
+  }
+  return Compression::None;
+}
+
+// -----------------------------------------------------------------------------
+bool RawByteSource::IsSupported(Compression compression)
+{
+  switch(compression)
+  {
+  case Compression::None:
+    return true;
+  case Compression::Gzip:
+#ifdef SANDBOX_ENABLE_ZLIB
+    return true;
+#else
+    return false;
+#endif
+  case Compression::Zstd:
+#ifdef SANDBOX_ENABLE_ZSTD
+    return true;
+#else
+    return false;
+#endif
+  }
+  return false;
+}
+
+// -----------------------------------------------------------------------------
+fs::path RawByteSource::Resolve(const fs::path& filePath)
+{
+  if(fs::exists(filePath))
+  {
+    return filePath;
+  }
+  for(const char* extension : {".zst", ".gz"})
+  {
+    fs::path compressedPath = filePath;
+    compressedPath += extension;
+    if(fs::exists(compressedPath) && IsSupported(CompressionFromPath(compressedPath)))
+    {
+      return compressedPath;
+    }
+  }
+  return filePath;
+}
+
+// -----------------------------------------------------------------------------
+std::unique_ptr<RawByteSource> RawByteSource::Open(const fs::path& filePath, bool decompress)
+{
+  const Compression compression = decompress ? CompressionFromPath(filePath) : Compression::None;
+  if(!IsSupported(compression))
+  {
+    std::cout << "This build can not decode '" << filePath.string() << "'" << std::endl;
+    return nullptr;
+  }
+
+#ifdef SANDBOX_ENABLE_ZLIB
+  if(compression == Compression::Gzip)
+  {
+    gzFile file = gzopen(filePath.string().c_str(), "rb");
+    if(file == nullptr)
+    {
+      return nullptr;
+    }
+    return std::make_unique<GzipByteSource>(file);
+  }
+#endif
+
+  FILE* file = std::fopen(filePath.string().c_str(), "rb");
+  if(file == nullptr)
+  {
+    return nullptr;
+  }
+#ifdef SANDBOX_ENABLE_ZSTD
+  if(compression == Compression::Zstd)
+  {
+    return std::make_unique<ZstdByteSource>(file);
+  }
+#endif
+  return std::make_unique<FileByteSource>(file);
+}
+} // namespace complex
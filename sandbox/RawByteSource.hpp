@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+
+namespace complex
+{
+/**
+ * @class RawByteSource
+ * @brief Sequential reader for the bytes of a raw file that may be stored compressed.
+ * Compressed files are decoded in a streaming fashion straight into the caller's
+ * buffer so no temporary copy of the whole file is ever made.
+ *
+ * Decoding is opt-in: a file is only decompressed when the caller asks for it, and then
+ * the codec is chosen from the file extension: '.gz' is gzip/zlib and '.zst' is
+ * Zstandard. Anything else, and every file opened without decompression, is read as-is.
+ */
+class RawByteSource
+{
+public:
+  enum class Compression : uint8_t
+  {
+    None,
+    Gzip,
+    Zstd
+  };
+
+  /**
+   * @brief Returns the compression implied by the extension of the file.
+   * @param filePath
+   * @return
+   */
+  static Compression CompressionFromPath(const std::filesystem::path& filePath);
+
+  /**
+   * @brief Returns true if this build of the sandbox can decode the compression.
+   * @param compression
+   * @return
+   */
+  static bool IsSupported(Compression compression);
+
+  /**
+   * @brief Returns filePath if it exists, otherwise the first of 'filePath.zst' or
+   * 'filePath.gz' that exists and can be decoded. Returns filePath if none exist.
+   * @param filePath
+   * @return
+   */
+  static std::filesystem::path Resolve(const std::filesystem::path& filePath);
+
+  /**
+   * @brief Opens the file, with the decoder its extension names when decompress is set.
+   * @param filePath
+   * @param decompress false reads the bytes of a '.gz' or '.zst' file as they are
+   * @return nullptr if the file can not be opened or the codec was not compiled in.
+   */
+  static std::unique_ptr<RawByteSource> Open(const std::filesystem::path& filePath, bool decompress);
+
+  virtual ~RawByteSource() noexcept;
+
+  RawByteSource(const RawByteSource&) = delete;
+  RawByteSource(RawByteSource&&) noexcept = delete;
+  RawByteSource& operator=(const RawByteSource&) = delete;
+  RawByteSource& operator=(RawByteSource&&) noexcept = delete;
+
+  /**
+   * @brief Reads (decompressing if needed) up to numBytes into the buffer.
+   * @param buffer
+   * @param numBytes
+   * @return The number of bytes written. Less than numBytes only at the end of the data or on error.
+   */
+  virtual size_t read(std::byte* buffer, size_t numBytes) = 0;
+
+  /**
+   * @brief Returns true if the file is corrupt or could not be read.
+   * @return
+   */
+  virtual bool hasError() const = 0;
+
+  virtual Compression compression() const = 0;
+
+protected:
+  RawByteSource() = default;
+};
+} // namespace complex
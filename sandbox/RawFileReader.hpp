@@ -0,0 +1,313 @@
+#pragma once
+
+#include "ArenaDataStore.hpp"
+#include "ArrayStatistics.hpp"
+#include "ConversionKernels.hpp"
+#include "LazyDataStore.hpp"
+#include "MmapDataStore.hpp"
+#include "RawByteSource.hpp"
+#include "TiledDataStore.hpp"
+
+#include "complex/DataStructure/DataStore.hpp"
+#include "complex/DataStructure/IDataStore.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <optional>
+#include <vector>
+
+namespace complex
+{
+/**
+ * @brief How the bytes of a raw file get into the DataStore.
+ */
+enum class RawReadMode : uint8_t
+{
+  Copy,                // Allocate a DataStore<T> and fread() the file into it.
+  MemoryMap,           // Map the file read-only. No copy is made and the pages are shared with other processes. Modifying a value throws.
+  MemoryMapCopyOnWrite, // Map the file privately. No copy is made until a value is modified. Use this for stores filters may write to.
+  OutOfCore             // Leave the values on disk and page tiles in on demand through TileCache::Default().
+};
+
+/**
+ * @brief Reads a raw file of native endian T values into a new DataStore. Nothing is
+ * inserted into a DataStructure so this is safe to call from any thread.
+ *
+ * When the sourceFormat asks for it, files ending in '.gz' or '.zst' are decompressed chunk by
+ * chunk straight into the DataStore. Compressed files can not be memory mapped so they are
+ * always copied. Without it every file is read as raw bytes, whatever its extension.
+ *
+ * When the file holds a different type or byte order than T, pass a sourceFormat. Each
+ * chunk is then read into a small staging buffer and byte swapped/converted into the
+ * DataStore while it is still in cache, instead of converting the whole array afterwards.
+ * Converted files can not be memory mapped or read out-of-core either; they fall back to a copy.
+ *
+ * When an arena is given, arrays small enough for it are copied into arena memory
+ * whatever the readMode is: for a small file a copy is cheaper than a mapping (which costs
+ * at least a page and a system call) and far cheaper than a heap allocation per array.
+ * @param filename
+ * @param tupleShape
+ * @param numComponents
+ * @param readMode
+ * @param statisticsSink Optional. Is fed each chunk right after it is read so no second pass over the data is needed.
+ * @param sourceFormat Optional. The type, byte order and compression of the values in the file. Defaults to uncompressed native endian T.
+ * @param arena Optional. Small arrays are sub-allocated from it (see ArenaDataStore).
+ * @return nullptr if the file does not exist or its (decompressed) size does not match the requested shape.
+ */
+template <typename T>
+std::shared_ptr<IDataStore<T>> ReadRawDataStore(const std::filesystem::path& filename, const std::vector<size_t>& tupleShape, const std::vector<size_t>& numComponents,
+                                                RawReadMode readMode = RawReadMode::Copy, StatisticsSink<T>* statisticsSink = nullptr, std::optional<RawSourceFormat> sourceFormat = {},
+                                                std::shared_ptr<StoreArena> arena = nullptr)
+{
+  using DataStoreType = DataStore<T>;
+  const size_t numTuples = std::accumulate(tupleShape.begin(), tupleShape.end(), static_cast<size_t>(1), std::multiplies<>());
+  constexpr size_t defaultBlocksize = 1048576;
+
+  if(!std::filesystem::exists(filename))
+  {
+    std::cout << "File Does Not Exist:'" << filename.string() << "'" << std::endl;
+    return nullptr;
+  }
+
+  // A source format that matches T exactly needs no conversion at all
+  const bool needsConversion = sourceFormat.has_value() && !(sourceFormat->dataType == GetDataType<T>() && sourceFormat->byteOrder == k_NativeEndian);
+  const size_t sourceValueSize = needsConversion ? GetDataTypeSize(sourceFormat->dataType) : sizeof(T);
+  if(sourceValueSize == 0)
+  {
+    std::cout << "Unsupported source type for raw file:'" << filename.string() << "'" << std::endl;
+    return nullptr;
+  }
+
+  const size_t numValues = numTuples * std::accumulate(numComponents.begin(), numComponents.end(), static_cast<size_t>(1), std::multiplies<>());
+  const size_t numBytesToRead = numValues * sourceValueSize;
+
+  // The decompressed size of a compressed file is only known once it has been decoded
+  const bool decompress = sourceFormat.has_value() && sourceFormat->decompress;
+  const bool isCompressed = decompress && RawByteSource::CompressionFromPath(filename) != RawByteSource::Compression::None;
+  if(!isCompressed && numBytesToRead != std::filesystem::file_size(filename))
+  {
+    std::cout << "FileSize and Allocated Size do not match" << std::endl;
+    return nullptr;
+  }
+
+  const bool useArena = (nullptr != arena && arena->accepts(numValues * sizeof(T)));
+  const bool canReadInPlace = !isCompressed && !needsConversion && !useArena;
+  if(readMode == RawReadMode::OutOfCore && canReadInPlace)
+  {
+    if(nullptr != statisticsSink)
+    {
+      std::cout << "Statistics are not computed for out-of-core arrays:'" << filename.string() << "'" << std::endl;
+    }
+    return TiledDataStore<T>::Open(filename, tupleShape, numComponents, TileCache::Default());
+  }
+
+  if((readMode == RawReadMode::MemoryMap || readMode == RawReadMode::MemoryMapCopyOnWrite) && canReadInPlace)
+  {
+    MappedFile::Access access = (readMode == RawReadMode::MemoryMap) ? MappedFile::Access::ReadOnly : MappedFile::Access::CopyOnWrite;
+    std::shared_ptr<MmapDataStore<T>> mmapStore = MmapDataStore<T>::Open(filename, tupleShape, numComponents, access);
+    if(nullptr != mmapStore && nullptr != statisticsSink)
+    {
+      // Walk the mapping in the same sized chunks so each page is faulted in and summarized in one go
+      const T* values = static_cast<const MmapDataStore<T>&>(*mmapStore).data();
+      constexpr size_t valuesPerChunk = defaultBlocksize / sizeof(T);
+      for(size_t offset = 0; offset < numValues; offset += valuesPerChunk)
+      {
+        statisticsSink->consume(values + offset, std::min(valuesPerChunk, numValues - offset));
+      }
+    }
+    return mmapStore;
+  }
+
+  std::unique_ptr<RawByteSource> byteSource = RawByteSource::Open(filename, decompress);
+  if(nullptr == byteSource)
+  {
+    return nullptr;
+  }
+
+  std::shared_ptr<IDataStore<T>> dataStore;
+  T* values = nullptr;
+  if(useArena)
+  {
+    std::shared_ptr<ArenaDataStore<T>> arenaStore = ArenaDataStore<T>::Create(arena, tupleShape, numComponents);
+    values = arenaStore->data();
+    dataStore = arenaStore;
+  }
+  else
+  {
+    std::shared_ptr<DataStoreType> heapStore = std::shared_ptr<DataStoreType>(new DataStoreType(tupleShape, numComponents));
+    values = heapStore->data();
+    dataStore = heapStore;
+  }
+
+  if(needsConversion)
+  {
+    // The staging buffer is reused for every chunk so it stays resident in cache
+    std::vector<std::byte> stagingBuffer(defaultBlocksize);
+    const size_t valuesPerChunk = defaultBlocksize / sourceValueSize;
+    for(size_t offset = 0; offset < numValues; offset += valuesPerChunk)
+    {
+      const size_t chunkValues = std::min(valuesPerChunk, numValues - offset);
+      const size_t chunkBytes = chunkValues * sourceValueSize;
+      if(byteSource->read(stagingBuffer.data(), chunkBytes) != chunkBytes || byteSource->hasError())
+      {
+        std::cout << "Unexpected end of file or corrupt data:'" << filename.string() << "'" << std::endl;
+        return nullptr;
+      }
+      ConvertRawValues(*sourceFormat, stagingBuffer.data(), values + offset, chunkValues);
+      if(nullptr != statisticsSink)
+      {
+        statisticsSink->consume(values + offset, chunkValues);
+      }
+    }
+  }
+
+  std::byte* chunkptr = reinterpret_cast<std::byte*>(values);
+
+  // Now start reading the data in chunks if needed.
+  size_t chunkSize = std::min(numBytesToRead, defaultBlocksize);
+
+  // Converted data has already been read in full above
+  size_t masterCounter = needsConversion ? numBytesToRead : 0;
+  size_t valuesSummarized = 0;
+  while(masterCounter < numBytesToRead)
+  {
+    size_t bytesRead = byteSource->read(chunkptr, chunkSize);
+    if(bytesRead == 0 || byteSource->hasError())
+    {
+      std::cout << "Unexpected end of file or corrupt data:'" << filename.string() << "'" << std::endl;
+      return nullptr;
+    }
+    chunkptr += bytesRead;
+    masterCounter += bytesRead;
+
+    if(nullptr != statisticsSink)
+    {
+      // Only whole values can be summarized; a partially read value is picked up with the next chunk
+      const size_t valuesRead = masterCounter / sizeof(T);
+      statisticsSink->consume(values + valuesSummarized, valuesRead - valuesSummarized);
+      valuesSummarized = valuesRead;
+    }
+
+    size_t bytesLeft = numBytesToRead - masterCounter;
+
+    if(bytesLeft < chunkSize)
+    {
+      chunkSize = bytesLeft;
+    }
+  }
+
+  // A compressed file that decodes to more bytes than requested is the wrong shape
+  std::byte extraByte;
+  if(isCompressed && byteSource->read(&extraByte, 1) != 0)
+  {
+    std::cout << "Decompressed Size and Allocated Size do not match" << std::endl;
+    return nullptr;
+  }
+
+  return dataStore;
+}
+
+/**
+ * @brief Reads a raw file into a DataStore with a one dimensional tuple shape. See above.
+ */
+template <typename T>
+std::shared_ptr<IDataStore<T>> ReadRawDataStore(const std::filesystem::path& filename, size_t numTuples, const std::vector<size_t>& numComponents, RawReadMode readMode = RawReadMode::Copy,
+                                                StatisticsSink<T>* statisticsSink = nullptr, std::optional<RawSourceFormat> sourceFormat = {}, std::shared_ptr<StoreArena> arena = nullptr)
+{
+  return ReadRawDataStore<T>(filename, std::vector<size_t>{numTuples}, numComponents, readMode, statisticsSink, sourceFormat, std::move(arena));
+}
+
+/**
+ * @brief Checks that a raw file exists and that its size matches numValues values of the
+ * source format, without reading it. Files to be decompressed can only be checked for existence.
+ * @param filename
+ * @param numValues
+ * @param sourceFormat Optional. The type, byte order and compression of the values in the file. Defaults to uncompressed native endian T.
+ * @return
+ */
+template <typename T>
+bool CheckRawFileSize(const std::filesystem::path& filename, size_t numValues, std::optional<RawSourceFormat> sourceFormat = {})
+{
+  if(!std::filesystem::exists(filename))
+  {
+    std::cout << "File Does Not Exist:'" << filename.string() << "'" << std::endl;
+    return false;
+  }
+
+  const bool needsConversion = sourceFormat.has_value() && !(sourceFormat->dataType == GetDataType<T>() && sourceFormat->byteOrder == k_NativeEndian);
+  const size_t sourceValueSize = needsConversion ? GetDataTypeSize(sourceFormat->dataType) : sizeof(T);
+  const bool isCompressed = sourceFormat.has_value() && sourceFormat->decompress && RawByteSource::CompressionFromPath(filename) != RawByteSource::Compression::None;
+  if(sourceValueSize == 0 || (!isCompressed && numValues * sourceValueSize != std::filesystem::file_size(filename)))
+  {
+    std::cout << "FileSize and Allocated Size do not match" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Returns a LazyDataStore that reads the raw file with ReadRawDataStore() the first
+ * time its values are accessed. Only the file's existence and size are checked now, so
+ * preflight and arrays that are never used cost no I/O.
+ *
+ * Statistics are not available for deferred arrays since nothing has been read yet.
+ * @param filename
+ * @param numTuples
+ * @param numComponents
+ * @param readMode How the file is read once the values are needed
+ * @param sourceFormat Optional. The type and byte order of the values in the file. Defaults to native endian T.
+ * @return nullptr if the file does not exist or its size does not match the requested shape.
+ */
+template <typename T>
+std::shared_ptr<IDataStore<T>> ReadRawDataStoreDeferred(const std::filesystem::path& filename, size_t numTuples, const std::vector<size_t>& numComponents, RawReadMode readMode = RawReadMode::Copy,
+                                                        std::optional<RawSourceFormat> sourceFormat = {})
+{
+  const size_t numValues = numTuples * std::accumulate(numComponents.begin(), numComponents.end(), static_cast<size_t>(1), std::multiplies<>());
+  if(!CheckRawFileSize<T>(filename, numValues, sourceFormat))
+  {
+    return nullptr;
+  }
+
+  return std::make_shared<LazyDataStore<T>>(typename IDataStore<T>::ShapeType{numTuples}, numComponents,
+                                            [=]() { return ReadRawDataStore<T>(filename, numTuples, numComponents, readMode, nullptr, sourceFormat); });
+}
+/**
+ * @brief Writes the store's values to a raw file of native endian T values, the layout
+ * ReadRawDataStore() reads back.
+ * @param filename
+ * @param store Stores other than DataStore<T> are copied out a block at a time.
+ * @return false if the file could not be written.
+ */
+template <typename T>
+bool WriteRawDataStore(const std::filesystem::path& filename, const IDataStore<T>& store)
+{
+  std::ofstream outputFile(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+  if(const auto* dataStore = dynamic_cast<const DataStore<T>*>(&store); nullptr != dataStore)
+  {
+    outputFile.write(reinterpret_cast<const char*>(dataStore->data()), static_cast<std::streamsize>(store.getSize() * sizeof(T)));
+    return outputFile.good();
+  }
+
+  constexpr size_t k_BlockSize = 64 * 1024;
+  std::vector<T> block;
+  block.reserve(std::min(k_BlockSize, store.getSize()));
+  for(size_t offset = 0; offset < store.getSize() && outputFile.good(); offset += k_BlockSize)
+  {
+    block.clear();
+    const size_t end = std::min(offset + k_BlockSize, store.getSize());
+    for(size_t i = offset; i < end; i++)
+    {
+      block.push_back(store.getValue(i));
+    }
+    outputFile.write(reinterpret_cast<const char*>(block.data()), static_cast<std::streamsize>(block.size() * sizeof(T)));
+  }
+  return outputFile.good();
+}
+} // namespace complex
@@ -0,0 +1,425 @@
+#pragma once
+
+#include "ArrayStatistics.hpp"
+#include "RawFileReader.hpp"
+#include "RawSidecar.hpp"
+#include "SharedDataStore.hpp"
+#include "ThreadPool.hpp"
+
+#include "complex/DataStructure/DataArray.hpp"
+#include "complex/DataStructure/DataObject.hpp"
+#include "complex/DataStructure/DataStructure.hpp"
+
+#include <any>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <numeric>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace complex
+{
+/**
+ * @class RawIngestScheduler
+ * @brief Reads a set of raw files concurrently on a ThreadPool and then inserts the
+ * resulting DataArrays into a DataStructure in the order the loads were added.
+ *
+ * The DataStructure is only ever touched from the thread that calls insertInto() so
+ * the DataObject ids and child order are identical to loading the files one after another.
+ *
+ * A file whose contents are known to duplicate an earlier load can be added with
+ * push_back_duplicate(); it is not read at all and its DataArray shares the earlier
+ * load's values through a SharedDataStore.
+ *
+ * In metadata-only mode push_back() reads nothing: the DataArrays get their shape and type
+ * from the arguments and LazyDataStores that read the file later. Such a DataStructure is
+ * enough for preflight. promote() then reads every one of those files concurrently, so the
+ * structure that was preflighted is executed without building it a second time.
+ */
+class RawIngestScheduler
+{
+public:
+  /**
+   * @brief Creates the DataArray of a finished load. 'shareable' wraps the values in a SharedDataStore
+   * because duplicates are going to share them.
+   */
+  using InsertFunction = std::function<DataObject*(DataStructure&, bool shareable)>;
+  /**
+   * @brief Creates another DataArray that shares the values of a finished load.
+   */
+  using ShareFunction = std::function<DataObject*(DataStructure&, const std::string& name, std::optional<DataObject::IdType> parentId)>;
+
+  explicit RawIngestScheduler(ThreadPool& threadPool)
+  : m_ThreadPool(threadPool)
+  {
+  }
+
+  ~RawIngestScheduler() = default;
+
+  RawIngestScheduler(const RawIngestScheduler&) = delete;
+  RawIngestScheduler(RawIngestScheduler&&) noexcept = delete;
+  RawIngestScheduler& operator=(const RawIngestScheduler&) = delete;
+  RawIngestScheduler& operator=(RawIngestScheduler&&) noexcept = delete;
+
+  /**
+   * @brief Starts reading the file immediately on the thread pool.
+   * @param filename
+   * @param name Name of the DataArray that will be created
+   * @param tupleShape
+   * @param numComponents
+   * @param parentId
+   * @param readMode
+   * @param numHistogramBins Non-zero computes ArrayStatistics during the read and stores them in the
+   * DataArray's metadata under k_StatisticsMetadataKey.
+   * @param sourceFormat Type and byte order of the values in the file when they are not native endian T.
+   */
+  template <typename T>
+  void push_back(const std::filesystem::path& filename, const std::string& name, const std::vector<size_t>& tupleShape, const std::vector<size_t>& numComponents,
+                 std::optional<DataObject::IdType> parentId, RawReadMode readMode = RawReadMode::Copy, size_t numHistogramBins = 0, std::optional<RawSourceFormat> sourceFormat = {})
+  {
+    if(m_MetadataOnly)
+    {
+      pushMetadataOnly<T>(filename, name, tupleShape, numComponents, parentId, readMode, numHistogramBins, sourceFormat);
+      return;
+    }
+    if(m_LoggingEnabled)
+    {
+      std::cout << "  Reading file " << filename.string() << std::endl;
+    }
+    m_HasDuplicates.push_back(false);
+    m_Loads.push_back(m_ThreadPool.submit([=, arena = m_Arena]() -> Load {
+      std::optional<StatisticsSink<T>> statisticsSink;
+      if(numHistogramBins > 0)
+      {
+        statisticsSink.emplace(numHistogramBins);
+      }
+      std::shared_ptr<IDataStore<T>> dataStore = ReadRawDataStore<T>(filename, tupleShape, numComponents, readMode, statisticsSink.has_value() ? &(*statisticsSink) : nullptr, sourceFormat, arena);
+      if(nullptr == dataStore)
+      {
+        return FailedLoad();
+      }
+      std::optional<ArrayStatistics> statistics;
+      if(statisticsSink.has_value())
+      {
+        statistics = statisticsSink->finish();
+      }
+      return MakeLoad<T>(dataStore, name, parentId, statistics);
+    }).share());
+  }
+
+  /**
+   * @brief Reads the file into a one dimensional tuple shape. See above.
+   */
+  template <typename T>
+  void push_back(const std::filesystem::path& filename, const std::string& name, size_t numTuples, const std::vector<size_t>& numComponents, std::optional<DataObject::IdType> parentId,
+                 RawReadMode readMode = RawReadMode::Copy, size_t numHistogramBins = 0, std::optional<RawSourceFormat> sourceFormat = {})
+  {
+    push_back<T>(filename, name, std::vector<size_t>{numTuples}, numComponents, parentId, readMode, numHistogramBins, sourceFormat);
+  }
+
+  /**
+   * @brief Starts reading the file into a DataArray of the type, shape and name given by its sidecar.
+   * @param filename
+   * @param sidecar
+   * @param parentId
+   * @param readMode
+   * @return false if the sidecar's type can not be read from a raw file.
+   */
+  bool push_back(const std::filesystem::path& filename, const RawSidecar& sidecar, std::optional<DataObject::IdType> parentId, RawReadMode readMode = RawReadMode::Copy)
+  {
+    const RawSourceFormat sourceFormat = sidecar.getSourceFormat();
+    switch(sidecar.dataType)
+    {
+    case DataType::int8:
+      push_back<int8>(filename, sidecar.name, sidecar.tupleDims, sidecar.componentDims, parentId, readMode, 0, sourceFormat);
+      return true;
+    case DataType::uint8:
+      push_back<uint8>(filename, sidecar.name, sidecar.tupleDims, sidecar.componentDims, parentId, readMode, 0, sourceFormat);
+      return true;
+    case DataType::int16:
+      push_back<int16>(filename, sidecar.name, sidecar.tupleDims, sidecar.componentDims, parentId, readMode, 0, sourceFormat);
+      return true;
+    case DataType::uint16:
+      push_back<uint16>(filename, sidecar.name, sidecar.tupleDims, sidecar.componentDims, parentId, readMode, 0, sourceFormat);
+      return true;
+    case DataType::int32:
+      push_back<int32>(filename, sidecar.name, sidecar.tupleDims, sidecar.componentDims, parentId, readMode, 0, sourceFormat);
+      return true;
+    case DataType::uint32:
+      push_back<uint32>(filename, sidecar.name, sidecar.tupleDims, sidecar.componentDims, parentId, readMode, 0, sourceFormat);
+      return true;
+    case DataType::int64:
+      push_back<int64>(filename, sidecar.name, sidecar.tupleDims, sidecar.componentDims, parentId, readMode, 0, sourceFormat);
+      return true;
+    case DataType::uint64:
+      push_back<uint64>(filename, sidecar.name, sidecar.tupleDims, sidecar.componentDims, parentId, readMode, 0, sourceFormat);
+      return true;
+    case DataType::float32:
+      push_back<float32>(filename, sidecar.name, sidecar.tupleDims, sidecar.componentDims, parentId, readMode, 0, sourceFormat);
+      return true;
+    case DataType::float64:
+      push_back<float64>(filename, sidecar.name, sidecar.tupleDims, sidecar.componentDims, parentId, readMode, 0, sourceFormat);
+      return true;
+    default:
+      return false;
+    }
+  }
+
+  /**
+   * @brief Adds a DataArray whose values are only read from the file when they are first
+   * accessed (see ReadRawDataStoreDeferred()). Nothing is submitted to the thread pool.
+   * @param filename
+   * @param name Name of the DataArray that will be created
+   * @param numTuples
+   * @param numComponents
+   * @param parentId
+   * @param readMode How the file is read once the values are needed
+   * @param sourceFormat Type and byte order of the values in the file when they are not native endian T.
+   */
+  template <typename T>
+  void push_back_deferred(const std::filesystem::path& filename, const std::string& name, size_t numTuples, const std::vector<size_t>& numComponents, std::optional<DataObject::IdType> parentId,
+                          RawReadMode readMode = RawReadMode::Copy, std::optional<RawSourceFormat> sourceFormat = {})
+  {
+    if(m_LoggingEnabled)
+    {
+      std::cout << "  Deferring file " << filename.string() << std::endl;
+    }
+    std::shared_ptr<IDataStore<T>> dataStore = ReadRawDataStoreDeferred<T>(filename, numTuples, numComponents, readMode, sourceFormat);
+    if(nullptr == dataStore)
+    {
+      pushReady(FailedLoad());
+      return;
+    }
+    pushReady(MakeLoad<T>(dataStore, name, parentId, {}));
+  }
+
+  /**
+   * @brief Adds a DataArray that shares the values of an earlier load instead of reading
+   * its own file. Use it when the file's contents are known to be identical to that load's.
+   * Both arrays become copy-on-write, so modifying one never changes the other.
+   * @param sourceIndex Position of the earlier load, i.e. size() just before it was added
+   * @param name Name of the DataArray that will be created
+   * @param parentId
+   */
+  void push_back_duplicate(size_t sourceIndex, const std::string& name, std::optional<DataObject::IdType> parentId)
+  {
+    m_HasDuplicates[sourceIndex] = true;
+    std::shared_future<Load> source = m_Loads[sourceIndex];
+    Load load;
+    load.insert = [source, name, parentId](DataStructure& dataGraph, bool) -> DataObject* { return source.get().share(dataGraph, name, parentId); };
+    load.share = [source](DataStructure& dataGraph, const std::string& shareName, std::optional<DataObject::IdType> shareParentId) -> DataObject* {
+      return source.get().share(dataGraph, shareName, shareParentId);
+    };
+    pushReady(std::move(load));
+  }
+
+  /**
+   * @brief Waits for each load in turn and inserts it as soon as it and every load
+   * before it have finished. The scheduler is empty afterwards.
+   * @param dataGraph
+   * @return The created DataArrays in the order they were added. Failed loads are nullptr.
+   */
+  std::vector<DataObject*> insertInto(DataStructure& dataGraph)
+  {
+    std::vector<DataObject*> dataObjects;
+    dataObjects.reserve(m_Loads.size());
+    for(size_t i = 0; i < m_Loads.size(); i++)
+    {
+      const Load& load = m_Loads[i].get();
+      dataObjects.push_back(load.insert(dataGraph, m_HasDuplicates[i]));
+      if(nullptr != load.promote && nullptr != dataObjects.back())
+      {
+        m_Promotions.emplace_back(dataObjects.back()->getId(), load.promote);
+      }
+    }
+    m_Loads.clear();
+    m_HasDuplicates.clear();
+    return dataObjects;
+  }
+
+  /**
+   * @brief Reads the values of every metadata-only DataArray that insertInto() created, all
+   * at once on the thread pool. Statistics requested for those arrays are computed during the
+   * read and stored in their metadata like for an ordinary load.
+   * @param dataGraph The DataStructure insertInto() filled. A copy of it (e.g. one that was
+   * preflighted) does not share the arrays' stores and is not promoted.
+   * @return false if a file could not be read.
+   */
+  bool promote(DataStructure& dataGraph)
+  {
+    std::vector<std::future<bool>> promotions;
+    promotions.reserve(m_Promotions.size());
+    for(auto& [id, promoteFunc] : m_Promotions)
+    {
+      // An array that is gone (e.g. replaced by a filter) has nothing left to load
+      DataObject* dataObject = dataGraph.getData(id);
+      if(nullptr != dataObject)
+      {
+        promotions.push_back(m_ThreadPool.submit([dataObject, promoteFunc = std::move(promoteFunc)]() { return promoteFunc(*dataObject); }));
+      }
+    }
+    m_Promotions.clear();
+
+    bool success = true;
+    for(std::future<bool>& promotion : promotions)
+    {
+      success = promotion.get() && success;
+    }
+    return success;
+  }
+
+  size_t size() const
+  {
+    return m_Loads.size();
+  }
+
+  /**
+   * @brief Turns metadata-only mode on or off for later push_back() calls. It is off by default.
+   * @param metadataOnly
+   */
+  void setMetadataOnly(bool metadataOnly)
+  {
+    m_MetadataOnly = metadataOnly;
+  }
+
+  /**
+   * @brief Turns the per file "Reading file" messages on or off. They are on by default.
+   * @param enabled
+   */
+  void setLoggingEnabled(bool enabled)
+  {
+    m_LoggingEnabled = enabled;
+  }
+
+  bool isLoggingEnabled() const
+  {
+    return m_LoggingEnabled;
+  }
+
+  /**
+   * @brief Small arrays read by later push_back() calls are packed into this arena
+   * instead of getting a heap allocation each. Pass nullptr to stop using an arena.
+   * @param arena
+   */
+  void setArena(std::shared_ptr<StoreArena> arena)
+  {
+    m_Arena = std::move(arena);
+  }
+
+private:
+  /**
+   * @brief Loads the values of a metadata-only DataArray and stores its statistics in its metadata.
+   */
+  using PromoteFunction = std::function<bool(DataObject&)>;
+
+  struct Load
+  {
+    InsertFunction insert;
+    ShareFunction share;
+    PromoteFunction promote; // Only set for metadata-only loads
+  };
+
+  template <typename T>
+  void pushMetadataOnly(const std::filesystem::path& filename, const std::string& name, const std::vector<size_t>& tupleShape, const std::vector<size_t>& numComponents,
+                        std::optional<DataObject::IdType> parentId, RawReadMode readMode, size_t numHistogramBins, std::optional<RawSourceFormat> sourceFormat)
+  {
+    if(m_LoggingEnabled)
+    {
+      std::cout << "  Describing file " << filename.string() << std::endl;
+    }
+    const size_t numValues = std::accumulate(tupleShape.begin(), tupleShape.end(), static_cast<size_t>(1), std::multiplies<>()) *
+                             std::accumulate(numComponents.begin(), numComponents.end(), static_cast<size_t>(1), std::multiplies<>());
+    if(!CheckRawFileSize<T>(filename, numValues, sourceFormat))
+    {
+      pushReady(FailedLoad());
+      return;
+    }
+
+    // Written by the loader, which runs at most once, before store() returns
+    auto statistics = std::make_shared<std::optional<ArrayStatistics>>();
+    auto dataStore = std::make_shared<LazyDataStore<T>>(tupleShape, numComponents, [=, arena = m_Arena]() -> std::shared_ptr<IDataStore<T>> {
+      std::optional<StatisticsSink<T>> statisticsSink;
+      if(numHistogramBins > 0)
+      {
+        statisticsSink.emplace(numHistogramBins);
+      }
+      std::shared_ptr<IDataStore<T>> loadedStore = ReadRawDataStore<T>(filename, tupleShape, numComponents, readMode, statisticsSink.has_value() ? &(*statisticsSink) : nullptr, sourceFormat, arena);
+      if(nullptr != loadedStore && statisticsSink.has_value())
+      {
+        *statistics = statisticsSink->finish();
+      }
+      return loadedStore;
+    });
+
+    Load load = MakeLoad<T>(dataStore, name, parentId, {});
+    load.promote = [dataStore, statistics](DataObject& dataObject) -> bool {
+      try
+      {
+        dataStore->store();
+      } catch(const std::runtime_error& exception)
+      {
+        std::cout << exception.what() << ": '" << dataObject.getName() << "'" << std::endl;
+        return false;
+      }
+      if(statistics->has_value())
+      {
+        dataObject.getMetadata().setData(k_StatisticsMetadataKey, std::any(**statistics));
+      }
+      return true;
+    };
+    pushReady(std::move(load));
+  }
+
+  template <typename T>
+  static Load MakeLoad(std::shared_ptr<IDataStore<T>> dataStore, const std::string& name, std::optional<DataObject::IdType> parentId, std::optional<ArrayStatistics> statistics)
+  {
+    Load load;
+    auto group = std::make_shared<SharedStoreGroup>();
+    load.insert = [=](DataStructure& dataGraph, bool shareable) -> DataObject* {
+      std::shared_ptr<IDataStore<T>> arrayStore = dataStore;
+      if(shareable)
+      {
+        arrayStore = std::make_shared<SharedDataStore<T>>(dataStore, group, false);
+      }
+      DataArray<T>* dataArray = DataArray<T>::Create(dataGraph, name, arrayStore, parentId);
+      if(nullptr != dataArray && statistics.has_value())
+      {
+        dataArray->getMetadata().setData(k_StatisticsMetadataKey, std::any(*statistics));
+      }
+      return dataArray;
+    };
+    load.share = [dataStore, group](DataStructure& dataGraph, const std::string& shareName, std::optional<DataObject::IdType> shareParentId) -> DataObject* {
+      return DataArray<T>::Create(dataGraph, shareName, std::make_shared<SharedDataStore<T>>(dataStore, group, true), shareParentId);
+    };
+    return load;
+  }
+
+  static Load FailedLoad()
+  {
+    Load load;
+    load.insert = [](DataStructure&, bool) -> DataObject* { return nullptr; };
+    load.share = [](DataStructure&, const std::string&, std::optional<DataObject::IdType>) -> DataObject* { return nullptr; };
+    return load;
+  }
+
+  void pushReady(Load load)
+  {
+    std::promise<Load> promise;
+    promise.set_value(std::move(load));
+    m_HasDuplicates.push_back(false);
+    m_Loads.push_back(promise.get_future().share());
+  }
+
+  ThreadPool& m_ThreadPool;
+  std::vector<std::shared_future<Load>> m_Loads;
+  std::vector<bool> m_HasDuplicates;
+  std::vector<std::pair<DataObject::IdType, PromoteFunction>> m_Promotions;
+  bool m_MetadataOnly = false;
+  bool m_LoggingEnabled = true;
+  std::shared_ptr<StoreArena> m_Arena;
+};
+} // namespace complex
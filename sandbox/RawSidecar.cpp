@@ -0,0 +1,212 @@
+#include "RawSidecar.hpp"
+
+#include "RawByteSource.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <numeric>
+#include <utility>
+
+namespace fs = std::filesystem;
+
+namespace complex
+{
+namespace
+{
+const std::array<std::pair<const char*, DataType>, 10> k_DataTypeNames = {{{"int8", DataType::int8},
+                                                                          {"uint8", DataType::uint8},
+                                                                          {"int16", DataType::int16},
+                                                                          {"uint16", DataType::uint16},
+                                                                          {"int32", DataType::int32},
+                                                                          {"uint32", DataType::uint32},
+                                                                          {"int64", DataType::int64},
+                                                                          {"uint64", DataType::uint64},
+                                                                          {"float32", DataType::float32},
+                                                                          {"float64", DataType::float64}}};
+
+std::optional<DataType> DataTypeFromString(const std::string& typeName)
+{
+  for(const auto& [name, dataType] : k_DataTypeNames)
+  {
+    if(typeName == name)
+    {
+      return dataType;
+    }
+  }
+  return {};
+}
+
+const char* DataTypeToString(DataType dataType)
+{
+  for(const auto& [name, nameType] : k_DataTypeNames)
+  {
+    if(dataType == nameType)
+    {
+      return name;
+    }
+  }
+  return "";
+}
+
+/**
+ * @brief Strips a '.gz' or '.zst' extension so both '<name>.raw' and '<name>.raw.gz' share '<name>.raw.json'.
+ */
+fs::path UncompressedPath(const fs::path& rawFilePath)
+{
+  if(RawByteSource::CompressionFromPath(rawFilePath) != RawByteSource::Compression::None)
+  {
+    return fs::path(rawFilePath).replace_extension();
+  }
+  return rawFilePath;
+}
+} // namespace
+
+// -----------------------------------------------------------------------------
+fs::path RawSidecar::PathFor(const fs::path& rawFilePath)
+{
+  fs::path sidecarPath = UncompressedPath(rawFilePath);
+  sidecarPath += k_Extension;
+  return sidecarPath;
+}
+
+// -----------------------------------------------------------------------------
+bool RawSidecar::IsSidecar(const fs::path& filePath)
+{
+  if(filePath.extension() != k_Extension)
+  {
+    return false;
+  }
+  const fs::path rawFilePath = RawByteSource::Resolve(fs::path(filePath).replace_extension());
+  std::error_code errorCode;
+  const uintmax_t rawFileSize = fs::file_size(rawFilePath, errorCode);
+  if(errorCode)
+  {
+    return false;
+  }
+  // A sidecar that does not describe its raw file is ingested like any other file
+  return Read(rawFilePath, static_cast<size_t>(rawFileSize)).has_value();
+}
+
+// -----------------------------------------------------------------------------
+std::optional<RawSidecar> RawSidecar::Read(const fs::path& rawFilePath, size_t rawFileSize)
+{
+  const fs::path sidecarPath = PathFor(rawFilePath);
+  std::ifstream inputFile(sidecarPath);
+  if(!inputFile.is_open())
+  {
+    return {};
+  }
+
+  RawSidecar sidecar;
+  try
+  {
+    nlohmann::json rootJson = nlohmann::json::parse(inputFile);
+
+    std::optional<DataType> dataType = DataTypeFromString(rootJson.at("dtype").get<std::string>());
+    if(!dataType.has_value())
+    {
+      std::cout << "Unknown dtype '" << rootJson["dtype"].get<std::string>() << "' in " << sidecarPath.string() << std::endl;
+      return {};
+    }
+    sidecar.dataType = *dataType;
+
+    if(rootJson.contains("byte_order"))
+    {
+      const std::string byteOrder = rootJson["byte_order"].get<std::string>();
+      if(byteOrder != "little" && byteOrder != "big")
+      {
+        std::cout << "byte_order must be 'little' or 'big' in " << sidecarPath.string() << std::endl;
+        return {};
+      }
+      sidecar.byteOrder = (byteOrder == "big") ? Endian::Big : Endian::Little;
+    }
+    if(rootJson.contains("component_dims"))
+    {
+      sidecar.componentDims = rootJson["component_dims"].get<std::vector<size_t>>();
+    }
+    if(rootJson.contains("tuple_dims"))
+    {
+      sidecar.tupleDims = rootJson["tuple_dims"].get<std::vector<size_t>>();
+    }
+    if(rootJson.contains("name"))
+    {
+      sidecar.name = rootJson["name"].get<std::string>();
+    }
+  } catch(const nlohmann::json::exception& exception)
+  {
+    std::cout << "Error parsing " << sidecarPath.string() << ": " << exception.what() << std::endl;
+    return {};
+  }
+
+  const size_t numComponents = std::accumulate(sidecar.componentDims.begin(), sidecar.componentDims.end(), static_cast<size_t>(1), std::multiplies<>());
+  if(numComponents == 0)
+  {
+    std::cout << "component_dims may not contain a zero in " << sidecarPath.string() << std::endl;
+    return {};
+  }
+  // The size of a compressed file says nothing about how many values it holds
+  const bool isCompressed = RawByteSource::CompressionFromPath(rawFilePath) != RawByteSource::Compression::None;
+  if(sidecar.tupleDims.empty())
+  {
+    if(isCompressed)
+    {
+      std::cout << "tuple_dims are required for compressed files in " << sidecarPath.string() << std::endl;
+      return {};
+    }
+    sidecar.tupleDims = {rawFileSize / (GetDataTypeSize(sidecar.dataType) * numComponents)};
+  }
+  if(!isCompressed)
+  {
+    const size_t expectedSize = sidecar.getNumberOfTuples() * numComponents * GetDataTypeSize(sidecar.dataType);
+    if(expectedSize != rawFileSize)
+    {
+      std::cout << sidecarPath.string() << " describes " << expectedSize << " bytes but " << rawFilePath.string() << " holds " << rawFileSize << std::endl;
+      return {};
+    }
+  }
+  if(sidecar.name.empty())
+  {
+    sidecar.name = rawFilePath.filename().string();
+  }
+  sidecar.compressed = isCompressed;
+  return sidecar;
+}
+
+// -----------------------------------------------------------------------------
+bool RawSidecar::write(const fs::path& rawFilePath) const
+{
+  nlohmann::json rootJson;
+  rootJson["dtype"] = DataTypeToString(dataType);
+  rootJson["tuple_dims"] = tupleDims;
+  rootJson["component_dims"] = componentDims;
+  rootJson["byte_order"] = (byteOrder == Endian::Big) ? "big" : "little";
+  rootJson["name"] = name;
+
+  const fs::path sidecarPath = PathFor(rawFilePath);
+  std::ofstream outputFile(sidecarPath, std::ios::out | std::ios::trunc);
+  outputFile << rootJson.dump(2);
+  if(!outputFile.good())
+  {
+    std::cout << "Error writing " << sidecarPath.string() << std::endl;
+    return false;
+  }
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+size_t RawSidecar::getNumberOfTuples() const
+{
+  return std::accumulate(tupleDims.begin(), tupleDims.end(), static_cast<size_t>(1), std::multiplies<>());
+}
+
+// -----------------------------------------------------------------------------
+RawSourceFormat RawSidecar::getSourceFormat() const
+{
+  return {dataType, byteOrder, compressed};
+}
+} // namespace complex
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "ConversionKernels.hpp"
+
+#include "complex/Common/Types.hpp"
+
+#include <cstddef>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace complex
+{
+/**
+ * @brief Describes the contents of a raw file. It is read from a small JSON file that
+ * sits next to the raw file ('<name>.raw' -> '<name>.raw.json'), for example:
+ *
+ *   {
+ *     "dtype": "float32",
+ *     "tuple_dims": [117, 201, 189],
+ *     "component_dims": [3],
+ *     "byte_order": "big",
+ *     "name": "Confidence Index"
+ *   }
+ *
+ * Only "dtype" is required. "tuple_dims" defaults to however many tuples fit in the file,
+ * "component_dims" to [1], "byte_order" to "little" and "name" to the file name. The dims
+ * must account for every byte of an uncompressed file; otherwise it is ingested as bytes.
+ * A compressed file ('<name>.raw.gz' or '<name>.raw.zst') uses the same '<name>.raw.json',
+ * which is what opts it into being decompressed; files without a sidecar are read as bytes.
+ */
+struct RawSidecar
+{
+  static inline constexpr const char* k_Extension = ".json";
+
+  DataType dataType = DataType::uint8;
+  Endian byteOrder = Endian::Little;
+  std::vector<size_t> tupleDims;
+  std::vector<size_t> componentDims = {1};
+  std::string name;
+  bool compressed = false; // Set by Read() for a '.gz' or '.zst' raw file; not stored in the sidecar
+
+  /**
+   * @brief Returns the path of the sidecar that describes the raw file. The file may not exist.
+   * @param rawFilePath
+   * @return
+   */
+  static std::filesystem::path PathFor(const std::filesystem::path& rawFilePath);
+
+  /**
+   * @brief Returns true if the file is a sidecar that can be read and fits the size of the raw
+   * file next to it.
+   * @param filePath
+   * @return
+   */
+  static bool IsSidecar(const std::filesystem::path& filePath);
+
+  /**
+   * @brief Reads the sidecar that describes the raw file.
+   * @param rawFilePath Path of the raw file, NOT of the sidecar
+   * @param rawFileSize Size of the raw file in bytes. Used when the sidecar does not give the tuple dims.
+   * @return Empty if there is no sidecar, it can not be parsed or its dims do not match the size
+   * of an uncompressed raw file. Errors are printed.
+   */
+  static std::optional<RawSidecar> Read(const std::filesystem::path& rawFilePath, size_t rawFileSize);
+
+  /**
+   * @brief Writes this sidecar next to the raw file, with every field spelled out.
+   * @param rawFilePath Path of the raw file, NOT of the sidecar
+   * @return false if the sidecar could not be written. The error is printed.
+   */
+  bool write(const std::filesystem::path& rawFilePath) const;
+
+  size_t getNumberOfTuples() const;
+
+  RawSourceFormat getSourceFormat() const;
+};
+} // namespace complex
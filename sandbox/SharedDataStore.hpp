@@ -0,0 +1,214 @@
+#pragma once
+
+#include "complex/DataStructure/IDataStore.hpp"
+
+#include <nonstd/span.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace complex
+{
+/**
+ * @brief State shared by the store that writes the values and every store created as a link to it.
+ */
+struct SharedStoreGroup
+{
+  /** Set once the store that writes the values has made its own copy, so its dataset no longer holds the shared values. */
+  std::atomic<bool> ownerDetached = false;
+};
+
+/**
+ * @class SharedStoreLinkScope
+ * @brief Stores created as links only write placeholders on a thread that holds one of
+ * these, i.e. while a caller that runs LinkH5Dataset() over the file afterwards is writing
+ * it. Every other writer (checkpoints, caches, async writers) gets the values.
+ */
+class SharedStoreLinkScope
+{
+public:
+  SharedStoreLinkScope()
+  {
+    s_Depth++;
+  }
+
+  ~SharedStoreLinkScope() noexcept
+  {
+    s_Depth--;
+  }
+
+  SharedStoreLinkScope(const SharedStoreLinkScope&) = delete;
+  SharedStoreLinkScope(SharedStoreLinkScope&&) noexcept = delete;
+  SharedStoreLinkScope& operator=(const SharedStoreLinkScope&) = delete;
+  SharedStoreLinkScope& operator=(SharedStoreLinkScope&&) noexcept = delete;
+
+  static bool IsActive()
+  {
+    return s_Depth > 0;
+  }
+
+private:
+  static inline thread_local int32_t s_Depth = 0;
+};
+
+/**
+ * @class SharedDataStore
+ * @brief Lets several DataArrays with byte-identical contents share one underlying store.
+ * Each array gets its own SharedDataStore; they all point at the same inner store until
+ * one of them is modified, at which point that one makes a private copy first
+ * (copy-on-write), so a modification never leaks into the other arrays.
+ *
+ * Inside a SharedStoreLinkScope, a store created as a link writes an empty placeholder
+ * dataset from writeHdf5() instead of the values, as long as neither it nor the store that
+ * writes the values has been modified (see isLink()). LinkH5Dataset() then replaces the
+ * placeholder with a hard link to the dataset of the array that did write the values, so
+ * the values are stored in the HDF5 file only once.
+ */
+template <typename T>
+class SharedDataStore : public IDataStore<T>
+{
+public:
+  using value_type = T;
+  using reference = T&;
+  using const_reference = const T&;
+  using ShapeType = typename IDataStore<T>::ShapeType;
+
+  /**
+   * @param store The shared values
+   * @param group Shared by every store created for the same values
+   * @param writeAsLink True for every array except the one whose dataset the others link to
+   */
+  SharedDataStore(std::shared_ptr<IDataStore<T>> store, std::shared_ptr<SharedStoreGroup> group, bool writeAsLink)
+  : m_Store(std::move(store))
+  , m_Group(std::move(group))
+  , m_WriteAsLink(writeAsLink)
+  {
+  }
+
+  ~SharedDataStore() override = default;
+
+  SharedDataStore(const SharedDataStore&) = delete;
+  SharedDataStore(SharedDataStore&&) noexcept = delete;
+  SharedDataStore& operator=(const SharedDataStore&) = delete;
+  SharedDataStore& operator=(SharedDataStore&&) noexcept = delete;
+
+  usize getNumberOfTuples() const override
+  {
+    return m_Store->getNumberOfTuples();
+  }
+
+  const ShapeType& getTupleShape() const override
+  {
+    return m_Store->getTupleShape();
+  }
+
+  usize getNumberOfComponents() const override
+  {
+    return m_Store->getNumberOfComponents();
+  }
+
+  const ShapeType& getComponentShape() const override
+  {
+    return m_Store->getComponentShape();
+  }
+
+  void reshapeTuples(const ShapeType& tupleShape) override
+  {
+    detach();
+    m_Store->reshapeTuples(tupleShape);
+  }
+
+  value_type getValue(usize index) const override
+  {
+    return m_Store->getValue(index);
+  }
+
+  void setValue(usize index, value_type value) override
+  {
+    detach();
+    m_Store->setValue(index, value);
+  }
+
+  const_reference at(usize index) const override
+  {
+    return static_cast<const IDataStore<T>&>(*m_Store).at(index);
+  }
+
+  const_reference operator[](usize index) const override
+  {
+    return static_cast<const IDataStore<T>&>(*m_Store)[index];
+  }
+
+  reference operator[](usize index) override
+  {
+    detach();
+    return (*m_Store)[index];
+  }
+
+  DataType getDataType() const override
+  {
+    return GetDataType<T>();
+  }
+
+  /**
+   * @brief The copy is an ordinary private store.
+   * @return
+   */
+  std::unique_ptr<IDataStore<T>> deepCopy() const override
+  {
+    return m_Store->deepCopy();
+  }
+
+  H5::ErrorType writeHdf5(H5::DatasetWriter& datasetWriter) const override
+  {
+    if(isLink() && SharedStoreLinkScope::IsActive())
+    {
+      return datasetWriter.writeSpan(H5::DatasetWriter::DimsType{0}, nonstd::span<const T>(static_cast<const T*>(nullptr), 0));
+    }
+    return m_Store->writeHdf5(datasetWriter);
+  }
+
+  /**
+   * @brief Returns true if writeHdf5() writes a placeholder (inside a SharedStoreLinkScope)
+   * that is meant to become a link: this store was created as a link and both it and the
+   * store that writes the values still hold the shared values.
+   * @return
+   */
+  bool isLink() const
+  {
+    return m_WriteAsLink && !m_Detached && !m_Group->ownerDetached;
+  }
+
+  /**
+   * @brief Returns true once this store has made its own copy of the values.
+   * @return
+   */
+  bool isDetached() const
+  {
+    return m_Detached;
+  }
+
+private:
+  void detach()
+  {
+    if(m_Detached)
+    {
+      return;
+    }
+    if(!m_WriteAsLink)
+    {
+      // The links can no longer point at this store's dataset
+      m_Group->ownerDetached = true;
+    }
+    m_Store = std::shared_ptr<IDataStore<T>>(m_Store->deepCopy());
+    m_Detached = true;
+  }
+
+  std::shared_ptr<IDataStore<T>> m_Store;
+  std::shared_ptr<SharedStoreGroup> m_Group;
+  bool m_WriteAsLink = false;
+  bool m_Detached = false;
+};
+} // namespace complex
@@ -7,15 +7,148 @@ configure_file("${sandbox_SOURCE_DIR}/sandbox/sandbox_test_dirs.h.in"
         ${SANDBOX_TEST_DIRS_HEADER}
         @ONLY)
 
+#------------------------------------------------------------------------------
+# Data ingestion code that is shared by the sandbox and the benchmarks
+#------------------------------------------------------------------------------
+set(SandboxIO_SOURCES
+  ${sandbox_SOURCE_DIR}/sandbox/ArenaDataStore.hpp
+  ${sandbox_SOURCE_DIR}/sandbox/AsyncH5Writer.hpp
+  ${sandbox_SOURCE_DIR}/sandbox/AsyncH5Writer.cpp
+  ${sandbox_SOURCE_DIR}/sandbox/ArrayStatistics.hpp
+  ${sandbox_SOURCE_DIR}/sandbox/ComplexCoreFilterHandles.hpp
+  ${sandbox_SOURCE_DIR}/sandbox/ContentHash.hpp
+  ${sandbox_SOURCE_DIR}/sandbox/ContentHash.cpp
+  ${sandbox_SOURCE_DIR}/sandbox/ConversionKernels.hpp
+  ${sandbox_SOURCE_DIR}/sandbox/DataStructureDelta.hpp
+  ${sandbox_SOURCE_DIR}/sandbox/DataStructureDelta.cpp
+  ${sandbox_SOURCE_DIR}/sandbox/DataStructureHash.hpp
+  ${sandbox_SOURCE_DIR}/sandbox/DataStructureHash.cpp
+  ${sandbox_SOURCE_DIR}/sandbox/FilterResultCache.hpp
+  ${sandbox_SOURCE_DIR}/sandbox/FilterResultCache.cpp
+  ${sandbox_SOURCE_DIR}/sandbox/H5DataStructureWriter.hpp
+  ${sandbox_SOURCE_DIR}/sandbox/H5DataStructureWriter.cpp
+  ${sandbox_SOURCE_DIR}/sandbox/H5DatasetUpdate.hpp
+  ${sandbox_SOURCE_DIR}/sandbox/H5DatasetUpdate.cpp
+  ${sandbox_SOURCE_DIR}/sandbox/H5LazyReader.hpp
+  ${sandbox_SOURCE_DIR}/sandbox/H5LazyReader.cpp
+  ${sandbox_SOURCE_DIR}/sandbox/H5SubvolumeReader.hpp
+  ${sandbox_SOURCE_DIR}/sandbox/H5SubvolumeReader.cpp
+  ${sandbox_SOURCE_DIR}/sandbox/H5Types.hpp
+  ${sandbox_SOURCE_DIR}/sandbox/H5Types.cpp
+  ${sandbox_SOURCE_DIR}/sandbox/IngestManifest.hpp
+  ${sandbox_SOURCE_DIR}/sandbox/IngestManifest.cpp
+  ${sandbox_SOURCE_DIR}/sandbox/LazyDataStore.hpp
+  ${sandbox_SOURCE_DIR}/sandbox/MappedFile.hpp
+  ${sandbox_SOURCE_DIR}/sandbox/MappedFile.cpp
+  ${sandbox_SOURCE_DIR}/sandbox/MmapDataStore.hpp
+  ${sandbox_SOURCE_DIR}/sandbox/ParallelPipelineExecutor.hpp
+  ${sandbox_SOURCE_DIR}/sandbox/ParallelPipelineExecutor.cpp
+  ${sandbox_SOURCE_DIR}/sandbox/PipelineBatchRunner.hpp
+  ${sandbox_SOURCE_DIR}/sandbox/PipelineBatchRunner.cpp
+  ${sandbox_SOURCE_DIR}/sandbox/PipelineCheckpoint.hpp
+  ${sandbox_SOURCE_DIR}/sandbox/PipelineCheckpoint.cpp
+  ${sandbox_SOURCE_DIR}/sandbox/PipelineLiveness.hpp
+  ${sandbox_SOURCE_DIR}/sandbox/PipelineLiveness.cpp
+  ${sandbox_SOURCE_DIR}/sandbox/PipelineTrace.hpp
+  ${sandbox_SOURCE_DIR}/sandbox/PipelineTrace.cpp
+  ${sandbox_SOURCE_DIR}/sandbox/RawByteSource.hpp
+  ${sandbox_SOURCE_DIR}/sandbox/RawByteSource.cpp
+  ${sandbox_SOURCE_DIR}/sandbox/RawFileReader.hpp
+  ${sandbox_SOURCE_DIR}/sandbox/RawIngestScheduler.hpp
+  ${sandbox_SOURCE_DIR}/sandbox/RawSidecar.hpp
+  ${sandbox_SOURCE_DIR}/sandbox/RawSidecar.cpp
+  ${sandbox_SOURCE_DIR}/sandbox/SharedDataStore.hpp
+  ${sandbox_SOURCE_DIR}/sandbox/StoreArena.hpp
+  ${sandbox_SOURCE_DIR}/sandbox/StoreArena.cpp
+  ${sandbox_SOURCE_DIR}/sandbox/ThreadPool.hpp
+  ${sandbox_SOURCE_DIR}/sandbox/ThreadPool.cpp
+  ${sandbox_SOURCE_DIR}/sandbox/TileCache.hpp
+  ${sandbox_SOURCE_DIR}/sandbox/TileCache.cpp
+  ${sandbox_SOURCE_DIR}/sandbox/TiledDataStore.hpp
+)
+add_library(SandboxIO STATIC ${SandboxIO_SOURCES})
+target_include_directories(SandboxIO PUBLIC ${sandbox_SOURCE_DIR}/sandbox)
+find_package(Threads REQUIRED)
+find_package(nlohmann_json CONFIG REQUIRED)
+target_link_libraries(SandboxIO PUBLIC complex::complex Threads::Threads)
+target_link_libraries(SandboxIO PRIVATE nlohmann_json::nlohmann_json)
+
+# Compressed raw inputs (.raw.gz / .raw.zst) are only readable when the codec is available
+find_package(ZLIB)
+if(ZLIB_FOUND)
+  target_compile_definitions(SandboxIO PRIVATE SANDBOX_ENABLE_ZLIB)
+  target_link_libraries(SandboxIO PRIVATE ZLIB::ZLIB)
+endif()
+find_package(zstd CONFIG)
+if(TARGET zstd::libzstd_shared)
+  target_compile_definitions(SandboxIO PRIVATE SANDBOX_ENABLE_ZSTD)
+  target_link_libraries(SandboxIO PRIVATE zstd::libzstd_shared)
+elseif(TARGET zstd::libzstd_static)
+  target_compile_definitions(SandboxIO PRIVATE SANDBOX_ENABLE_ZSTD)
+  target_link_libraries(SandboxIO PRIVATE zstd::libzstd_static)
+endif()
+
 #------------------------------------------------------------------------------
 #
 #------------------------------------------------------------------------------
 add_executable(sandbox ${sandbox_SOURCE_DIR}/sandbox/sandbox.cpp ${SANDBOX_TEST_DIRS_HEADER})
 target_include_directories(sandbox PUBLIC ${ComplexCore_SOURCE_DIR}/src)
 target_include_directories(sandbox PRIVATE ${sandbox_BINARY_DIR})
-target_link_libraries(sandbox complex::complex complex::ComplexCore)
+target_link_libraries(sandbox complex::complex complex::ComplexCore SandboxIO)
+
+#------------------------------------------------------------------------------
+# Fused vs. two pass endian/type conversion of raw files
+#------------------------------------------------------------------------------
+add_executable(raw_conversion_benchmark ${sandbox_SOURCE_DIR}/sandbox/raw_conversion_benchmark.cpp ${SANDBOX_TEST_DIRS_HEADER})
+target_include_directories(raw_conversion_benchmark PRIVATE ${sandbox_BINARY_DIR})
+target_link_libraries(raw_conversion_benchmark SandboxIO)
+
+#------------------------------------------------------------------------------
+# One heap allocation per small array vs. packing them into a StoreArena
+#------------------------------------------------------------------------------
+add_executable(arena_benchmark ${sandbox_SOURCE_DIR}/sandbox/arena_benchmark.cpp ${SANDBOX_TEST_DIRS_HEADER})
+target_include_directories(arena_benchmark PRIVATE ${sandbox_BINARY_DIR})
+target_link_libraries(arena_benchmark SandboxIO)
 
+#------------------------------------------------------------------------------
+# DataStructure HDF5 write/read throughput across grid sizes and layouts
+#------------------------------------------------------------------------------
+add_executable(h5_roundtrip_benchmark ${sandbox_SOURCE_DIR}/sandbox/h5_roundtrip_benchmark.cpp ${SANDBOX_TEST_DIRS_HEADER})
+target_include_directories(h5_roundtrip_benchmark PRIVATE ${sandbox_BINARY_DIR})
+target_link_libraries(h5_roundtrip_benchmark SandboxIO nlohmann_json::nlohmann_json)
 
+#------------------------------------------------------------------------------
+# Chunked and compressed HDF5 writes read back with their array shapes
+#------------------------------------------------------------------------------
+add_executable(h5_chunked_roundtrip_test ${sandbox_SOURCE_DIR}/sandbox/h5_chunked_roundtrip_test.cpp ${SANDBOX_TEST_DIRS_HEADER})
+target_include_directories(h5_chunked_roundtrip_test PRIVATE ${sandbox_BINARY_DIR})
+target_link_libraries(h5_chunked_roundtrip_test SandboxIO)
+add_test(NAME h5_chunked_roundtrip_test COMMAND h5_chunked_roundtrip_test)
+
+#------------------------------------------------------------------------------
+# Concurrent reads and writes of a TiledDataStore through a small TileCache
+#------------------------------------------------------------------------------
+add_executable(tiled_store_test ${sandbox_SOURCE_DIR}/sandbox/tiled_store_test.cpp ${SANDBOX_TEST_DIRS_HEADER})
+target_include_directories(tiled_store_test PRIVATE ${sandbox_BINARY_DIR})
+target_link_libraries(tiled_store_test SandboxIO)
+add_test(NAME tiled_store_test COMMAND tiled_store_test)
+
+#------------------------------------------------------------------------------
+# ParallelPipelineExecutor gives the same DataStructure as executing one filter after another
+#------------------------------------------------------------------------------
+add_executable(parallel_executor_test ${sandbox_SOURCE_DIR}/sandbox/parallel_executor_test.cpp ${SANDBOX_TEST_DIRS_HEADER})
+target_include_directories(parallel_executor_test PRIVATE ${sandbox_BINARY_DIR})
+target_link_libraries(parallel_executor_test complex::complex complex::ComplexCore SandboxIO)
+add_test(NAME parallel_executor_test COMMAND parallel_executor_test)
+
+#------------------------------------------------------------------------------
+# A generated ITK filter executed in place gives the same output as out of place
+#------------------------------------------------------------------------------
+add_executable(inplace_filter_test ${sandbox_SOURCE_DIR}/sandbox/inplace_filter_test.cpp ${SANDBOX_TEST_DIRS_HEADER})
+target_include_directories(inplace_filter_test PRIVATE ${sandbox_BINARY_DIR})
+target_link_libraries(inplace_filter_test complex::complex SandboxIO)
+add_test(NAME inplace_filter_test COMMAND inplace_filter_test)
+set_tests_properties(inplace_filter_test PROPERTIES SKIP_RETURN_CODE 77)
 
 #------------------------------------------------------------------------------
 #
@@ -23,7 +156,7 @@ target_link_libraries(sandbox complex::complex complex::ComplexCore)
 if(0)
 add_executable(datastructure_test ${sandbox_SOURCE_DIR}/sandbox/datastructure_test.cpp ${SANDBOX_TEST_DIRS_HEADER})
 target_include_directories(datastructure_test PUBLIC ${ComplexCore_SOURCE_DIR}/src)
-target_link_libraries(datastructure_test complex::complex complex::ComplexCore)
+target_link_libraries(datastructure_test complex::complex complex::ComplexCore SandboxIO)
 target_include_directories(datastructure_test PRIVATE ${sandbox_BINARY_DIR})
 endif()
 
@@ -0,0 +1,88 @@
+#include "StoreArena.hpp"
+
+#include <algorithm>
+
+namespace complex
+{
+namespace
+{
+constexpr size_t k_SlabFraction = 16;
+
+size_t AlignUp(size_t value, size_t alignment)
+{
+  return (value + alignment - 1) / alignment * alignment;
+}
+} // namespace
+
+// -----------------------------------------------------------------------------
+StoreArena::StoreArena(size_t slabSize)
+: m_SlabSize(std::max(AlignUp(slabSize, k_Alignment), k_Alignment * k_SlabFraction))
+, m_MaxAllocation(m_SlabSize / k_SlabFraction)
+{
+}
+
+// -----------------------------------------------------------------------------
+StoreArena::~StoreArena() noexcept = default;
+
+// -----------------------------------------------------------------------------
+bool StoreArena::accepts(size_t numBytes) const
+{
+  return numBytes <= m_MaxAllocation;
+}
+
+// -----------------------------------------------------------------------------
+std::byte* StoreArena::allocate(size_t numBytes)
+{
+  if(!accepts(numBytes))
+  {
+    return nullptr;
+  }
+  // Zero sized arrays still get a unique, valid address
+  const size_t alignedBytes = AlignUp(std::max(numBytes, static_cast<size_t>(1)), k_Alignment);
+
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  if(m_Slabs.empty() || m_Slabs.back().used + alignedBytes > m_SlabSize)
+  {
+    // Over-allocate by one alignment so the usable part can start on an aligned address. The memory is
+    // deliberately left uninitialized so the pages are only committed as they are filled.
+    Slab slab;
+    slab.buffer = std::unique_ptr<std::byte[]>(new std::byte[m_SlabSize + k_Alignment]);
+    const auto address = reinterpret_cast<std::uintptr_t>(slab.buffer.get());
+    slab.begin = slab.buffer.get() + (AlignUp(address, k_Alignment) - address);
+    m_Slabs.push_back(std::move(slab));
+  }
+  Slab& slab = m_Slabs.back();
+  std::byte* memory = slab.begin + slab.used;
+  slab.used += alignedBytes;
+  m_AllocationCount++;
+  m_BytesAllocated += numBytes;
+  return memory;
+}
+
+// -----------------------------------------------------------------------------
+size_t StoreArena::getSlabSize() const
+{
+  return m_SlabSize;
+}
+
+// -----------------------------------------------------------------------------
+size_t StoreArena::getSlabCount() const
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_Slabs.size();
+}
+
+// -----------------------------------------------------------------------------
+size_t StoreArena::getAllocationCount() const
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_AllocationCount;
+}
+
+// -----------------------------------------------------------------------------
+size_t StoreArena::getBytesAllocated() const
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_BytesAllocated;
+}
+} // namespace complex
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace complex
+{
+/**
+ * @class StoreArena
+ * @brief Hands out memory for many small DataStores from a few large slabs instead of
+ * one heap allocation each. Nothing is freed individually; every slab is released at once
+ * when the arena is destroyed. ArenaDataStore keeps its arena alive, so the slabs go away
+ * together with the last array that uses them (normally when the DataStructure is destroyed).
+ *
+ * allocate() may be called from several threads at once.
+ */
+class StoreArena
+{
+public:
+  static constexpr size_t k_DefaultSlabSize = 64 * 1024 * 1024;
+  static constexpr size_t k_Alignment = 64;
+
+  /**
+   * @param slabSize Bytes per slab. Allocations larger than a sixteenth of this are refused
+   * so a single large array can not leave most of a slab unused.
+   */
+  explicit StoreArena(size_t slabSize = k_DefaultSlabSize);
+  ~StoreArena() noexcept;
+
+  StoreArena(const StoreArena&) = delete;
+  StoreArena(StoreArena&&) noexcept = delete;
+  StoreArena& operator=(const StoreArena&) = delete;
+  StoreArena& operator=(StoreArena&&) noexcept = delete;
+
+  /**
+   * @brief Returns true if an allocation of this size would be served by the arena.
+   * @param numBytes
+   * @return
+   */
+  bool accepts(size_t numBytes) const;
+
+  /**
+   * @brief Returns k_Alignment aligned, uninitialized memory that stays valid for the lifetime of the arena.
+   * @param numBytes
+   * @return nullptr if accepts(numBytes) is false.
+   */
+  std::byte* allocate(size_t numBytes);
+
+  size_t getSlabSize() const;
+  size_t getSlabCount() const;
+  size_t getAllocationCount() const;
+  size_t getBytesAllocated() const;
+
+private:
+  struct Slab
+  {
+    std::unique_ptr<std::byte[]> buffer;
+    std::byte* begin = nullptr; // First aligned byte
+    size_t used = 0;
+  };
+
+  size_t m_SlabSize = 0;
+  size_t m_MaxAllocation = 0;
+  mutable std::mutex m_Mutex;
+  std::vector<Slab> m_Slabs;
+  size_t m_AllocationCount = 0;
+  size_t m_BytesAllocated = 0;
+};
+} // namespace complex
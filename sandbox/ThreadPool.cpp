@@ -0,0 +1,136 @@
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+
+namespace complex
+{
+namespace
+{
+// Identifies the pool and queue of the current thread so tasks that submit more tasks keep them local
+thread_local const ThreadPool* t_CurrentPool = nullptr;
+thread_local size_t t_CurrentWorker = 0;
+} // namespace
+
+// -----------------------------------------------------------------------------
+ThreadPool::ThreadPool(size_t numThreads)
+{
+  if(numThreads == 0)
+  {
+    numThreads = std::max(1U, std::thread::hardware_concurrency());
+  }
+  m_Queues.reserve(numThreads);
+  for(size_t i = 0; i < numThreads; i++)
+  {
+    m_Queues.push_back(std::make_unique<WorkerQueue>());
+  }
+  m_Workers.reserve(numThreads);
+  for(size_t i = 0; i < numThreads; i++)
+  {
+    m_Workers.emplace_back([this, i]() { workerLoop(i); });
+  }
+}
+
+// -----------------------------------------------------------------------------
+ThreadPool::~ThreadPool() noexcept
+{
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Stop = true;
+  }
+  m_Condition.notify_all();
+  for(auto& worker : m_Workers)
+  {
+    worker.join();
+  }
+}
+
+// -----------------------------------------------------------------------------
+size_t ThreadPool::size() const
+{
+  return m_Workers.size();
+}
+
+// -----------------------------------------------------------------------------
+size_t ThreadPool::getStealCount() const
+{
+  return m_StealCount.load();
+}
+
+// -----------------------------------------------------------------------------
+void ThreadPool::enqueue(std::function<void()> task)
+{
+  const size_t queueIndex = (t_CurrentPool == this) ? t_CurrentWorker : (m_NextQueue++ % m_Queues.size());
+  // Counted before it is queued so a worker can never pop it before it has been counted
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_PendingTasks++;
+  }
+  {
+    std::lock_guard<std::mutex> lock(m_Queues[queueIndex]->mutex);
+    m_Queues[queueIndex]->tasks.push_back(std::move(task));
+  }
+  m_Condition.notify_one();
+}
+
+// -----------------------------------------------------------------------------
+bool ThreadPool::tryPop(size_t workerIndex, std::function<void()>& task)
+{
+  // Oldest task from our own queue first
+  {
+    WorkerQueue& queue = *m_Queues[workerIndex];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if(!queue.tasks.empty())
+    {
+      task = std::move(queue.tasks.front());
+      queue.tasks.pop_front();
+      return true;
+    }
+  }
+  // Then the newest task of any other worker, so the owner and the thief do not contend for the same end
+  for(size_t offset = 1; offset < m_Queues.size(); offset++)
+  {
+    WorkerQueue& queue = *m_Queues[(workerIndex + offset) % m_Queues.size()];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if(!queue.tasks.empty())
+    {
+      task = std::move(queue.tasks.back());
+      queue.tasks.pop_back();
+      m_StealCount++;
+      return true;
+    }
+  }
+  return false;
+}
+
+// -----------------------------------------------------------------------------
+void ThreadPool::workerLoop(size_t workerIndex)
+{
+  t_CurrentPool = this;
+  t_CurrentWorker = workerIndex;
+  while(true)
+  {
+    std::function<void()> task;
+    if(tryPop(workerIndex, task))
+    {
+      {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_PendingTasks--;
+      }
+      task();
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    if(m_Stop && m_PendingTasks == 0)
+    {
+      return;
+    }
+    // A task that was counted but not yet visible to tryPop() only causes one more pass through the loop
+    m_Condition.wait(lock, [this]() { return m_Stop || m_PendingTasks > 0; });
+    if(m_Stop && m_PendingTasks == 0)
+    {
+      return;
+    }
+  }
+}
+} // namespace complex
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace complex
+{
+/**
+ * @class ThreadPool
+ * @brief A fixed set of worker threads with one task queue each. Tasks submitted from
+ * outside the pool are dealt out round-robin; tasks submitted from a worker go to that
+ * worker's own queue. A worker whose queue runs dry steals from the back of the others,
+ * so a few large tasks (e.g. big files in a directory of small ones) do not leave the
+ * other workers idle.
+ *
+ * Each queue runs in FIFO order but there is no ordering between queues. The destructor
+ * finishes every queued task before joining the workers.
+ */
+class ThreadPool
+{
+public:
+  /**
+   * @brief Starts the worker threads.
+   * @param numThreads Zero means one thread per hardware thread.
+   */
+  explicit ThreadPool(size_t numThreads = 0);
+
+  ~ThreadPool() noexcept;
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool(ThreadPool&&) noexcept = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+  ThreadPool& operator=(ThreadPool&&) noexcept = delete;
+
+  /**
+   * @brief Queues the callable and returns a future for its result. Exceptions
+   * thrown by the callable are rethrown from future::get().
+   * @param func
+   * @return
+   */
+  template <typename FuncT>
+  auto submit(FuncT&& func) -> std::future<std::invoke_result_t<std::decay_t<FuncT>>>
+  {
+    using ReturnType = std::invoke_result_t<std::decay_t<FuncT>>;
+    // std::function needs a copyable target so the packaged_task is held by a shared_ptr
+    auto task = std::make_shared<std::packaged_task<ReturnType()>>(std::forward<FuncT>(func));
+    std::future<ReturnType> future = task->get_future();
+    enqueue([task]() { (*task)(); });
+    return future;
+  }
+
+  /**
+   * @brief Returns the number of worker threads.
+   * @return
+   */
+  size_t size() const;
+
+  /**
+   * @brief Returns the number of tasks taken from another worker's queue so far.
+   * @return
+   */
+  size_t getStealCount() const;
+
+private:
+  struct WorkerQueue
+  {
+    std::mutex mutex;
+    std::deque<std::function<void()>> tasks;
+  };
+
+  void enqueue(std::function<void()> task);
+  bool tryPop(size_t workerIndex, std::function<void()>& task);
+  void workerLoop(size_t workerIndex);
+
+  std::vector<std::thread> m_Workers;
+  std::vector<std::unique_ptr<WorkerQueue>> m_Queues;
+  std::atomic<size_t> m_NextQueue = 0;
+  std::atomic<size_t> m_StealCount = 0;
+  // Guards the sleep/wake handshake only; the tasks themselves are guarded by their queue's mutex
+  std::mutex m_Mutex;
+  std::condition_variable m_Condition;
+  size_t m_PendingTasks = 0;
+  bool m_Stop = false;
+};
+} // namespace complex
@@ -0,0 +1,229 @@
+#include "TileCache.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+namespace complex
+{
+namespace
+{
+constexpr size_t k_DefaultBudgetMiB = 1024;
+constexpr size_t k_MinimumResidentTiles = 2;
+} // namespace
+
+// -----------------------------------------------------------------------------
+std::shared_ptr<TileCache> TileCache::Default()
+{
+  static std::shared_ptr<TileCache> s_DefaultCache = []() {
+    size_t budgetMiB = k_DefaultBudgetMiB;
+    if(const char* envValue = std::getenv("SANDBOX_TILE_CACHE_MB"); envValue != nullptr)
+    {
+      try
+      {
+        budgetMiB = std::stoull(envValue);
+      } catch(const std::exception& exception)
+      {
+        std::cout << "Ignoring SANDBOX_TILE_CACHE_MB='" << envValue << "': " << exception.what() << std::endl;
+      }
+    }
+    return std::make_shared<TileCache>(budgetMiB * 1024 * 1024);
+  }();
+  return s_DefaultCache;
+}
+
+// -----------------------------------------------------------------------------
+TileCache::TileCache(size_t memoryBudgetBytes)
+: m_MemoryBudget(memoryBudgetBytes)
+{
+}
+
+// -----------------------------------------------------------------------------
+TileCache::~TileCache() noexcept = default;
+
+// -----------------------------------------------------------------------------
+TileCache::Tile* TileCache::acquire(TileOwner* owner, size_t tileIndex, bool markDirty)
+{
+  const TileKey key = {owner, tileIndex};
+  auto indexIter = m_Index.find(key);
+  if(indexIter != m_Index.end())
+  {
+    m_Hits++;
+    // Move to the front of the LRU list. splice() keeps every iterator valid.
+    m_Tiles.splice(m_Tiles.begin(), m_Tiles, indexIter->second);
+    Tile& tile = m_Tiles.front();
+    tile.dirty = tile.dirty || markDirty;
+    return &tile;
+  }
+
+  m_Misses++;
+  const size_t tileSize = owner->tileByteSize(tileIndex);
+  makeRoom(tileSize);
+
+  Tile tile;
+  tile.key = key;
+  tile.size = tileSize;
+  tile.dirty = markDirty;
+  tile.buffer = TileBuffer(new std::byte[tileSize]);
+  if(!owner->readTile(tileIndex, tile.buffer.get()))
+  {
+    return nullptr;
+  }
+  m_Tiles.push_front(std::move(tile));
+  m_Index[key] = m_Tiles.begin();
+  m_ResidentBytes += tileSize;
+  return &m_Tiles.front();
+}
+
+// -----------------------------------------------------------------------------
+TileCache::TileBuffer TileCache::pin(TileOwner* owner, size_t tileIndex, bool markDirty)
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  Tile* tile = acquire(owner, tileIndex, markDirty);
+  return (nullptr != tile) ? tile->buffer : nullptr;
+}
+
+// -----------------------------------------------------------------------------
+bool TileCache::read(TileOwner* owner, size_t tileIndex, size_t byteOffset, size_t numBytes, std::byte* destination)
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  Tile* tile = acquire(owner, tileIndex, false);
+  if(nullptr == tile)
+  {
+    return false;
+  }
+  std::copy(tile->buffer.get() + byteOffset, tile->buffer.get() + byteOffset + numBytes, destination);
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+bool TileCache::write(TileOwner* owner, size_t tileIndex, size_t byteOffset, size_t numBytes, const std::byte* source)
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  Tile* tile = acquire(owner, tileIndex, true);
+  if(nullptr == tile)
+  {
+    return false;
+  }
+  std::copy(source, source + numBytes, tile->buffer.get() + byteOffset);
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+void TileCache::runLocked(const std::function<void()>& func)
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  func();
+}
+
+// -----------------------------------------------------------------------------
+void TileCache::makeRoom(size_t incomingBytes)
+{
+  auto victimIter = m_Tiles.end();
+  while(m_Tiles.size() >= k_MinimumResidentTiles && m_ResidentBytes + incomingBytes > m_MemoryBudget && victimIter != m_Tiles.begin())
+  {
+    --victimIter;
+    // Somebody still reads or writes a pinned tile through its buffer
+    if(victimIter->isPinned())
+    {
+      continue;
+    }
+    if(victimIter->dirty && !victimIter->key.owner->writeTile(victimIter->key.tileIndex, victimIter->buffer.get()))
+    {
+      // Dropping the tile would lose data; exceed the budget instead.
+      std::cout << "TileCache: could not write back an evicted tile. Keeping it resident." << std::endl;
+      return;
+    }
+    m_ResidentBytes -= victimIter->size;
+    m_Index.erase(victimIter->key);
+    victimIter = m_Tiles.erase(victimIter);
+    m_Evictions++;
+  }
+}
+
+// -----------------------------------------------------------------------------
+bool TileCache::flush(TileOwner* owner)
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  bool success = true;
+  for(auto& tile : m_Tiles)
+  {
+    if(tile.key.owner == owner && tile.dirty)
+    {
+      if(owner->writeTile(tile.key.tileIndex, tile.buffer.get()))
+      {
+        // A pinned tile may still be modified through its buffer
+        tile.dirty = tile.isPinned();
+      }
+      else
+      {
+        success = false;
+      }
+    }
+  }
+  return success;
+}
+
+// -----------------------------------------------------------------------------
+void TileCache::release(TileOwner* owner)
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  for(auto iter = m_Tiles.begin(); iter != m_Tiles.end();)
+  {
+    if(iter->key.owner == owner)
+    {
+      m_ResidentBytes -= iter->size;
+      m_Index.erase(iter->key);
+      iter = m_Tiles.erase(iter);
+    }
+    else
+    {
+      ++iter;
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+void TileCache::setMemoryBudget(size_t memoryBudgetBytes)
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  m_MemoryBudget = memoryBudgetBytes;
+  makeRoom(0);
+}
+
+// -----------------------------------------------------------------------------
+size_t TileCache::getMemoryBudget() const
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_MemoryBudget;
+}
+
+// -----------------------------------------------------------------------------
+size_t TileCache::getResidentBytes() const
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_ResidentBytes;
+}
+
+// -----------------------------------------------------------------------------
+uint64_t TileCache::getHitCount() const
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_Hits;
+}
+
+// -----------------------------------------------------------------------------
+uint64_t TileCache::getMissCount() const
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_Misses;
+}
+
+// -----------------------------------------------------------------------------
+uint64_t TileCache::getEvictionCount() const
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_Evictions;
+}
+} // namespace complex
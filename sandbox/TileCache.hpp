@@ -0,0 +1,196 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace complex
+{
+/**
+ * @class TileOwner
+ * @brief Interface for anything whose data is paged through a TileCache one tile at a time.
+ * The cache calls these while holding its lock so implementations do not need their own.
+ */
+class TileOwner
+{
+public:
+  virtual ~TileOwner() noexcept = default;
+
+  /**
+   * @brief Returns the number of bytes in the tile. Only the last tile may be smaller than the others.
+   * @param tileIndex
+   * @return
+   */
+  virtual size_t tileByteSize(size_t tileIndex) const = 0;
+
+  /**
+   * @brief Fills the buffer with the current contents of the tile.
+   * @param tileIndex
+   * @param buffer
+   * @return false on I/O error
+   */
+  virtual bool readTile(size_t tileIndex, std::byte* buffer) = 0;
+
+  /**
+   * @brief Persists a modified tile that is being evicted.
+   * @param tileIndex
+   * @param buffer
+   * @return false on I/O error
+   */
+  virtual bool writeTile(size_t tileIndex, const std::byte* buffer) = 0;
+};
+
+/**
+ * @class TileCache
+ * @brief Holds the resident tiles of any number of TileOwners within a single memory
+ * budget and evicts the least recently used tile when a new one does not fit.
+ * Modified (dirty) tiles are handed back to their owner before they are dropped.
+ *
+ * Values are either copied in and out under the cache's lock (read(), write()) or reached
+ * through a pinned tile: pin() returns a reference counted buffer and the tile is not
+ * evicted while any copy of it is alive, so the memory stays valid no matter what other
+ * threads or owners sharing the cache do. Pinned tiles count against the budget but are
+ * never evicted; hold pins briefly. At least two tiles are always kept resident no matter
+ * how small the budget is.
+ */
+class TileCache
+{
+public:
+  /**
+   * @brief The process wide cache. Its budget is read from the SANDBOX_TILE_CACHE_MB
+   * environment variable and defaults to 1024 MiB.
+   * @return
+   */
+  static std::shared_ptr<TileCache> Default();
+
+  using TileBuffer = std::shared_ptr<std::byte[]>;
+
+  explicit TileCache(size_t memoryBudgetBytes);
+  ~TileCache() noexcept;
+
+  TileCache(const TileCache&) = delete;
+  TileCache(TileCache&&) noexcept = delete;
+  TileCache& operator=(const TileCache&) = delete;
+  TileCache& operator=(TileCache&&) noexcept = delete;
+
+  /**
+   * @brief Returns the resident copy of the tile, paging it in (and evicting others) as needed.
+   * The tile stays resident until the returned buffer and all copies of it are gone.
+   * @param owner
+   * @param tileIndex
+   * @param markDirty The caller may modify the tile so it must be written back when evicted.
+   * A pinned dirty tile stays dirty until it is unpinned, so later modifications are not lost.
+   * @return nullptr if the tile could not be read.
+   */
+  TileBuffer pin(TileOwner* owner, size_t tileIndex, bool markDirty);
+
+  /**
+   * @brief Copies bytes out of the tile while holding the cache's lock.
+   * @param owner
+   * @param tileIndex
+   * @param byteOffset Offset within the tile
+   * @param numBytes
+   * @param destination
+   * @return false if the tile could not be read.
+   */
+  bool read(TileOwner* owner, size_t tileIndex, size_t byteOffset, size_t numBytes, std::byte* destination);
+
+  /**
+   * @brief Copies bytes into the tile while holding the cache's lock and marks it dirty.
+   * @param owner
+   * @param tileIndex
+   * @param byteOffset Offset within the tile
+   * @param numBytes
+   * @param source
+   * @return false if the tile could not be read.
+   */
+  bool write(TileOwner* owner, size_t tileIndex, size_t byteOffset, size_t numBytes, const std::byte* source);
+
+  /**
+   * @brief Runs the function while holding the cache's lock, for owners that touch their
+   * backing files outside of the TileOwner callbacks (e.g. to copy their scratch file).
+   * @param func Must not call back into the cache.
+   */
+  void runLocked(const std::function<void()>& func);
+
+  /**
+   * @brief Writes every dirty tile of the owner back through TileOwner::writeTile(). The tiles stay resident.
+   * @param owner
+   * @return false if any write failed
+   */
+  bool flush(TileOwner* owner);
+
+  /**
+   * @brief Drops every tile of the owner WITHOUT writing them back. Must be called before the owner is destroyed.
+   * @param owner
+   */
+  void release(TileOwner* owner);
+
+  void setMemoryBudget(size_t memoryBudgetBytes);
+  size_t getMemoryBudget() const;
+  size_t getResidentBytes() const;
+
+  uint64_t getHitCount() const;
+  uint64_t getMissCount() const;
+  uint64_t getEvictionCount() const;
+
+private:
+  struct TileKey
+  {
+    TileOwner* owner = nullptr;
+    size_t tileIndex = 0;
+
+    bool operator==(const TileKey& other) const
+    {
+      return owner == other.owner && tileIndex == other.tileIndex;
+    }
+  };
+
+  struct TileKeyHash
+  {
+    size_t operator()(const TileKey& key) const
+    {
+      return std::hash<const void*>()(key.owner) ^ (std::hash<size_t>()(key.tileIndex) * 31);
+    }
+  };
+
+  struct Tile
+  {
+    TileKey key;
+    TileBuffer buffer;
+    size_t size = 0;
+    bool dirty = false;
+
+    bool isPinned() const
+    {
+      return buffer.use_count() > 1;
+    }
+  };
+
+  using LruList = std::list<Tile>;
+
+  /**
+   * @brief Finds or pages in the tile. The lock must be held.
+   * @return nullptr if the tile could not be read.
+   */
+  Tile* acquire(TileOwner* owner, size_t tileIndex, bool markDirty);
+
+  /**
+   * @brief Evicts unpinned tiles from the back of the LRU list until 'incomingBytes' more fit in the budget.
+   */
+  void makeRoom(size_t incomingBytes);
+
+  mutable std::mutex m_Mutex;
+  LruList m_Tiles; // Most recently used at the front
+  std::unordered_map<TileKey, LruList::iterator, TileKeyHash> m_Index;
+  size_t m_MemoryBudget = 0;
+  size_t m_ResidentBytes = 0;
+  uint64_t m_Hits = 0;
+  uint64_t m_Misses = 0;
+  uint64_t m_Evictions = 0;
+};
+} // namespace complex
@@ -0,0 +1,469 @@
+#pragma once
+
+#include "H5Types.hpp"
+#include "TileCache.hpp"
+
+#include "complex/DataStructure/IDataStore.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <hdf5.h>
+
+namespace complex
+{
+/**
+ * @class TiledDataStore
+ * @brief An out-of-core IDataStore. The values stay in a raw file on disk and are paged
+ * in one tile (a contiguous run of values) at a time through a TileCache, so an array
+ * may be far larger than physical memory.
+ *
+ * The raw file is never modified. Tiles that were modified are written to a private
+ * scratch file when they are evicted and read back from there afterwards. The scratch
+ * file is deleted with the store.
+ *
+ * The store is safe to use from several threads. getValue(), setValue() and copyTo() copy
+ * values while holding the TileCache's lock. at() and operator[] return references into a
+ * pinned tile; each thread keeps its k_PinnedTilesPerThread most recently referenced tiles
+ * pinned, so a reference stays valid until the same thread has referenced that many other
+ * tiles or has exited. Prefer getValue()/setValue() in loops that touch many tiles. Concurrent
+ * writes to the same value are a data race, as with any other store.
+ */
+template <typename T>
+class TiledDataStore : public IDataStore<T>, public TileOwner
+{
+public:
+  using value_type = T;
+  using reference = T&;
+  using const_reference = const T&;
+  using ShapeType = typename IDataStore<T>::ShapeType;
+
+  static constexpr size_t k_DefaultValuesPerTile = 1048576 / sizeof(T);
+  static constexpr size_t k_PinnedTilesPerThread = 4;
+
+  /**
+   * @brief Opens the raw file as a tiled store.
+   * @param filePath Raw file holding native endian T values
+   * @param tupleShape
+   * @param componentShape
+   * @param tileCache Cache that holds the resident tiles and enforces the memory budget
+   * @param valuesPerTile
+   * @param offset Byte offset of the first value in the file
+   * @return nullptr if the file is too small or can not be opened
+   */
+  static std::shared_ptr<TiledDataStore> Open(const std::filesystem::path& filePath, const ShapeType& tupleShape, const ShapeType& componentShape, std::shared_ptr<TileCache> tileCache,
+                                              size_t valuesPerTile = k_DefaultValuesPerTile, size_t offset = 0)
+  {
+    auto store = std::make_shared<TiledDataStore>(filePath, tupleShape, componentShape, std::move(tileCache), valuesPerTile, offset);
+    std::error_code errorCode;
+    const auto fileSize = static_cast<size_t>(std::filesystem::file_size(filePath, errorCode));
+    if(errorCode || fileSize < offset + store->getSize() * sizeof(T) || !store->m_Source.is_open())
+    {
+      return nullptr;
+    }
+    return store;
+  }
+
+  TiledDataStore(std::filesystem::path filePath, ShapeType tupleShape, ShapeType componentShape, std::shared_ptr<TileCache> tileCache, size_t valuesPerTile, size_t offset)
+  : m_FilePath(std::move(filePath))
+  , m_Offset(offset)
+  , m_TupleShape(std::move(tupleShape))
+  , m_ComponentShape(std::move(componentShape))
+  , m_TileCache(std::move(tileCache))
+  , m_ValuesPerTile(std::max(valuesPerTile, static_cast<size_t>(1)))
+  {
+    m_NumTuples = std::accumulate(m_TupleShape.begin(), m_TupleShape.end(), static_cast<size_t>(1), std::multiplies<>());
+    m_NumComponents = std::accumulate(m_ComponentShape.begin(), m_ComponentShape.end(), static_cast<size_t>(1), std::multiplies<>());
+    const size_t numValues = m_NumTuples * m_NumComponents;
+    m_NumTiles = (numValues + m_ValuesPerTile - 1) / m_ValuesPerTile;
+    m_InScratch.resize(m_NumTiles, false);
+    m_Source.open(m_FilePath, std::ios::in | std::ios::binary);
+
+    static std::atomic<uint64_t> s_ScratchCounter = 0;
+    m_ScratchPath = std::filesystem::temp_directory_path() / ("complex_tiled_" + std::to_string(reinterpret_cast<std::uintptr_t>(this)) + "_" + std::to_string(s_ScratchCounter++) + ".scratch");
+  }
+
+  ~TiledDataStore() noexcept override
+  {
+    m_TileCache->release(this);
+    if(m_Scratch.is_open())
+    {
+      m_Scratch.close();
+      std::error_code errorCode;
+      std::filesystem::remove(m_ScratchPath, errorCode);
+    }
+  }
+
+  TiledDataStore(const TiledDataStore&) = delete;
+  TiledDataStore(TiledDataStore&&) noexcept = delete;
+  TiledDataStore& operator=(const TiledDataStore&) = delete;
+  TiledDataStore& operator=(TiledDataStore&&) noexcept = delete;
+
+  usize getNumberOfTuples() const override
+  {
+    return m_NumTuples;
+  }
+
+  const ShapeType& getTupleShape() const override
+  {
+    return m_TupleShape;
+  }
+
+  usize getNumberOfComponents() const override
+  {
+    return m_NumComponents;
+  }
+
+  const ShapeType& getComponentShape() const override
+  {
+    return m_ComponentShape;
+  }
+
+  /**
+   * @brief The backing file is a fixed size so only reshapes that keep the same number of tuples are allowed.
+   * @param tupleShape
+   */
+  void reshapeTuples(const ShapeType& tupleShape) override
+  {
+    const size_t numTuples = std::accumulate(tupleShape.begin(), tupleShape.end(), static_cast<size_t>(1), std::multiplies<>());
+    if(numTuples != m_NumTuples)
+    {
+      throw std::runtime_error("TiledDataStore can not be resized");
+    }
+    m_TupleShape = tupleShape;
+  }
+
+  value_type getValue(usize index) const override
+  {
+    value_type value = {};
+    copyValues(index, 1, &value);
+    return value;
+  }
+
+  void setValue(usize index, value_type value) override
+  {
+    const size_t tileIndex = index / m_ValuesPerTile;
+    const size_t byteOffset = (index % m_ValuesPerTile) * sizeof(T);
+    if(!m_TileCache->write(this, tileIndex, byteOffset, sizeof(T), reinterpret_cast<const std::byte*>(&value)))
+    {
+      throw std::runtime_error("TiledDataStore could not read tile from '" + m_FilePath.string() + "'");
+    }
+  }
+
+  const_reference at(usize index) const override
+  {
+    if(index >= this->getSize())
+    {
+      throw std::runtime_error("TiledDataStore index out of range");
+    }
+    return *valuePointer(index, false);
+  }
+
+  const_reference operator[](usize index) const override
+  {
+    return *valuePointer(index, false);
+  }
+
+  /**
+   * @brief Non-const access has to assume the value will be modified so the tile is marked dirty.
+   */
+  reference operator[](usize index) override
+  {
+    return *valuePointer(index, true);
+  }
+
+  DataType getDataType() const override
+  {
+    return GetDataType<T>();
+  }
+
+  /**
+   * @brief Returns another TiledDataStore over the same raw file that shares this store's
+   * TileCache. Modified tiles are copied into the new store's scratch file.
+   * @return
+   */
+  std::unique_ptr<IDataStore<T>> deepCopy() const override
+  {
+    auto* self = const_cast<TiledDataStore*>(this);
+    m_TileCache->flush(self);
+
+    auto copy = std::make_unique<TiledDataStore>(m_FilePath, m_TupleShape, m_ComponentShape, m_TileCache, m_ValuesPerTile, m_Offset);
+    bool success = true;
+    // The scratch file and m_InScratch are only touched under the cache's lock
+    m_TileCache->runLocked([&]() {
+      std::vector<std::byte> buffer(m_ValuesPerTile * sizeof(T));
+      for(size_t tileIndex = 0; success && tileIndex < m_NumTiles; tileIndex++)
+      {
+        if(m_InScratch[tileIndex])
+        {
+          success = self->readTile(tileIndex, buffer.data()) && copy->writeTile(tileIndex, buffer.data());
+        }
+      }
+    });
+    if(!success)
+    {
+      throw std::runtime_error("TiledDataStore could not copy the scratch file of '" + m_FilePath.string() + "'");
+    }
+    return copy;
+  }
+
+  /**
+   * @brief Writes the values one block of whole slices (along the slowest dimension) at a
+   * time through an HDF5 hyperslab so at most about one tile of values is held in memory
+   * besides the cache. The dataset is created in the writer's parent group under the
+   * writer's name.
+   */
+  H5::ErrorType writeHdf5(H5::DatasetWriter& datasetWriter) const override
+  {
+    std::vector<hsize_t> dims;
+    std::copy(m_TupleShape.begin(), m_TupleShape.end(), std::back_inserter(dims));
+    std::copy(m_ComponentShape.begin(), m_ComponentShape.end(), std::back_inserter(dims));
+    const int rank = static_cast<int>(dims.size());
+    if(dims.empty() || this->getSize() == 0)
+    {
+      return -1;
+    }
+
+    const hid_t typeId = GetH5NativeType<T>();
+    const hid_t spaceId = H5Screate_simple(rank, dims.data(), nullptr);
+    const hid_t datasetId = H5Dcreate2(datasetWriter.getParentId(), datasetWriter.getName().c_str(), typeId, spaceId, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+    if(datasetId < 0)
+    {
+      H5Sclose(spaceId);
+      return -1;
+    }
+
+    const size_t sliceValues = this->getSize() / static_cast<size_t>(dims[0]);
+    const hsize_t slicesPerBlock = std::max(static_cast<hsize_t>((m_ValuesPerTile + sliceValues - 1) / sliceValues), static_cast<hsize_t>(1));
+    std::vector<T> buffer(static_cast<size_t>(std::min(slicesPerBlock, dims[0])) * sliceValues);
+    std::vector<hsize_t> start(dims.size(), 0);
+    std::vector<hsize_t> count = dims;
+    herr_t error = 0;
+    for(hsize_t slice = 0; error >= 0 && slice < dims[0]; slice += slicesPerBlock)
+    {
+      start[0] = slice;
+      count[0] = std::min(slicesPerBlock, dims[0] - slice);
+      copyTo(static_cast<size_t>(slice) * sliceValues, static_cast<size_t>(count[0]) * sliceValues, buffer.data());
+      const hid_t memSpaceId = H5Screate_simple(rank, count.data(), nullptr);
+      H5Sselect_hyperslab(spaceId, H5S_SELECT_SET, start.data(), nullptr, count.data(), nullptr);
+      error = H5Dwrite(datasetId, typeId, memSpaceId, spaceId, H5P_DEFAULT, buffer.data());
+      H5Sclose(memSpaceId);
+    }
+    H5Dclose(datasetId);
+    H5Sclose(spaceId);
+    if(error < 0)
+    {
+      return error;
+    }
+    return WriteH5ShapeAttributes(datasetWriter.getParentId(), datasetWriter.getName(), m_TupleShape, m_ComponentShape);
+  }
+
+  /**
+   * @brief Bulk copy of 'count' values starting at 'start' that takes the cache lock once per tile instead of once per value.
+   * @param start
+   * @param count
+   * @param destination
+   */
+  void copyTo(size_t start, size_t count, T* destination) const
+  {
+    while(count > 0)
+    {
+      const size_t offsetInTile = start % m_ValuesPerTile;
+      const size_t numValues = std::min(count, m_ValuesPerTile - offsetInTile);
+      copyValues(start, numValues, destination);
+      start += numValues;
+      destination += numValues;
+      count -= numValues;
+    }
+  }
+
+  /**
+   * @brief Writes every modified resident tile to the scratch file.
+   * @return false on I/O error
+   */
+  bool flush()
+  {
+    return m_TileCache->flush(this);
+  }
+
+  size_t getValuesPerTile() const
+  {
+    return m_ValuesPerTile;
+  }
+
+  const std::shared_ptr<TileCache>& getTileCache() const
+  {
+    return m_TileCache;
+  }
+
+  // TileOwner interface. These are called while the TileCache's lock is held.
+  size_t tileByteSize(size_t tileIndex) const override
+  {
+    const size_t firstValue = tileIndex * m_ValuesPerTile;
+    return std::min(m_ValuesPerTile, this->getSize() - firstValue) * sizeof(T);
+  }
+
+  bool readTile(size_t tileIndex, std::byte* buffer) override
+  {
+    const size_t numBytes = tileByteSize(tileIndex);
+    std::fstream& stream = m_InScratch[tileIndex] ? m_Scratch : m_Source;
+    const size_t position = m_InScratch[tileIndex] ? tileIndex * m_ValuesPerTile * sizeof(T) : m_Offset + tileIndex * m_ValuesPerTile * sizeof(T);
+    stream.clear();
+    stream.seekg(static_cast<std::streamoff>(position));
+    stream.read(reinterpret_cast<char*>(buffer), static_cast<std::streamsize>(numBytes));
+    return static_cast<size_t>(stream.gcount()) == numBytes;
+  }
+
+  bool writeTile(size_t tileIndex, const std::byte* buffer) override
+  {
+    if(!m_Scratch.is_open())
+    {
+      m_Scratch.open(m_ScratchPath, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+      if(!m_Scratch.is_open())
+      {
+        return false;
+      }
+    }
+    m_Scratch.clear();
+    m_Scratch.seekp(static_cast<std::streamoff>(tileIndex * m_ValuesPerTile * sizeof(T)));
+    m_Scratch.write(reinterpret_cast<const char*>(buffer), static_cast<std::streamsize>(tileByteSize(tileIndex)));
+    m_Scratch.flush();
+    if(!m_Scratch.good())
+    {
+      return false;
+    }
+    m_InScratch[tileIndex] = true;
+    return true;
+  }
+
+private:
+  /**
+   * @brief Copies values that all lie in one tile.
+   */
+  void copyValues(size_t start, size_t count, T* destination) const
+  {
+    const size_t tileIndex = start / m_ValuesPerTile;
+    const size_t byteOffset = (start % m_ValuesPerTile) * sizeof(T);
+    if(!m_TileCache->read(const_cast<TiledDataStore*>(this), tileIndex, byteOffset, count * sizeof(T), reinterpret_cast<std::byte*>(destination)))
+    {
+      throw std::runtime_error("TiledDataStore could not read tile from '" + m_FilePath.string() + "'");
+    }
+  }
+
+  /**
+   * @brief Pins the value's tile for the calling thread and returns a pointer into it.
+   * The calling thread's least recently referenced pin is dropped once it holds more
+   * than k_PinnedTilesPerThread.
+   */
+  T* valuePointer(size_t index, bool markDirty) const
+  {
+    const size_t tileIndex = index / m_ValuesPerTile;
+    TileCache::TileBuffer tile = m_TileCache->pin(const_cast<TiledDataStore*>(this), tileIndex, markDirty);
+    if(nullptr == tile)
+    {
+      throw std::runtime_error("TiledDataStore could not read tile from '" + m_FilePath.string() + "'");
+    }
+    T* value = reinterpret_cast<T*>(tile.get()) + (index % m_ValuesPerTile);
+
+    std::lock_guard<std::mutex> lock(m_PinTable->mutex);
+    auto [threadPins, firstPin] = m_PinTable->pins.try_emplace(std::this_thread::get_id());
+    if(firstPin)
+    {
+      GetThreadPinRegistry().add(m_PinTable);
+    }
+    std::deque<TileCache::TileBuffer>& pins = threadPins->second;
+    auto pinIter = std::find(pins.begin(), pins.end(), tile);
+    if(pinIter != pins.end())
+    {
+      pins.erase(pinIter);
+    }
+    pins.push_back(std::move(tile));
+    if(pins.size() > k_PinnedTilesPerThread)
+    {
+      pins.pop_front();
+    }
+    return value;
+  }
+
+  /**
+   * @brief The tiles each thread keeps pinned, shared with the registries of the threads that pinned any.
+   */
+  struct PinTable
+  {
+    std::mutex mutex;
+    std::map<std::thread::id, std::deque<TileCache::TileBuffer>> pins;
+  };
+
+  /**
+   * @brief Remembers the stores a thread pinned tiles of and drops its pins from those that
+   * still exist when the thread exits, so the tables do not grow with every thread that ever
+   * referenced a value.
+   */
+  class ThreadPinRegistry
+  {
+  public:
+    ThreadPinRegistry() = default;
+    ~ThreadPinRegistry() noexcept
+    {
+      const std::thread::id threadId = std::this_thread::get_id();
+      for(const std::weak_ptr<PinTable>& weakTable : m_Tables)
+      {
+        if(std::shared_ptr<PinTable> table = weakTable.lock(); nullptr != table)
+        {
+          std::lock_guard<std::mutex> lock(table->mutex);
+          table->pins.erase(threadId);
+        }
+      }
+    }
+
+    ThreadPinRegistry(const ThreadPinRegistry&) = delete;
+    ThreadPinRegistry(ThreadPinRegistry&&) noexcept = delete;
+    ThreadPinRegistry& operator=(const ThreadPinRegistry&) = delete;
+    ThreadPinRegistry& operator=(ThreadPinRegistry&&) noexcept = delete;
+
+    void add(const std::shared_ptr<PinTable>& table)
+    {
+      // Tables of deleted stores are dropped here, so a long lived thread only holds the live ones
+      m_Tables.erase(std::remove_if(m_Tables.begin(), m_Tables.end(), [](const std::weak_ptr<PinTable>& weakTable) { return weakTable.expired(); }), m_Tables.end());
+      m_Tables.push_back(table);
+    }
+
+  private:
+    std::vector<std::weak_ptr<PinTable>> m_Tables;
+  };
+
+  static ThreadPinRegistry& GetThreadPinRegistry()
+  {
+    thread_local ThreadPinRegistry registry;
+    return registry;
+  }
+
+  std::filesystem::path m_FilePath;
+  size_t m_Offset = 0;
+  ShapeType m_TupleShape;
+  ShapeType m_ComponentShape;
+  size_t m_NumTuples = 0;
+  size_t m_NumComponents = 0;
+  std::shared_ptr<TileCache> m_TileCache;
+  size_t m_ValuesPerTile = 0;
+  size_t m_NumTiles = 0;
+  std::fstream m_Source;
+  std::filesystem::path m_ScratchPath;
+  std::fstream m_Scratch;
+  std::vector<bool> m_InScratch;
+  std::shared_ptr<PinTable> m_PinTable = std::make_shared<PinTable>();
+};
+} // namespace complex
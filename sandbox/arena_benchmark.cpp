@@ -0,0 +1,143 @@
+/**
+ * Compares reading many small raw files into one DataStore (one heap allocation) each
+ * against packing them into a StoreArena. Reports the wall time, the number of heap
+ * allocations and the growth of the resident set for both.
+ */
+
+#include "RawFileReader.hpp"
+#include "StoreArena.hpp"
+
+#include "sandbox_test_dirs.h"
+
+#include <fmt/format.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <vector>
+
+#if defined(__linux__)
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+using namespace complex;
+
+namespace
+{
+constexpr size_t k_NumFiles = 10000;
+constexpr size_t k_MinFileSize = 256;
+constexpr size_t k_MaxFileSize = 8 * 1024;
+
+std::atomic<size_t> s_AllocationCount = 0;
+
+/**
+ * @brief Returns the resident set size in bytes, or 0 where it can not be queried.
+ */
+size_t ResidentBytes()
+{
+#if defined(__linux__)
+  std::ifstream statm("/proc/self/statm");
+  size_t totalPages = 0;
+  size_t residentPages = 0;
+  if(statm >> totalPages >> residentPages)
+  {
+    return residentPages * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  }
+#endif
+  return 0;
+}
+
+/**
+ * @brief Writes k_NumFiles files with sizes spread evenly between k_MinFileSize and k_MaxFileSize.
+ */
+std::vector<fs::path> WriteSmallFiles(const fs::path& directory)
+{
+  fs::create_directories(directory);
+  std::vector<fs::path> filePaths;
+  std::vector<char> bytes(k_MaxFileSize);
+  for(size_t i = 0; i < bytes.size(); i++)
+  {
+    bytes[i] = static_cast<char>(i % 251);
+  }
+  for(size_t i = 0; i < k_NumFiles; i++)
+  {
+    const size_t fileSize = k_MinFileSize + (i * 7919) % (k_MaxFileSize - k_MinFileSize + 1);
+    fs::path filePath = directory / fmt::format("small_{:05}.raw", i);
+    std::ofstream outFile(filePath, std::ios::out | std::ios::binary);
+    outFile.write(bytes.data(), static_cast<std::streamsize>(fileSize));
+    filePaths.push_back(std::move(filePath));
+  }
+  return filePaths;
+}
+
+/**
+ * @brief Reads every file, keeping all stores alive until the measurements are taken.
+ */
+void RunBenchmark(const std::string& label, const std::vector<fs::path>& filePaths, bool useArena)
+{
+  const size_t residentBefore = ResidentBytes();
+  const size_t allocationsBefore = s_AllocationCount.load();
+  auto start = std::chrono::steady_clock::now();
+
+  std::shared_ptr<StoreArena> arena = useArena ? std::make_shared<StoreArena>() : nullptr;
+  std::vector<std::shared_ptr<IDataStore<uint8_t>>> stores;
+  stores.reserve(filePaths.size());
+  size_t numBytes = 0;
+  for(const auto& filePath : filePaths)
+  {
+    const size_t fileSize = fs::file_size(filePath);
+    stores.push_back(ReadRawDataStore<uint8_t>(filePath, fileSize, {1}, RawReadMode::Copy, nullptr, {}, arena));
+    numBytes += fileSize;
+  }
+
+  const double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  const size_t allocations = s_AllocationCount.load() - allocationsBefore;
+  const size_t residentAfter = ResidentBytes();
+  const double residentMegaBytes = static_cast<double>(residentAfter > residentBefore ? residentAfter - residentBefore : 0) / (1024.0 * 1024.0);
+  std::cout << fmt::format("{:<12} {:>9.2f} ms   {:>8} allocations ({:.1f} per file)   RSS +{:.1f} MB for {:.1f} MB of values", label, milliseconds, allocations,
+                           static_cast<double>(allocations) / static_cast<double>(filePaths.size()), residentMegaBytes, static_cast<double>(numBytes) / (1024.0 * 1024.0))
+            << std::endl;
+}
+} // namespace
+
+// Every heap allocation in the process goes through here so the benchmark can count them
+void* operator new(std::size_t size)
+{
+  s_AllocationCount.fetch_add(1, std::memory_order_relaxed);
+  if(void* memory = std::malloc(size == 0 ? 1 : size))
+  {
+    return memory;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept
+{
+  std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept
+{
+  std::free(memory);
+}
+
+int main(int32_t argc, char** argv)
+{
+  const fs::path outputDir = fs::path(complex::unit_test::k_ComplexBinaryDir.str()) / "arena_benchmark";
+  std::cout << "Writing " << k_NumFiles << " small files to " << outputDir << std::endl;
+  const std::vector<fs::path> filePaths = WriteSmallFiles(outputDir);
+
+  // The heap run goes first so the arena run can not profit from pages the heap already holds
+  RunBenchmark("DataStore", filePaths, false);
+  RunBenchmark("StoreArena", filePaths, true);
+
+  fs::remove_all(outputDir);
+  return 0;
+}
@@ -3,8 +3,9 @@
 #include "complex/DataStructure/DataStructure.hpp"
 #include "complex/UnitTest/UnitTestCommon.hpp"
 #include "complex/DataStructure/DataObject.hpp"
-#include "complex/Utilities/Parsing/HDF5/H5FileWriter.hpp"
+#include "complex/DataStructure/Geometry/ImageGeom.hpp"
 
+#include "H5DataStructureWriter.hpp"
 #include "sandbox_test_dirs.h"
 
 
@@ -38,10 +39,8 @@ int main(int32_t argc, char**argv)
   std::cout << "ImageGeom.use_count(): " << imageGeom.use_count() << std::endl;
 
   // Write out the DataStructure for later viewing/debugging
-  Result<H5::FileWriter> result = H5::FileWriter::CreateFile(fmt::format("{}/datastructure_test.dream3d", complex::unit_test::k_ComplexBinaryDir));
-  H5::FileWriter fileWriter = std::move(result.value());
-
-  herr_t err = vtkDataStructure.writeHdf5(fileWriter);
+  H5WriteOptions writeOptions = H5WriteOptions::ForImageGeom(dynamic_cast<const ImageGeom&>(*imageGeom), H5Compression::Deflate);
+  WriteDataStructureHdf5(vtkDataStructure, fmt::format("{}/datastructure_test.dream3d", complex::unit_test::k_ComplexBinaryDir), writeOptions);
 
   return 0;
 }
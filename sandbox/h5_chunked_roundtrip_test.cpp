@@ -0,0 +1,172 @@
+/**
+ * Writes an ImageGeom with multi-component cell arrays through WriteDataStructureHdf5() with
+ * chunked, compressed layouts and reads the file back with ReadDataStructureHdf5Lazy(). Every
+ * array must come back with its tuple shape, component shape and values, and the geometry
+ * with its dimensions. Returns non-zero on any difference.
+ */
+
+#include "H5DataStructureWriter.hpp"
+#include "H5LazyReader.hpp"
+#include "H5Types.hpp"
+
+#include "sandbox_test_dirs.h"
+
+#include "complex/DataStructure/DataArray.hpp"
+#include "complex/DataStructure/DataGroup.hpp"
+#include "complex/DataStructure/DataStore.hpp"
+#include "complex/DataStructure/DataStructure.hpp"
+#include "complex/DataStructure/Geometry/ImageGeom.hpp"
+#include "complex/DataStructure/IDataArray.hpp"
+
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+namespace fs = std::filesystem;
+using namespace complex;
+
+namespace
+{
+constexpr usize k_DimX = 24;
+constexpr usize k_DimY = 16;
+constexpr usize k_DimZ = 8;
+
+const DataPath k_GeomPath({"Scan", "Grid"});
+
+struct ExpectedArray
+{
+  DataPath path;
+  std::vector<usize> tupleShape;
+  std::vector<usize> componentShape;
+};
+
+// -----------------------------------------------------------------------------
+template <typename T>
+void CreateArray(DataStructure& dataStructure, const std::string& name, const std::vector<usize>& tupleShape, const std::vector<usize>& componentShape, DataObject::IdType parentId)
+{
+  auto store = std::make_shared<DataStore<T>>(tupleShape, componentShape);
+  for(usize i = 0; i < store->getSize(); i++)
+  {
+    store->setValue(i, static_cast<T>(i % 251));
+  }
+  DataArray<T>::Create(dataStructure, name, store, parentId);
+}
+
+/**
+ * @brief A geometry with a 3 component cell array in volume layout, a 2x3 component one flat,
+ * and a small array that stays contiguous.
+ */
+DataStructure CreateInputDataStructure(std::vector<ExpectedArray>& expectedArrays)
+{
+  DataStructure dataStructure;
+  DataGroup* scan = DataGroup::Create(dataStructure, "Scan");
+  ImageGeom* imageGeom = ImageGeom::Create(dataStructure, "Grid", scan->getId());
+  imageGeom->setDimensions({k_DimX, k_DimY, k_DimZ});
+  imageGeom->setSpacing({0.5f, 0.5f, 1.0f});
+  imageGeom->setOrigin({1.0f, 2.0f, 3.0f});
+
+  const usize numVoxels = k_DimX * k_DimY * k_DimZ;
+  CreateArray<float32>(dataStructure, "Euler Angles", {k_DimZ, k_DimY, k_DimX}, {3}, scan->getId());
+  CreateArray<uint8>(dataStructure, "Pairs", {numVoxels}, {2, 3}, scan->getId());
+  CreateArray<int32>(dataStructure, "Phase Ids", {4}, {2}, scan->getId());
+  expectedArrays = {{DataPath({"Scan", "Euler Angles"}), {k_DimZ, k_DimY, k_DimX}, {3}},
+                    {DataPath({"Scan", "Pairs"}), {numVoxels}, {2, 3}},
+                    {DataPath({"Scan", "Phase Ids"}), {4}, {2}}};
+  return dataStructure;
+}
+
+/**
+ * @brief Prints and counts every array whose shape or values differ from the input's.
+ */
+size_t CountDifferences(const std::string& name, const DataStructure& input, const DataStructure& readBack, const std::vector<ExpectedArray>& expectedArrays)
+{
+  size_t numDifferences = 0;
+  for(const ExpectedArray& expected : expectedArrays)
+  {
+    const auto* inputArray = input.getDataAs<IDataArray>(expected.path);
+    const auto* readArray = readBack.getDataAs<IDataArray>(expected.path);
+    if(nullptr == readArray || readArray->getDataType() != inputArray->getDataType())
+    {
+      std::cout << "  " << name << ": " << expected.path.toString() << " is missing or has another type" << std::endl;
+      numDifferences++;
+      continue;
+    }
+    bool sameShape = false;
+    bool sameValues = false;
+    VisitNumericDataType(inputArray->getDataType(), [&](auto value) {
+      using T = decltype(value);
+      const IDataStore<T>& inputStore = *dynamic_cast<const DataArray<T>*>(inputArray)->getDataStore();
+      const IDataStore<T>& readStore = *dynamic_cast<const DataArray<T>*>(readArray)->getDataStore();
+      sameShape = (readStore.getTupleShape() == expected.tupleShape && readStore.getComponentShape() == expected.componentShape);
+      sameValues = sameShape;
+      for(usize i = 0; sameValues && i < inputStore.getSize(); i++)
+      {
+        sameValues = (inputStore.getValue(i) == readStore.getValue(i));
+      }
+    });
+    if(!sameShape)
+    {
+      std::cout << "  " << name << ": " << expected.path.toString() << " has another shape" << std::endl;
+      numDifferences++;
+      continue;
+    }
+    if(!sameValues)
+    {
+      std::cout << "  " << name << ": " << expected.path.toString() << " has other values" << std::endl;
+      numDifferences++;
+    }
+  }
+
+  const auto* imageGeom = readBack.getDataAs<ImageGeom>(k_GeomPath);
+  if(nullptr == imageGeom || imageGeom->getNumXPoints() != k_DimX || imageGeom->getNumYPoints() != k_DimY || imageGeom->getNumZPoints() != k_DimZ)
+  {
+    std::cout << "  " << name << ": the ImageGeom is missing or has other dimensions" << std::endl;
+    numDifferences++;
+  }
+  return numDifferences;
+}
+} // namespace
+
+// -----------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+  const fs::path filePath = fs::path(unit_test::k_ComplexBinaryDir.str()) / "h5_chunked_roundtrip_test.h5";
+  std::vector<ExpectedArray> expectedArrays;
+  const DataStructure input = CreateInputDataStructure(expectedArrays);
+  const auto& imageGeom = *input.getDataAs<ImageGeom>(k_GeomPath);
+
+  H5WriteOptions chunked = H5WriteOptions::ForImageGeom(imageGeom, H5Compression::None);
+  H5WriteOptions deflate = H5WriteOptions::ForImageGeom(imageGeom, H5Compression::Deflate, 1);
+  // Small enough that both cell arrays are chunked, but the small array stays contiguous
+  chunked.minimumChunkedBytes = 1024;
+  deflate.minimumChunkedBytes = 1024;
+
+  int result = EXIT_SUCCESS;
+  for(const auto& [name, options] : {std::make_pair(std::string("chunked"), chunked), std::make_pair(std::string("deflate"), deflate)})
+  {
+    if(!WriteDataStructureHdf5(input, filePath, options))
+    {
+      std::cout << "Could not write " << filePath.string() << " " << name << std::endl;
+      result = EXIT_FAILURE;
+      continue;
+    }
+    std::shared_ptr<DataStructure> readBack = ReadDataStructureHdf5Lazy(filePath);
+    const size_t numDifferences = (nullptr == readBack) ? expectedArrays.size() : CountDifferences(name, input, *readBack, expectedArrays);
+    std::cout << name << ": " << numDifferences << " differences" << std::endl;
+    if(numDifferences != 0)
+    {
+      result = EXIT_FAILURE;
+    }
+  }
+
+  std::error_code errorCode;
+  fs::remove(filePath, errorCode);
+  std::cout << (result == EXIT_SUCCESS ? "PASSED" : "FAILED") << std::endl;
+  return result;
+}
@@ -0,0 +1,290 @@
+/**
+ * Times writing and reading back ImageGeom DataStructures with the array mix of the
+ * sandbox's CreateDataStructure() at several grid sizes and HDF5 layouts, and reports
+ * throughput and peak memory as JSON so runs can be compared over time.
+ *
+ *   h5_roundtrip_benchmark [--cold] [edge length ...]   (default: 100 256 512)
+ *
+ * The "writeHdf5" row calls DataStructure::writeHdf5() directly as a baseline for the
+ * WriteDataStructureHdf5() rows. The files are read back right after they are written, so
+ * reads come from a warm page cache unless --cold is given; then the file is flushed and
+ * evicted from the page cache before each read (Linux only). The JSON goes to stdout and
+ * to h5_roundtrip_benchmark.json in the binary dir.
+ */
+
+#include "H5DataStructureWriter.hpp"
+#include "H5LazyReader.hpp"
+
+#include "complex/DataStructure/DataArray.hpp"
+#include "complex/DataStructure/DataGroup.hpp"
+#include "complex/DataStructure/DataStore.hpp"
+#include "complex/DataStructure/DataStructure.hpp"
+#include "complex/DataStructure/Geometry/ImageGeom.hpp"
+#include "complex/Utilities/Parsing/HDF5/H5FileReader.hpp"
+#include "complex/Utilities/Parsing/HDF5/H5FileWriter.hpp"
+
+#include "sandbox_test_dirs.h"
+
+#include <nlohmann/json.hpp>
+
+#include <hdf5.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+using namespace complex;
+
+namespace
+{
+constexpr H5Z_filter_t k_ZstdFilterId = 32015;
+
+struct WriteSetting
+{
+  std::string name;
+  H5WriteOptions options;
+  bool direct = false; // Call DataStructure::writeHdf5() instead of WriteDataStructureHdf5()
+};
+
+/**
+ * @brief Starts a new peak RSS measurement. Only Linux can reset the high water mark;
+ * elsewhere the reported peak is the peak of the whole run so far.
+ */
+void ResetPeakResident()
+{
+#if defined(__linux__)
+  std::ofstream clearRefs("/proc/self/clear_refs");
+  clearRefs << "5";
+#endif
+}
+
+/**
+ * @brief Returns the peak resident set size in bytes since the last ResetPeakResident().
+ */
+size_t PeakResidentBytes()
+{
+#if defined(__linux__)
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while(std::getline(status, line))
+  {
+    if(line.rfind("VmHWM:", 0) == 0)
+    {
+      return std::stoull(line.substr(6)) * 1024;
+    }
+  }
+  rusage usage = {};
+  getrusage(RUSAGE_SELF, &usage);
+  return static_cast<size_t>(usage.ru_maxrss) * 1024;
+#else
+  return 0;
+#endif
+}
+
+/**
+ * @brief Writes the file's dirty pages to disk and drops its pages from the page cache, so
+ * the next read comes from the disk. Only implemented on Linux.
+ * @return false if the pages could not be dropped.
+ */
+bool EvictFromPageCache(const fs::path& filePath)
+{
+#if defined(__linux__)
+  const int fd = open(filePath.c_str(), O_RDONLY);
+  if(fd < 0)
+  {
+    return false;
+  }
+  // Dirty pages are not dropped, so they have to reach the disk first
+  const bool success = fdatasync(fd) == 0 && posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) == 0;
+  close(fd);
+  return success;
+#else
+  return false;
+#endif
+}
+
+/**
+ * @brief Writes the DataStructure the way the sandbox does, without WriteDataStructureHdf5().
+ */
+bool WriteDirect(const DataStructure& dataGraph, const fs::path& filePath)
+{
+  Result<H5::FileWriter> result = H5::FileWriter::CreateFile(filePath);
+  if(!result.valid())
+  {
+    return false;
+  }
+  H5::FileWriter fileWriter = std::move(result.value());
+  return dataGraph.writeHdf5(fileWriter) >= 0;
+}
+
+template <typename T, typename FuncT>
+void CreateArray(DataStructure& dataGraph, const std::string& name, size_t numTuples, size_t numComponents, DataObject::IdType parentId, FuncT&& valueFunc)
+{
+  auto dataStore = std::make_shared<DataStore<T>>(std::vector<usize>{numTuples}, std::vector<usize>{numComponents});
+  T* values = dataStore->data();
+  for(size_t i = 0; i < numTuples * numComponents; i++)
+  {
+    values[i] = valueFunc(i);
+  }
+  DataArray<T>::Create(dataGraph, name, dataStore, parentId);
+}
+
+/**
+ * @brief Builds the same hierarchy and arrays as CreateDataStructure() on an edge^3 grid.
+ * The values imitate EBSD data: features are blocks of voxels, quality values vary smoothly.
+ */
+std::shared_ptr<DataStructure> CreateBenchmarkDataStructure(size_t edge, size_t& numBytes)
+{
+  auto dataGraph = std::make_shared<DataStructure>();
+  DataGroup* group = DataGroup::Create(*dataGraph, "Small IN100");
+  DataGroup* scanData = DataGroup::Create(*dataGraph, "EBSD Scan Data", group->getId());
+  ImageGeom* imageGeom = ImageGeom::Create(*dataGraph, "Small IN100 Grid", scanData->getId());
+  imageGeom->setSpacing({0.25f, 0.25f, 0.25f});
+  imageGeom->setOrigin({0.0f, 0.0f, 0.0f});
+  imageGeom->setDimensions({edge, edge, edge});
+
+  const size_t numVoxels = edge * edge * edge;
+  constexpr size_t k_GrainEdge = 16;
+  const size_t grainsPerEdge = (edge + k_GrainEdge - 1) / k_GrainEdge;
+  auto featureId = [edge, grainsPerEdge](size_t voxel) -> int32_t {
+    const size_t x = voxel % edge;
+    const size_t y = (voxel / edge) % edge;
+    const size_t z = voxel / (edge * edge);
+    return static_cast<int32_t>(((z / k_GrainEdge) * grainsPerEdge + y / k_GrainEdge) * grainsPerEdge + x / k_GrainEdge + 1);
+  };
+  const DataObject::IdType parentId = scanData->getId();
+  CreateArray<float>(*dataGraph, "Confidence Index", numVoxels, 1, parentId, [](size_t i) { return static_cast<float>((i * 2654435761ULL) % 1000) / 1000.0f; });
+  CreateArray<int32_t>(*dataGraph, "FeatureIds", numVoxels, 1, parentId, featureId);
+  CreateArray<float>(*dataGraph, "Image Quality", numVoxels, 1, parentId, [edge](size_t i) { return static_cast<float>(i % edge) * 0.5f + static_cast<float>((i / edge) % edge); });
+  CreateArray<int32_t>(*dataGraph, "Phases", numVoxels, 1, parentId, [&featureId](size_t i) { return featureId(i) % 2 + 1; });
+  CreateArray<uint8_t>(*dataGraph, "IPF Colors", numVoxels, 3, parentId, [&featureId](size_t i) { return static_cast<uint8_t>(featureId(i / 3) * (37 + 29 * (i % 3))); });
+  DataGroup* phaseGroup = DataGroup::Create(*dataGraph, "Phase Data", group->getId());
+  CreateArray<int32_t>(*dataGraph, "Laue Class", 2, 1, phaseGroup->getId(), [](size_t i) { return static_cast<int32_t>(i); });
+
+  numBytes = numVoxels * (sizeof(float) + sizeof(int32_t) + sizeof(float) + sizeof(int32_t) + 3 * sizeof(uint8_t)) + 2 * sizeof(int32_t);
+  return dataGraph;
+}
+
+std::vector<WriteSetting> CreateWriteSettings(const ImageGeom& imageGeom)
+{
+  std::vector<WriteSetting> settings;
+  settings.push_back({"writeHdf5", H5WriteOptions{}, true});
+  settings.push_back({"contiguous", H5WriteOptions{}});
+  settings.push_back({"chunked", H5WriteOptions::ForImageGeom(imageGeom, H5Compression::None)});
+  settings.push_back({"deflate-1", H5WriteOptions::ForImageGeom(imageGeom, H5Compression::Deflate, 1)});
+  settings.push_back({"deflate-6", H5WriteOptions::ForImageGeom(imageGeom, H5Compression::Deflate, 6)});
+  // Without the plugin the writer would silently fall back to deflate, which would only duplicate a row
+  if(H5Zfilter_avail(k_ZstdFilterId) > 0)
+  {
+    settings.push_back({"zstd-3", H5WriteOptions::ForImageGeom(imageGeom, H5Compression::Zstd, 3)});
+  }
+  return settings;
+}
+
+double SecondsSince(std::chrono::steady_clock::time_point startTime)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+double MegaBytesPerSecond(size_t numBytes, double seconds)
+{
+  return seconds > 0.0 ? static_cast<double>(numBytes) / (1024.0 * 1024.0) / seconds : 0.0;
+}
+} // namespace
+
+int main(int32_t argc, char** argv)
+{
+  std::vector<size_t> edges;
+  bool coldReads = false;
+  for(int32_t i = 1; i < argc; i++)
+  {
+    if(std::string(argv[i]) == "--cold")
+    {
+      coldReads = true;
+      continue;
+    }
+    edges.push_back(std::strtoull(argv[i], nullptr, 10));
+  }
+  if(edges.empty())
+  {
+    edges = {100, 256, 512};
+  }
+
+  const fs::path outputDir = fs::path(complex::unit_test::k_ComplexBinaryDir.str());
+  const fs::path filePath = outputDir / "h5_roundtrip_benchmark.h5";
+  nlohmann::json results = nlohmann::json::array();
+
+  for(size_t edge : edges)
+  {
+    size_t numBytes = 0;
+    std::cerr << "Creating " << edge << "^3 DataStructure" << std::endl;
+    std::shared_ptr<DataStructure> dataGraph = CreateBenchmarkDataStructure(edge, numBytes);
+    const auto* imageGeom = dataGraph->getDataAs<ImageGeom>(DataPath({"Small IN100", "EBSD Scan Data", "Small IN100 Grid"}));
+
+    for(const WriteSetting& setting : CreateWriteSettings(*imageGeom))
+    {
+      std::cerr << "  " << setting.name << std::endl;
+      nlohmann::json result;
+      result["grid"] = edge;
+      result["setting"] = setting.name;
+      result["bytes"] = numBytes;
+
+      ResetPeakResident();
+      auto startTime = std::chrono::steady_clock::now();
+      const bool written = setting.direct ? WriteDirect(*dataGraph, filePath) : WriteDataStructureHdf5(*dataGraph, filePath, setting.options);
+      const double writeSeconds = SecondsSince(startTime);
+      result["write_ok"] = written;
+      result["write_seconds"] = writeSeconds;
+      result["write_mb_per_s"] = MegaBytesPerSecond(numBytes, writeSeconds);
+      result["write_peak_rss_bytes"] = PeakResidentBytes();
+      result["file_bytes"] = written ? fs::file_size(filePath) : 0;
+
+      if(written)
+      {
+        // A failed eviction is recorded rather than fatal so the row still says which cache the read saw
+        result["read_cache"] = (coldReads && EvictFromPageCache(filePath)) ? "cold" : "warm";
+        ResetPeakResident();
+        startTime = std::chrono::steady_clock::now();
+        {
+          H5::FileReader fileReader(filePath);
+          H5::ErrorType err = 0;
+          DataStructure readBack = DataStructure::readFromHdf5(fileReader, err);
+          result["read_ok"] = (err >= 0);
+        }
+        const double readSeconds = SecondsSince(startTime);
+        result["read_seconds"] = readSeconds;
+        result["read_mb_per_s"] = MegaBytesPerSecond(numBytes, readSeconds);
+        result["read_peak_rss_bytes"] = PeakResidentBytes();
+
+        if(coldReads)
+        {
+          EvictFromPageCache(filePath);
+        }
+        startTime = std::chrono::steady_clock::now();
+        std::shared_ptr<DataStructure> lazyGraph = ReadDataStructureHdf5Lazy(filePath);
+        result["lazy_open_seconds"] = SecondsSince(startTime);
+      }
+      results.push_back(result);
+      fs::remove(filePath);
+    }
+  }
+
+  const std::string report = results.dump(2);
+  std::cout << report << std::endl;
+  std::ofstream jsonFile(outputDir / "h5_roundtrip_benchmark.json");
+  jsonFile << report << std::endl;
+  return 0;
+}
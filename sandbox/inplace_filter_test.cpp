@@ -0,0 +1,196 @@
+/**
+ * Runs two generated ITK filters through PipelineCheckpointer, once as they are and once with
+ * a PipelineLiveness that lets the second one execute in place. The first filter's output is
+ * only read by the second, so the second may overwrite it. Both runs must give the same output
+ * values, and the in-place run must release the intermediate array.
+ * Returns non-zero on any difference and 77 (skipped) if the ITKImageProcessing plugin is not
+ * in the build directory.
+ */
+
+#include "PipelineCheckpoint.hpp"
+#include "PipelineLiveness.hpp"
+
+#include "sandbox_test_dirs.h"
+
+#include "complex/Common/Types.hpp"
+#include "complex/Core/Application.hpp"
+#include "complex/DataStructure/DataArray.hpp"
+#include "complex/DataStructure/DataStore.hpp"
+#include "complex/DataStructure/DataStructure.hpp"
+#include "complex/DataStructure/Geometry/ImageGeom.hpp"
+#include "complex/Filter/FilterHandle.hpp"
+#include "complex/Pipeline/Pipeline.hpp"
+#include "complex/Pipeline/PipelineFilter.hpp"
+
+#include <fmt/format.h>
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+using namespace complex;
+
+namespace
+{
+constexpr int k_SkipReturnCode = 77;
+constexpr usize k_DimX = 32;
+constexpr usize k_DimY = 24;
+constexpr usize k_DimZ = 4;
+
+// Uuids from ItkFilterList.h; the filters keep their input's pixel type, so both support in-place execution
+constexpr const char* k_AbsImageUuid = "09f45c29-1cfb-566c-b3ae-d832b4f95905";
+constexpr const char* k_SqrtImageUuid = "8087dcad-68f2-598b-9670-d0f57647a445";
+
+const DataPath k_GeomPath({"Image"});
+const DataPath k_InputPath({"Image", "Input"});
+const DataPath k_MagnitudePath({"Image", "Magnitude"});
+const DataPath k_OutputPath({"Image", "Output"});
+
+// -----------------------------------------------------------------------------
+std::optional<FilterHandle> FindFilterHandle(const FilterList& filterList, const std::string& filterUuid)
+{
+  const Uuid filterId = Uuid::FromString(filterUuid).value();
+  for(const FilterHandle& filterHandle : filterList.getFilterHandles())
+  {
+    if(filterHandle.getFilterId() == filterId)
+    {
+      return filterHandle;
+    }
+  }
+  return {};
+}
+
+/**
+ * @brief An image geometry with a float32 cell array that holds negative and positive values.
+ */
+DataStructure CreateInputDataStructure()
+{
+  DataStructure dataStructure;
+  ImageGeom* imageGeom = ImageGeom::Create(dataStructure, k_GeomPath.getTargetName());
+  imageGeom->setDimensions({k_DimX, k_DimY, k_DimZ});
+  imageGeom->setSpacing({1.0f, 1.0f, 1.0f});
+  imageGeom->setOrigin({0.0f, 0.0f, 0.0f});
+
+  auto store = std::make_shared<DataStore<float32>>(std::vector<usize>{k_DimZ, k_DimY, k_DimX}, std::vector<usize>{1});
+  for(usize i = 0; i < store->getSize(); i++)
+  {
+    store->setValue(i, static_cast<float32>(std::sin(static_cast<float64>(i) * 0.05) * 100.0));
+  }
+  DataArray<float32>::Create(dataStructure, k_InputPath.getTargetName(), store, imageGeom->getId());
+  return dataStructure;
+}
+
+// -----------------------------------------------------------------------------
+void AppendItkFilter(Pipeline& pipeline, const FilterHandle& filterHandle, const DataPath& inputPath, const DataPath& outputPath)
+{
+  std::unique_ptr<PipelineFilter> node = PipelineFilter::Create(filterHandle);
+  Arguments arguments;
+  arguments.insert("SelectedImageGeomPath", std::any(k_GeomPath));
+  arguments.insert(PipelineLiveness::k_InPlaceInputKey, std::any(inputPath));
+  arguments.insert("OutputImageDataPath", std::any(outputPath));
+  arguments.insert(PipelineLiveness::k_ExecuteInPlaceKey, std::make_any<bool>(false));
+  node->setArguments(arguments);
+  pipeline.push_back(std::move(node));
+}
+
+/**
+ * @brief Returns the number of output values that differ between the two runs, or all of
+ * them if either run has no float32 output.
+ */
+size_t CountDifferences(const DataStructure& expected, const DataStructure& actual)
+{
+  const auto* expectedArray = expected.getDataAs<Float32Array>(k_OutputPath);
+  const auto* actualArray = actual.getDataAs<Float32Array>(k_OutputPath);
+  const size_t numValues = k_DimX * k_DimY * k_DimZ;
+  if(nullptr == expectedArray || nullptr == actualArray || actualArray->getSize() != numValues || expectedArray->getSize() != numValues)
+  {
+    std::cout << "  The output is missing, has another type or another size" << std::endl;
+    return numValues;
+  }
+  size_t numDifferences = 0;
+  for(size_t i = 0; i < numValues; i++)
+  {
+    if(expectedArray->getDataStore()->getValue(i) != actualArray->getDataStore()->getValue(i))
+    {
+      numDifferences++;
+    }
+  }
+  return numDifferences;
+}
+} // namespace
+
+// -----------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+  Application app;
+  const fs::path pluginPath = fmt::format("{}/{}", unit_test::k_BuildDir, unit_test::k_BuildTypeDir);
+  app.loadPlugins(pluginPath, true);
+
+  const std::optional<FilterHandle> absHandle = FindFilterHandle(*app.getFilterList(), k_AbsImageUuid);
+  const std::optional<FilterHandle> sqrtHandle = FindFilterHandle(*app.getFilterList(), k_SqrtImageUuid);
+  if(!absHandle.has_value() || !sqrtHandle.has_value())
+  {
+    std::cout << "The ITKImageProcessing plugin is not in " << pluginPath.string() << "; skipped" << std::endl;
+    return k_SkipReturnCode;
+  }
+
+  // Out of place: no liveness, so every filter gets a new output array
+  Pipeline outOfPlacePipeline;
+  AppendItkFilter(outOfPlacePipeline, *absHandle, k_InputPath, k_MagnitudePath);
+  AppendItkFilter(outOfPlacePipeline, *sqrtHandle, k_MagnitudePath, k_OutputPath);
+  DataStructure outOfPlaceGraph = CreateInputDataStructure();
+  PipelineCheckpointer outOfPlaceRunner({});
+  if(!outOfPlaceRunner.execute(outOfPlacePipeline, outOfPlaceGraph))
+  {
+    std::cout << "The pipeline failed to execute out of place" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // In place: the sqrt filter's input dies with it, so it writes over "Magnitude" and hands its store on to "Output"
+  Pipeline inPlacePipeline;
+  AppendItkFilter(inPlacePipeline, *absHandle, k_InputPath, k_MagnitudePath);
+  AppendItkFilter(inPlacePipeline, *sqrtHandle, k_MagnitudePath, k_OutputPath);
+  DataStructure inPlaceGraph = CreateInputDataStructure();
+  LivenessPolicy livenessPolicy;
+  livenessPolicy.outputs = {k_OutputPath};
+  livenessPolicy.inPlaceFilters = {absHandle->getFilterId(), sqrtHandle->getFilterId()};
+  PipelineLiveness liveness(livenessPolicy);
+  if(!liveness.analyze(inPlacePipeline, inPlaceGraph))
+  {
+    std::cout << "The pipeline's liveness could not be analyzed" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  int result = EXIT_SUCCESS;
+  const auto* sqrtNode = dynamic_cast<const PipelineFilter*>(inPlacePipeline.at(1));
+  if(nullptr == sqrtNode || !liveness.getInPlaceArguments(1, *sqrtNode).has_value())
+  {
+    std::cout << "  The sqrt filter was not chosen to execute in place" << std::endl;
+    result = EXIT_FAILURE;
+  }
+  PipelineCheckpointer inPlaceRunner({});
+  inPlaceRunner.setLiveness(&liveness);
+  if(!inPlaceRunner.execute(inPlacePipeline, inPlaceGraph))
+  {
+    std::cout << "The pipeline failed to execute in place" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  const size_t numDifferences = CountDifferences(outOfPlaceGraph, inPlaceGraph);
+  std::cout << "In place vs. out of place: " << numDifferences << " differences" << std::endl;
+  std::cout << "Released " << liveness.getReleasedArrayCount() << " arrays (" << liveness.getReleasedBytes() << " bytes)" << std::endl;
+  if(numDifferences != 0 || nullptr != inPlaceGraph.getData(k_MagnitudePath))
+  {
+    result = EXIT_FAILURE;
+  }
+
+  std::cout << (result == EXIT_SUCCESS ? "PASSED" : "FAILED") << std::endl;
+  return result;
+}
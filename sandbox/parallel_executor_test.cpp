@@ -0,0 +1,250 @@
+/**
+ * Executes the same pipeline with ParallelPipelineExecutor and one filter after another, each
+ * on its own copy of a DataStructure, and compares the two results array by array. The
+ * pipeline creates arrays in several groups that hold an input array each, so most of its
+ * filters are independent and run concurrently. One filter per group reads an array another
+ * one created, and the trace of the parallel run must show it starting only after that one
+ * finished. The DataStructure the copies were made from must not change either, since copies
+ * share their arrays' values with it. Returns non-zero on any difference.
+ */
+
+#include "ComplexCoreFilterHandles.hpp"
+#include "DataStructureHash.hpp"
+#include "ParallelPipelineExecutor.hpp"
+#include "PipelineTrace.hpp"
+#include "ThreadPool.hpp"
+
+#include "sandbox_test_dirs.h"
+
+#include "complex/Common/Types.hpp"
+#include "complex/Core/Application.hpp"
+#include "complex/DataStructure/DataArray.hpp"
+#include "complex/DataStructure/DataGroup.hpp"
+#include "complex/DataStructure/DataStore.hpp"
+#include "complex/DataStructure/DataStructure.hpp"
+#include "complex/Filter/FilterHandle.hpp"
+#include "complex/Pipeline/Pipeline.hpp"
+#include "complex/Pipeline/PipelineFilter.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+using namespace complex;
+
+namespace
+{
+constexpr size_t k_NumGroups = 6;
+constexpr size_t k_NumInputValues = 4096;
+
+// -----------------------------------------------------------------------------
+std::string GroupName(size_t groupIndex)
+{
+  return fmt::format("Group {}", groupIndex);
+}
+
+/**
+ * @brief Creates one group per index with an "Input" array of values that differ per group.
+ */
+DataStructure CreateInputDataStructure()
+{
+  DataStructure dataStructure;
+  for(size_t groupIndex = 0; groupIndex < k_NumGroups; groupIndex++)
+  {
+    DataGroup* group = DataGroup::Create(dataStructure, GroupName(groupIndex));
+    auto store = std::make_shared<DataStore<float32>>(std::vector<usize>{k_NumInputValues}, std::vector<usize>{1});
+    for(size_t i = 0; i < k_NumInputValues; i++)
+    {
+      store->setValue(i, static_cast<float32>(groupIndex * k_NumInputValues + i));
+    }
+    DataArray<float32>::Create(dataStructure, "Input", store, group->getId());
+  }
+  return dataStructure;
+}
+
+// -----------------------------------------------------------------------------
+void AppendCreateDataArray(Pipeline& pipeline, const DataPath& outputPath, uint64_t numTuples, std::optional<DataPath> inputPath = {})
+{
+  std::unique_ptr<PipelineFilter> node = PipelineFilter::Create(ComplexCore::k_CreateDataArrayHandle);
+  Arguments arguments;
+  arguments.insert("numeric_type", std::any(NumericType::float32));
+  arguments.insert("component_count", std::any(1ULL));
+  arguments.insert("tuple_count", std::any(numTuples));
+  arguments.insert("output_data_array", std::any(outputPath));
+  // CreateDataArray does not use it, but the executor takes every existing DataPath argument as an array the node reads
+  if(inputPath.has_value())
+  {
+    arguments.insert("input_data_array", std::any(*inputPath));
+  }
+  node->setArguments(arguments);
+  pipeline.push_back(std::move(node));
+}
+
+/**
+ * @brief Three arrays per group, so the filters of different groups are independent of each
+ * other. The third reads the first, so it depends on the filter that created it.
+ */
+void AppendFilters(Pipeline& pipeline)
+{
+  for(size_t groupIndex = 0; groupIndex < k_NumGroups; groupIndex++)
+  {
+    const DataPath outputPath({GroupName(groupIndex), "Output"});
+    AppendCreateDataArray(pipeline, outputPath, 1000 + groupIndex);
+    AppendCreateDataArray(pipeline, DataPath({GroupName(groupIndex), "Second Output"}), 2000 + groupIndex);
+    AppendCreateDataArray(pipeline, DataPath({GroupName(groupIndex), "Derived Output"}), 1000 + groupIndex, outputPath);
+  }
+}
+
+/**
+ * @brief Prints and counts every node that started executing before a node it depends on
+ * finished, and every reading node whose dependency was not found.
+ */
+size_t CountOrderViolations(const std::vector<std::vector<size_t>>& dependencies, const std::vector<FilterTraceEvent>& events)
+{
+  // The first execution of each node; re-executions on a fresh copy only come later
+  std::map<size_t, FilterTraceEvent> firstExecutions;
+  for(const FilterTraceEvent& event : events)
+  {
+    if(event.phase == FilterTraceEvent::Phase::Execute && firstExecutions.count(event.index) == 0)
+    {
+      firstExecutions[event.index] = event;
+    }
+  }
+
+  size_t numViolations = 0;
+  for(size_t groupIndex = 0; groupIndex < k_NumGroups; groupIndex++)
+  {
+    const size_t creatorIndex = groupIndex * 3;
+    const size_t readerIndex = creatorIndex + 2;
+    if(std::find(dependencies[readerIndex].begin(), dependencies[readerIndex].end(), creatorIndex) == dependencies[readerIndex].end())
+    {
+      std::cout << "  Filter " << readerIndex << " does not depend on filter " << creatorIndex << " whose output it reads" << std::endl;
+      numViolations++;
+    }
+  }
+  for(size_t index = 0; index < dependencies.size(); index++)
+  {
+    for(size_t earlier : dependencies[index])
+    {
+      if(firstExecutions.count(index) == 0 || firstExecutions.count(earlier) == 0)
+      {
+        std::cout << "  Filter " << index << " or " << earlier << " was not traced" << std::endl;
+        numViolations++;
+        continue;
+      }
+      const FilterTraceEvent& dependency = firstExecutions[earlier];
+      if(firstExecutions[index].startMicroseconds < dependency.startMicroseconds + dependency.wallMicroseconds)
+      {
+        std::cout << "  Filter " << index << " started before filter " << earlier << " finished" << std::endl;
+        numViolations++;
+      }
+    }
+  }
+  return numViolations;
+}
+
+/**
+ * @brief Prints and counts every path whose object or values differ between the two inventories.
+ */
+size_t CountDifferences(const std::string& name, const DataStructureInventory& expectedInventory, const DataStructureInventory& actualInventory)
+{
+  size_t numDifferences = 0;
+  for(const auto& [path, entry] : expectedInventory.objects)
+  {
+    auto actualEntry = actualInventory.objects.find(path);
+    if(actualEntry == actualInventory.objects.end() || actualEntry->second.hash != entry.hash)
+    {
+      std::cout << "  " << name << ": " << path << (actualEntry == actualInventory.objects.end() ? " is missing" : " has other values") << std::endl;
+      numDifferences++;
+    }
+  }
+  for(const auto& [path, entry] : actualInventory.objects)
+  {
+    if(expectedInventory.objects.count(path) == 0)
+    {
+      std::cout << "  " << name << ": " << path << " was not expected" << std::endl;
+      numDifferences++;
+    }
+  }
+  if(numDifferences == 0 && expectedInventory.structureHash != actualInventory.structureHash)
+  {
+    std::cout << "  " << name << ": the hierarchies differ" << std::endl;
+    numDifferences++;
+  }
+  return numDifferences;
+}
+} // namespace
+
+// -----------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+  Application app;
+  const fs::path pluginPath = fmt::format("{}/{}", unit_test::k_BuildDir, unit_test::k_BuildTypeDir);
+  app.loadPlugins(pluginPath, true);
+
+  const DataStructure input = CreateInputDataStructure();
+  const DataStructureInventory inputInventory = TakeDataStructureInventory(input, true);
+
+  int result = EXIT_SUCCESS;
+  Pipeline serialPipeline;
+  AppendFilters(serialPipeline);
+  DataStructure serialGraph = input;
+  if(!serialPipeline.execute(serialGraph))
+  {
+    std::cout << "The pipeline failed to execute one filter after another" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  ThreadPool threadPool(4);
+  ParallelPipelineExecutor executor(threadPool);
+  PipelineTracer tracer;
+  executor.setTracer(&tracer);
+  Pipeline parallelPipeline;
+  AppendFilters(parallelPipeline);
+  DataStructure parallelGraph = input;
+  std::optional<std::vector<PipelineNodeAccess>> accesses = ParallelPipelineExecutor::FindNodeAccesses(parallelPipeline, input);
+  if(!accesses.has_value())
+  {
+    std::cout << "The pipeline failed to preflight" << std::endl;
+    return EXIT_FAILURE;
+  }
+  if(!executor.execute(parallelPipeline, parallelGraph))
+  {
+    std::cout << "The pipeline failed to execute in parallel" << std::endl;
+    return EXIT_FAILURE;
+  }
+  std::cout << "Filters executed concurrently: up to " << executor.getMaxConcurrency() << std::endl;
+  if(executor.getMaxConcurrency() < 2)
+  {
+    std::cout << "  Independent filters did not run concurrently" << std::endl;
+    result = EXIT_FAILURE;
+  }
+  const size_t numOrderViolations = CountOrderViolations(ParallelPipelineExecutor::BuildDependencies(*accesses), tracer.getEvents());
+  std::cout << "Dependencies: " << numOrderViolations << " violated" << std::endl;
+  if(numOrderViolations != 0)
+  {
+    result = EXIT_FAILURE;
+  }
+
+  const size_t numDifferences = CountDifferences("parallel", TakeDataStructureInventory(serialGraph, true), TakeDataStructureInventory(parallelGraph, true));
+  std::cout << "Parallel vs. serial: " << numDifferences << " differences" << std::endl;
+  const size_t numInputChanges = CountDifferences("input", inputInventory, TakeDataStructureInventory(input, true));
+  std::cout << "Input: " << numInputChanges << " changes" << std::endl;
+  if(numDifferences != 0 || numInputChanges != 0)
+  {
+    result = EXIT_FAILURE;
+  }
+
+  std::cout << (result == EXIT_SUCCESS ? "PASSED" : "FAILED") << std::endl;
+  return result;
+}
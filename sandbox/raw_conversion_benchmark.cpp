@@ -0,0 +1,116 @@
+/**
+ * Compares reading big endian raw files with the byte swap/convert fused into the
+ * chunked read (ReadRawDataStore with a RawSourceFormat) against the old path of
+ * reading the file as-is and then converting the whole array in a second pass.
+ */
+
+#include "ConversionKernels.hpp"
+#include "RawFileReader.hpp"
+
+#include "complex/DataStructure/DataStore.hpp"
+
+#include "sandbox_test_dirs.h"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <vector>
+
+namespace fs = std::filesystem;
+using namespace complex;
+
+namespace
+{
+constexpr size_t k_NumValues = 32 * 1024 * 1024;
+constexpr int32_t k_NumIterations = 5;
+
+/**
+ * @brief Writes k_NumValues values of SrcT in big endian order.
+ */
+template <typename SrcT>
+void WriteBigEndianFile(const fs::path& filePath)
+{
+  std::vector<SrcT> values(k_NumValues);
+  for(size_t i = 0; i < k_NumValues; i++)
+  {
+    values[i] = static_cast<SrcT>(i % 1021);
+  }
+  std::vector<SrcT> swapped(k_NumValues);
+  // Swapping native values into a buffer of SrcT gives the big endian byte image on little endian hosts
+  ConversionKernels::ConvertValues<SrcT, SrcT>(reinterpret_cast<const std::byte*>(values.data()), swapped.data(), k_NumValues, k_NativeEndian != Endian::Big);
+  std::ofstream outFile(filePath, std::ios::out | std::ios::binary);
+  outFile.write(reinterpret_cast<const char*>(swapped.data()), static_cast<std::streamsize>(swapped.size() * sizeof(SrcT)));
+}
+
+template <typename FuncT>
+double BestTimeMilliseconds(FuncT&& func)
+{
+  double best = std::numeric_limits<double>::max();
+  for(int32_t i = 0; i < k_NumIterations; i++)
+  {
+    auto start = std::chrono::steady_clock::now();
+    func();
+    auto stop = std::chrono::steady_clock::now();
+    best = std::min(best, std::chrono::duration<double, std::milli>(stop - start).count());
+  }
+  return best;
+}
+
+/**
+ * @brief Times both paths for one source type converted into DstT.
+ */
+template <typename SrcT, typename DstT>
+void RunBenchmark(const std::string& label, DataType sourceType, const fs::path& filePath)
+{
+  const RawSourceFormat sourceFormat = {sourceType, Endian::Big};
+
+  std::shared_ptr<IDataStore<DstT>> fusedStore;
+  double fusedTime = BestTimeMilliseconds([&]() { fusedStore = ReadRawDataStore<DstT>(filePath, k_NumValues, {1}, RawReadMode::Copy, nullptr, sourceFormat); });
+
+  std::shared_ptr<DataStore<DstT>> twoPassStore;
+  double twoPassTime = BestTimeMilliseconds([&]() {
+    std::shared_ptr<IDataStore<SrcT>> rawStore = ReadRawDataStore<SrcT>(filePath, k_NumValues, {1}, RawReadMode::Copy);
+    const SrcT* rawValues = dynamic_cast<DataStore<SrcT>&>(*rawStore).data();
+    twoPassStore = std::make_shared<DataStore<DstT>>(std::vector<usize>{k_NumValues}, std::vector<usize>{1});
+    ConvertRawValues(sourceFormat, reinterpret_cast<const std::byte*>(rawValues), twoPassStore->data(), k_NumValues);
+  });
+
+  bool identical = (nullptr != fusedStore);
+  for(size_t i = 0; identical && i < k_NumValues; i++)
+  {
+    identical = (fusedStore->getValue(i) == twoPassStore->getValue(i));
+  }
+
+  const double megaBytes = static_cast<double>(k_NumValues * sizeof(SrcT)) / (1024.0 * 1024.0);
+  std::cout << fmt::format("{:<28} fused: {:>9.2f} ms ({:>8.1f} MB/s)   copy-then-convert: {:>9.2f} ms ({:>8.1f} MB/s)   speedup: {:.2f}x   identical: {}", label, fusedTime,
+                           megaBytes / (fusedTime / 1000.0), twoPassTime, megaBytes / (twoPassTime / 1000.0), twoPassTime / fusedTime, identical)
+            << std::endl;
+}
+} // namespace
+
+int main(int32_t argc, char** argv)
+{
+  const fs::path outputDir = fs::path(complex::unit_test::k_ComplexBinaryDir.str());
+  const fs::path int16Path = outputDir / "raw_conversion_benchmark_int16_be.raw";
+  const fs::path float32Path = outputDir / "raw_conversion_benchmark_float32_be.raw";
+
+  std::cout << "Writing " << k_NumValues << " value benchmark files to " << outputDir << std::endl;
+  WriteBigEndianFile<int16>(int16Path);
+  WriteBigEndianFile<float32>(float32Path);
+
+  RunBenchmark<int16, float32>("int16 (big endian) -> float", DataType::int16, int16Path);
+  RunBenchmark<int16, int32>("int16 (big endian) -> int32", DataType::int16, int16Path);
+  RunBenchmark<float32, float32>("float (big endian) -> float", DataType::float32, float32Path);
+  RunBenchmark<float32, float64>("float (big endian) -> double", DataType::float32, float32Path);
+
+  fs::remove(int16Path);
+  fs::remove(float32Path);
+  return 0;
+}
@@ -12,146 +12,600 @@
 #include "complex/Pipeline/Pipeline.hpp"
 #include "complex/Pipeline/PipelineFilter.hpp"
 #include "complex/Plugin/AbstractPlugin.hpp"
-#include "complex/Utilities/Parsing/HDF5/H5FileReader.hpp"
 #include "complex/Utilities/Parsing/HDF5/H5FileWriter.hpp"
 
 
+#include "AsyncH5Writer.hpp"
+#include "ComplexCoreFilterHandles.hpp"
+#include "ContentHash.hpp"
+#include "FilterResultCache.hpp"
+#include "H5DataStructureWriter.hpp"
+#include "H5LazyReader.hpp"
+#include "H5SubvolumeReader.hpp"
+#include "H5DatasetUpdate.hpp"
+#include "H5Types.hpp"
+#include "IngestManifest.hpp"
+#include "ParallelPipelineExecutor.hpp"
+#include "PipelineBatchRunner.hpp"
+#include "PipelineCheckpoint.hpp"
+#include "PipelineLiveness.hpp"
+#include "PipelineTrace.hpp"
+#include "RawByteSource.hpp"
+#include "RawFileReader.hpp"
+#include "RawIngestScheduler.hpp"
+#include "RawSidecar.hpp"
+#include "SharedDataStore.hpp"
+#include "StoreArena.hpp"
+#include "ThreadPool.hpp"
 #include "sandbox_test_dirs.h"
 
 #include <fmt/format.h>
+#include <fmt/ranges.h>
 
 #include <hdf5.h>
 
+#include <algorithm>
 #include <any>
+#include <chrono>
 #include <cstdint>
 #include <cstdio>
+#include <cstdlib>
 #include <filesystem>
+#include <future>
 #include <iostream>
+#include <map>
 #include <memory>
-
-#define CREATE_FILTER_HANDLE_CONSTANT(var_name, filter_uuid_string, plugin_uuid_string) \
-const FilterHandle k_##var_name(Uuid::FromString(filter_uuid_string).value(), Uuid::FromString(plugin_uuid_string).value());
-
+#include <optional>
+#include <set>
+#include <string>
+#include <tuple>
 
 namespace fs = std::filesystem;
 
-
-namespace complex
-{
-
-namespace ComplexCore
-{
-// Plugin Uuid
-constexpr StringLiteral k_ComplexCore_Uuid = "05cc618b-781f-4ac0-b9ac-43f26ce1854f";
-// Filter Uuids
-constexpr StringLiteral k_ExampleFilter2_Uuid = "1307bbbc-112d-4aaa-941f-58253787b17e";
-constexpr StringLiteral k_CreateDataArray_Uuid = "67041f9b-bdc6-4122-acc6-c9fe9280e90d";
-constexpr StringLiteral k_ImportTextFilter_Uuid = "25f7df3e-ca3e-4634-adda-732c0e56efd4";
-
-// Filter Handles
-CREATE_FILTER_HANDLE_CONSTANT(ExampleFilter2Handle, k_ExampleFilter2_Uuid, k_ComplexCore_Uuid)
-CREATE_FILTER_HANDLE_CONSTANT(CreateDataArrayHandle, k_CreateDataArray_Uuid, k_ComplexCore_Uuid)
-CREATE_FILTER_HANDLE_CONSTANT(ImportTextFilterHandle, k_ImportTextFilter_Uuid, k_ComplexCore_Uuid)
-}
-}
 using namespace complex;
 
 
 template <typename T>
-DataArray<T>* ReadFromFile(const std::string& filename, const std::string& name, DataStructure* dataGraph,
-                           size_t numTuples, const std::vector<size_t>& numComponents, DataObject::IdType parentId = {})
+DataArray<T>* ReadFromFile(const std::string& filename, const std::string& name, DataStructure* dataGraph, const std::vector<size_t>& tupleShape, const std::vector<size_t>& numComponents,
+                           std::optional<DataObject::IdType> parentId = {}, RawReadMode readMode = RawReadMode::Copy, std::optional<RawSourceFormat> sourceFormat = {})
 {
   std::cout << "  Reading file " << filename << std::endl;
-  using DataStoreType = DataStore<T>;
   using ArrayType = DataArray<T>;
-  constexpr size_t defaultBlocksize = 1048576;
 
-  if(!fs::exists(filename))
+  // The store is fully read before anything is inserted into the DataStructure
+  std::shared_ptr<IDataStore<T>> dataStore = ReadRawDataStore<T>(filename, tupleShape, numComponents, readMode, nullptr, sourceFormat);
+  if(nullptr == dataStore)
   {
-    std::cout << "File Does Not Exist:'" << filename << "'" << std::endl;
     return nullptr;
   }
+  return ArrayType::Create(*dataGraph, name, dataStore, parentId);
+}
 
-  std::shared_ptr<DataStoreType> dataStore = std::shared_ptr<DataStoreType>( new DataStoreType({numTuples}, numComponents));
-  ArrayType* dataArray = ArrayType::Create(*dataGraph, name, dataStore, parentId);
-
-  const size_t fileSize = fs::file_size(filename);
-  const size_t numBytesToRead = dataArray->getSize() * sizeof(T);
-  if(numBytesToRead != fileSize)
+/**
+ * @brief Returns true if the array's store writes a placeholder for LinkH5Dataset() to replace
+ * (see SharedDataStore).
+ * @param dataObject
+ * @return
+ */
+bool WritesSharedStoreLink(const DataObject* dataObject)
+{
+  const auto* dataArray = dynamic_cast<const IDataArray*>(dataObject);
+  if(nullptr == dataArray)
   {
-    std::cout << "FileSize and Allocated Size do not match" << std::endl;
-    return nullptr;
+    return false;
   }
+  bool isLink = false;
+  VisitNumericDataType(dataArray->getDataType(), [&](auto value) {
+    using T = decltype(value);
+    const auto* typedArray = dynamic_cast<const DataArray<T>*>(dataArray);
+    const auto* sharedStore = (nullptr != typedArray) ? dynamic_cast<const SharedDataStore<T>*>(typedArray->getDataStore()) : nullptr;
+    isLink = (nullptr != sharedStore) && sharedStore->isLink();
+  });
+  return isLink;
+}
 
-  FILE* f = std::fopen(filename.c_str(), "rb");
-  if(f == nullptr)
+/**
+ * @brief Queues a file for ingest as the array its '<name>.raw.json' sidecar describes, or as
+ * bytes when it has no sidecar or the sidecar does not fit the file.
+ * @param ingestScheduler
+ * @param filePath
+ * @param fileSize
+ * @param sidecar
+ * @param parentId
+ * @param parentPath Path of the parent group relative to the root, ending in '/'. Empty for the root.
+ * @return The path of the array relative to the root, which is also its dataset path in the HDF5 file.
+ */
+std::string PushRawFile(RawIngestScheduler& ingestScheduler, const fs::path& filePath, uint64_t fileSize, const std::optional<RawSidecar>& sidecar, std::optional<DataObject::IdType> parentId,
+                        const std::string& parentPath)
+{
+  if(sidecar.has_value() && ingestScheduler.push_back(filePath, *sidecar, parentId, RawReadMode::MemoryMapCopyOnWrite))
   {
-    return nullptr;
+    return parentPath + sidecar->name;
   }
+  ingestScheduler.push_back<uint8_t>(filePath, filePath.filename().string(), fileSize, {1ULL}, parentId, RawReadMode::MemoryMapCopyOnWrite);
+  return parentPath + filePath.filename().string();
+}
 
-  std::byte* chunkptr = reinterpret_cast<std::byte*>(dataStore->data());
+/**
+ * @brief Ingests files into a DataStructure of their own, laid out like the one
+ * ReadFileSystemIntoDataGraph() builds, and writes it to an HDF5 file so the datasets can be
+ * copied into the previous output. Duplicates are not looked for; every file gets its own dataset.
+ * @param addedFiles Sorted by path. Their dataset paths are filled in.
+ * @param appendFilePath
+ * @param threadPool
+ * @param verbose
+ * @return false if the file could not be written.
+ */
+bool WriteAddedFiles(const std::vector<IngestManifestEntry*>& addedFiles, const fs::path& appendFilePath, ThreadPool& threadPool, bool verbose)
+{
+  DataStructure dataStructure;
+  RawIngestScheduler ingestScheduler(threadPool);
+  ingestScheduler.setLoggingEnabled(verbose);
+  for(IngestManifestEntry* entry : addedFiles)
+  {
+    const fs::path entryPath = entry->path;
+    std::optional<DataObject::IdType> parentId;
+    std::string parentPath;
+    if(const fs::path parentDir = entryPath.parent_path(); !parentDir.empty() && parentDir != ".")
+    {
+      parentId = dataStructure.makePath(DataPath::FromString(parentDir.u8string()).value()).value().getId();
+      parentPath = parentDir.generic_string() + "/";
+    }
+    entry->datasetPath = PushRawFile(ingestScheduler, entryPath, entry->size, RawSidecar::Read(entryPath, entry->size), parentId, parentPath);
+  }
+  ingestScheduler.insertInto(dataStructure);
 
-  // Now start reading the data in chunks if needed.
-  size_t chunkSize = std::min(numBytesToRead, defaultBlocksize);
+  std::lock_guard<std::recursive_mutex> lock(GetH5LibraryMutex());
+  Result<H5::FileWriter> result = H5::FileWriter::CreateFile(appendFilePath);
+  if(!result.valid())
+  {
+    return false;
+  }
+  H5::FileWriter fileWriter = std::move(result.value());
+  return dataStructure.writeHdf5(fileWriter) >= 0;
+}
 
-  size_t masterCounter = 0;
-  while(masterCounter < numBytesToRead)
+/**
+ * @brief Tries to bring an HDF5 file written by ReadFileSystemIntoDataGraph() up to date
+ * without rewriting it. Datasets of removed files are unlinked, files whose contents changed
+ * are overwritten in place and new files are ingested on their own and their datasets copied
+ * in. A file whose size or sidecar changed may now hold a different type or shape of array,
+ * and a dataset that duplicate files share (see SharedDataStore) can not be overwritten for
+ * just one of them; both are unlinked and added again.
+ *
+ * Only files with a new modified time but the same size are hashed; new and reshaped files
+ * are read once, by their ingest. Unlinked datasets leave their space in the file until the
+ * next full rewrite.
+ * @param currentFiles Manifest entries for the files on disk now. Content hashes and dataset paths are filled in.
+ * @param previous
+ * @param outputFilePath
+ * @param threadPool Hashes the files whose modified time changed and reads the new files
+ * @param verbose
+ * @return false if a full rewrite is needed. The HDF5 file is unchanged in that case unless an update failed part way.
+ * Every content hash that was filled in is valid either way.
+ */
+bool UpdateFileSystemDataGraph(std::vector<IngestManifestEntry>& currentFiles, const IngestManifest& previous, const fs::path& outputFilePath, ThreadPool& threadPool, bool verbose)
+{
+  std::map<std::pair<uint64_t, uint64_t>, size_t> previousCopies;
+  std::set<std::string> currentPaths;
+  for(const auto& entry : currentFiles)
   {
-    size_t bytesRead = std::fread(chunkptr, sizeof(std::byte), chunkSize, f);
-    chunkptr += bytesRead;
-    masterCounter += bytesRead;
+    currentPaths.insert(entry.path);
+  }
+  std::vector<std::string> removedDatasets;
+  for(const auto& [path, previousEntry] : previous.getEntries())
+  {
+    if(previousEntry.contentHash.has_value())
+    {
+      previousCopies[{previousEntry.size, *previousEntry.contentHash}]++;
+    }
+    if(currentPaths.count(path) == 0)
+    {
+      removedDatasets.push_back(previousEntry.datasetPath);
+    }
+  }
 
-    size_t bytesLeft = numBytesToRead - masterCounter;
+  // Files whose size and modified time are unchanged are trusted; the rest are hashed to see if the contents really changed
+  std::vector<IngestManifestEntry*> addedFiles;
+  std::vector<std::tuple<IngestManifestEntry*, const IngestManifestEntry*, std::future<std::optional<uint64_t>>>> hashes;
+  for(auto& entry : currentFiles)
+  {
+    const IngestManifestEntry* previousEntry = previous.find(entry.path);
+    if(nullptr == previousEntry)
+    {
+      addedFiles.push_back(&entry);
+      continue;
+    }
+    entry.datasetPath = previousEntry->datasetPath;
+    if(previousEntry->size != entry.size || previousEntry->sidecarSignature != entry.sidecarSignature)
+    {
+      removedDatasets.push_back(previousEntry->datasetPath);
+      addedFiles.push_back(&entry);
+      continue;
+    }
+    if(previousEntry->modifiedTime != entry.modifiedTime)
+    {
+      hashes.emplace_back(&entry, previousEntry, threadPool.submit([filePath = fs::path(entry.path)]() { return ContentHasher::HashFile(filePath); }));
+      continue;
+    }
+    entry.contentHash = previousEntry->contentHash;
+  }
 
-    if(bytesLeft < chunkSize)
+  std::vector<IngestManifestEntry*> changedFiles;
+  for(auto& [entry, previousEntry, hash] : hashes)
+  {
+    entry->contentHash = hash.get();
+    if(!entry->contentHash.has_value())
     {
-      chunkSize = bytesLeft;
+      return false;
+    }
+    if(entry->contentHash == previousEntry->contentHash)
+    {
+      continue;
+    }
+    if(previousEntry->contentHash.has_value() && previousCopies[{previousEntry->size, *previousEntry->contentHash}] > 1)
+    {
+      removedDatasets.push_back(previousEntry->datasetPath);
+      addedFiles.push_back(entry);
+    }
+    else
+    {
+      changedFiles.push_back(entry);
     }
   }
+  if(removedDatasets.empty() && addedFiles.empty() && changedFiles.empty())
+  {
+    std::cout << "No changes since the last ingest of " << currentFiles.size() << " files" << std::endl;
+    return true;
+  }
 
-  fclose(f);
+  // Sorted like a full ingest so the new groups and arrays get their ids in the same order
+  std::sort(addedFiles.begin(), addedFiles.end(), [](const IngestManifestEntry* lhs, const IngestManifestEntry* rhs) { return fs::path(lhs->path) < fs::path(rhs->path); });
+  fs::path appendFilePath = outputFilePath;
+  appendFilePath += ".append.tmp";
+  std::error_code errorCode;
+  if(!addedFiles.empty() && !WriteAddedFiles(addedFiles, appendFilePath, threadPool, verbose))
+  {
+    fs::remove(appendFilePath, errorCode);
+    return false;
+  }
 
-  return dataArray;
+  std::lock_guard<std::recursive_mutex> lock(GetH5LibraryMutex());
+  const hid_t fileId = H5Fopen(outputFilePath.string().c_str(), H5F_ACC_RDWR, H5P_DEFAULT);
+  if(fileId < 0)
+  {
+    fs::remove(appendFilePath, errorCode);
+    return false;
+  }
+  bool success = true;
+  for(const std::string& datasetPath : removedDatasets)
+  {
+    if(verbose)
+    {
+      std::cout << "  Removing " << datasetPath << std::endl;
+    }
+    if(!RemoveH5Dataset(fileId, "/" + datasetPath))
+    {
+      success = false;
+      break;
+    }
+  }
+  for(size_t i = 0; success && i < changedFiles.size(); i++)
+  {
+    const IngestManifestEntry* entry = changedFiles[i];
+    if(verbose)
+    {
+      std::cout << "  Updating " << entry->datasetPath << " from " << entry->path << std::endl;
+    }
+    RawSourceFormat sourceFormat = {DataType::uint8, k_NativeEndian};
+    if(std::optional<RawSidecar> sidecar = RawSidecar::Read(entry->path, entry->size); sidecar.has_value())
+    {
+      sourceFormat = sidecar->getSourceFormat();
+    }
+    success = OverwriteH5DatasetFromRawFile(fileId, "/" + entry->datasetPath, entry->path, sourceFormat);
+  }
+  if(success && !addedFiles.empty())
+  {
+    std::vector<std::string> datasetPaths;
+    for(const IngestManifestEntry* entry : addedFiles)
+    {
+      datasetPaths.push_back("/" + entry->datasetPath);
+    }
+    const hid_t appendFileId = H5Fopen(appendFilePath.string().c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+    success = (appendFileId >= 0) && CopyH5Datasets(appendFileId, fileId, datasetPaths);
+    if(appendFileId >= 0)
+    {
+      H5Fclose(appendFileId);
+    }
+  }
+  H5Fclose(fileId);
+  fs::remove(appendFilePath, errorCode);
+  if(success)
+  {
+    std::cout << fmt::format("Updated {} files in place: {} overwritten, {} added, {} removed", currentFiles.size(), changedFiles.size(), addedFiles.size(), removedDatasets.size()) << std::endl;
+  }
+  return success;
 }
 
-void ReadFileSystemIntoDataGraph()
+/**
+ * @brief Imports every file below the binary directory into a DataStructure and writes it to an HDF5 file.
+ * The directory tree is enumerated first, then every file is read concurrently on a work stealing
+ * ThreadPool while the arrays are inserted in sorted path order, so the result does not depend on
+ * how the reads were scheduled.
+ *
+ * A manifest of every file's size, modified time and content hash is saved next to the HDF5 file.
+ * When 'incremental' is set, the existing HDF5 file is updated from it instead: only new files and
+ * files whose contents changed are read (see UpdateFileSystemDataGraph()).
+ * @param verbose Print every directory and file as it is processed. A throughput summary is always printed.
+ * @param incremental Update the previous output in place when possible instead of rewriting it.
+ */
+void ReadFileSystemIntoDataGraph(bool verbose = false, bool incremental = true)
 {
   std::shared_ptr<DataStructure> dataGraph = std::shared_ptr<DataStructure>(new DataStructure);
 
   fs::path startingDir = fs::path(complex::unit_test::k_ComplexBinaryDir);
   fs::current_path(startingDir);
 
-  LinkedPath currentDir;//  = dataGraph->makePath(DataPath::FromString(startingDir.filename().u8string()).value()).value();
+  const fs::path k_OutputFileName = "file_system_test.h5";
+  const fs::path k_ManifestFileName = "file_system_test.h5.manifest.json";
+  fs::path filePath = fmt::format("{}/{}", complex::unit_test::k_ComplexBinaryDir, k_OutputFileName.string());
+  fs::path manifestPath = fmt::format("{}/{}", complex::unit_test::k_ComplexBinaryDir, k_ManifestFileName.string());
+
+  // A previous run's output lives in the directory being walked. It must not be mapped since it is about to be overwritten.
+  // Every file this function writes, including the temporary ones, is skipped by its full path; files in other
+  // directories that happen to share the output's name are ingested like any other.
+  std::set<fs::path> outputPaths;
+  for(const fs::path& outputPath : {filePath, fs::path(filePath.string() + ".append.tmp"), manifestPath, fs::path(manifestPath.string() + ".tmp")})
+  {
+    outputPaths.insert(fs::weakly_canonical(outputPath));
+  }
+  // The walk does not follow directory links, so the walked paths only need to be made absolute
+  const fs::path walkDir = fs::current_path();
+  auto isOutputFile = [&outputPaths, &walkDir](const fs::path& entryPath) { return outputPaths.count((walkDir / entryPath).lexically_normal()) != 0; };
+
+  auto startTime = std::chrono::steady_clock::now();
+
+  // The directory iteration order is up to the file system; sorting makes the DataObject ids repeatable.
+  // A directory always sorts before its contents.
+  std::vector<fs::directory_entry> entries;
   for(auto& p: fs::recursive_directory_iterator("."))
   {
-    std::cout  << (int)(p.is_directory()) << p.path() << '\n';
-    if(p.is_directory())
+    if(p.is_directory() || (p.is_regular_file() && !isOutputFile(p.path()) && !RawSidecar::IsSidecar(p.path())))
+    {
+      entries.push_back(p);
+    }
+  }
+  std::sort(entries.begin(), entries.end(), [](const fs::directory_entry& lhs, const fs::directory_entry& rhs) { return lhs.path() < rhs.path(); });
+
+  std::vector<IngestManifestEntry> currentFiles;
+  for(auto& p : entries)
+  {
+    if(p.is_regular_file())
     {
-      currentDir = dataGraph->makePath(DataPath::FromString(p.path().u8string()).value()).value();
+      IngestManifestEntry entry;
+      entry.path = p.path().generic_string();
+      entry.size = p.file_size();
+      entry.modifiedTime = IngestManifest::ModifiedTime(p.path());
+      entry.sidecarSignature = IngestManifest::FileSignature(RawSidecar::PathFor(p.path()));
+      currentFiles.push_back(std::move(entry));
     }
-    else if (p.is_regular_file())
+  }
+
+  ThreadPool threadPool;
+
+  if(incremental && fs::exists(filePath))
+  {
+    if(std::optional<IngestManifest> previous = IngestManifest::Load(manifestPath); previous.has_value())
     {
-      if(currentDir.isValid())
+      if(UpdateFileSystemDataGraph(currentFiles, *previous, filePath, threadPool, verbose))
       {
-        ReadFromFile<uint8_t>(p.path().u8string(), p.path().filename(), dataGraph.get(), p.file_size(), {1ULL}, currentDir.getId());
-      }
-      else
-      {
-        ReadFromFile<uint8_t>(p.path().u8string(), p.path().filename(), dataGraph.get(), p.file_size(), {1ULL});
+        IngestManifest manifest;
+        for(auto& entry : currentFiles)
+        {
+          manifest.insert(std::move(entry));
+        }
+        manifest.save(manifestPath);
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+        std::cout << fmt::format("Incremental ingest finished in {:.3f} s", seconds) << std::endl;
+        return;
       }
+      std::cout << "Could not update " << k_OutputFileName << " in place. Rewriting it" << std::endl;
     }
   }
 
-  fs::path filePath = fmt::format("{}/file_system_test.h5", complex::unit_test::k_ComplexBinaryDir);
+  // Byte-identical files (calibration and background frames) are only read once and share a single DataStore.
+  // Only files of the same size can be identical, so only those are hashed up front; the rest are read once, by
+  // the ingest. Hashes a failed incremental update already has are kept.
+  std::map<uint64_t, size_t> filesPerSize;
+  for(const auto& entry : currentFiles)
+  {
+    filesPerSize[entry.size]++;
+  }
+  std::vector<std::future<std::optional<uint64_t>>> hashes(currentFiles.size());
+  for(size_t i = 0; i < currentFiles.size(); i++)
+  {
+    const IngestManifestEntry& entry = currentFiles[i];
+    if(entry.size > 0 && filesPerSize[entry.size] > 1 && !entry.contentHash.has_value())
+    {
+      hashes[i] = threadPool.submit([filePath = fs::path(entry.path)]() { return ContentHasher::HashFile(filePath); });
+    }
+  }
+  std::vector<bool> hashFailed(currentFiles.size(), false);
+  for(size_t i = 0; i < currentFiles.size(); i++)
+  {
+    if(hashes[i].valid())
+    {
+      currentFiles[i].contentHash = hashes[i].get();
+      hashFailed[i] = !currentFiles[i].contentHash.has_value();
+    }
+  }
+
+  // Most files in a tree are small; packing them into a few slabs saves an allocation (and a mapping) per file
+  auto storeArena = std::make_shared<StoreArena>();
+  RawIngestScheduler ingestScheduler(threadPool);
+  ingestScheduler.setLoggingEnabled(verbose);
+  ingestScheduler.setArena(storeArena);
+
+  // Files only share a store when their bytes AND the way they are interpreted match
+  struct DuplicateKey
+  {
+    uint64_t size = 0;
+    uint64_t contentHash = 0;
+    std::string layout;
+
+    bool operator<(const DuplicateKey& other) const
+    {
+      return std::tie(size, contentHash, layout) < std::tie(other.size, other.contentHash, other.layout);
+    }
+  };
+  struct FirstCopy
+  {
+    size_t loadIndex = 0;
+    std::string datasetPath;
+  };
+  std::map<DuplicateKey, FirstCopy> firstCopies;
+  struct DatasetLink
+  {
+    std::string targetPath; // Dataset holding the values
+    std::string linkPath;   // Placeholder to replace with a link
+    size_t loadIndex = 0;
+  };
+  std::vector<DatasetLink> datasetLinks;
+
+  std::map<fs::path, DataObject::IdType> directoryIds;
+  size_t numBytes = 0;
+  size_t numDuplicates = 0;
+  size_t fileIndex = 0;
+  std::vector<size_t> loadIndices(currentFiles.size()); // The ingest load of each file, to find the ones that failed
+  for(auto& p : entries)
+  {
+    if(verbose)
+    {
+      std::cout  << (int)(p.is_directory()) << p.path() << '\n';
+    }
+    if(p.is_directory())
+    {
+      LinkedPath currentDir = dataGraph->makePath(DataPath::FromString(p.path().u8string()).value()).value();
+      directoryIds[p.path()] = currentDir.getId();
+      continue;
+    }
+
+    loadIndices[fileIndex] = ingestScheduler.size();
+    IngestManifestEntry& manifestEntry = currentFiles[fileIndex++];
+    const bool isHashed = manifestEntry.contentHash.has_value();
+    std::optional<DataObject::IdType> parentId;
+    std::string parentPath;
+    if(auto parentIter = directoryIds.find(p.path().parent_path()); parentIter != directoryIds.end())
+    {
+      parentId = parentIter->second;
+      parentPath = p.path().parent_path().generic_string() + "/";
+    }
+
+    // Files described by a '<name>.raw.json' sidecar land as the right type and shape; everything else is imported as bytes.
+    std::optional<RawSidecar> sidecar = RawSidecar::Read(p.path(), p.file_size());
+    const std::string arrayName = sidecar.has_value() ? sidecar->name : p.path().filename().string();
+    manifestEntry.datasetPath = parentPath + arrayName;
+
+    DuplicateKey duplicateKey = {manifestEntry.size, manifestEntry.contentHash.value_or(0), "bytes"};
+    if(sidecar.has_value())
+    {
+      duplicateKey.layout = fmt::format("{}:{}:{}:{}", static_cast<int32_t>(sidecar->dataType), static_cast<int32_t>(sidecar->byteOrder), fmt::join(sidecar->tupleDims, "x"),
+                                        fmt::join(sidecar->componentDims, "x"));
+    }
+    if(auto firstCopy = firstCopies.find(duplicateKey); isHashed && manifestEntry.size > 0 && firstCopy != firstCopies.end())
+    {
+      datasetLinks.push_back({"/" + firstCopy->second.datasetPath, "/" + manifestEntry.datasetPath, ingestScheduler.size()});
+      ingestScheduler.push_back_duplicate(firstCopy->second.loadIndex, arrayName, parentId);
+      numDuplicates++;
+      continue;
+    }
+
+    const size_t loadIndex = ingestScheduler.size();
+    numBytes += p.file_size();
+    manifestEntry.datasetPath = PushRawFile(ingestScheduler, p.path(), p.file_size(), sidecar, parentId, parentPath);
+    if(isHashed)
+    {
+      firstCopies[duplicateKey] = {loadIndex, manifestEntry.datasetPath};
+    }
+  }
+  const std::vector<DataObject*> dataObjects = ingestScheduler.insertInto(*dataGraph);
+
+  const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+  const double megaBytes = static_cast<double>(numBytes) / (1024.0 * 1024.0);
+  std::cout << fmt::format("Read {} files ({:.1f} MB) in {:.3f} s: {:.1f} files/s, {:.1f} MB/s using {} threads ({} tasks stolen). {} duplicate files share a store.", currentFiles.size(),
+                           megaBytes, seconds, static_cast<double>(currentFiles.size()) / seconds, megaBytes / seconds, threadPool.size(), threadPool.getStealCount(), numDuplicates)
+            << std::endl;
+  std::cout << fmt::format("Packed {} small arrays ({:.1f} MB) into {} arena slabs of {} MB", storeArena->getAllocationCount(),
+                           static_cast<double>(storeArena->getBytesAllocated()) / (1024.0 * 1024.0), storeArena->getSlabCount(), storeArena->getSlabSize() / (1024 * 1024))
+            << std::endl;
+
+  // Only duplicates that still share the values are written as placeholders; the rest write their own values
+  datasetLinks.erase(std::remove_if(datasetLinks.begin(), datasetLinks.end(),
+                                    [&dataObjects](const DatasetLink& link) { return link.loadIndex >= dataObjects.size() || !WritesSharedStoreLink(dataObjects[link.loadIndex]); }),
+                     datasetLinks.end());
   {
     std::cout << "Writing DataStructure File ...  " << std::endl;
+    std::lock_guard<std::recursive_mutex> lock(GetH5LibraryMutex());
     Result<H5::FileWriter> result = H5::FileWriter::CreateFile(filePath);
     H5::FileWriter fileWriter = std::move(result.value());
+    SharedStoreLinkScope linkScope;
     herr_t err = dataGraph->writeHdf5(fileWriter);
   }
+
+  // Duplicates were written as empty placeholders; point them at the dataset that holds the values
+  if(!datasetLinks.empty())
+  {
+    std::lock_guard<std::recursive_mutex> lock(GetH5LibraryMutex());
+    const hid_t fileId = H5Fopen(filePath.string().c_str(), H5F_ACC_RDWR, H5P_DEFAULT);
+    size_t numLinked = 0;
+    for(const auto& [targetPath, linkPath, loadIndex] : datasetLinks)
+    {
+      if(fileId >= 0 && LinkH5Dataset(fileId, targetPath, linkPath))
+      {
+        numLinked++;
+      }
+      else
+      {
+        std::cout << "  Could not link " << linkPath << " to " << targetPath << std::endl;
+      }
+    }
+    if(fileId >= 0)
+    {
+      H5Fclose(fileId);
+    }
+    std::cout << "Linked " << numLinked << " duplicate datasets" << std::endl;
+  }
+
+  // A file that could not be hashed or loaded is left out of the manifest so the next run looks at it again
+  IngestManifest manifest;
+  for(size_t i = 0; i < currentFiles.size(); i++)
+  {
+    const bool loadFailed = loadIndices[i] >= dataObjects.size() || nullptr == dataObjects[loadIndices[i]];
+    if(!hashFailed[i] && !loadFailed)
+    {
+      manifest.insert(std::move(currentFiles[i]));
+    }
+  }
+  manifest.save(manifestPath);
+}
+
+/**
+ * @brief The format of a scan file: native endian T, decompressed when Resolve() picked a '.zst' or '.gz' file.
+ */
+template <typename T>
+RawSourceFormat ScanFileFormat(const fs::path& scanFilePath)
+{
+  return {GetDataType<T>(), k_NativeEndian, RawByteSource::CompressionFromPath(scanFilePath) != RawByteSource::Compression::None};
 }
 
-std::shared_ptr<DataStructure> CreateDataStructure()
+/**
+ * @brief Builds the Small IN100 DataStructure. The scan files are loaded through the given
+ * scheduler, so in its metadata-only mode the arrays are only described and nothing is read.
+ * @param ingestScheduler
+ * @param scanDirectory Holds the scan files, laid out like sandbox/test_data
+ * @return nullptr if a scan file could not be read.
+ */
+std::shared_ptr<DataStructure> CreateDataStructure(RawIngestScheduler& ingestScheduler, const fs::path& scanDirectory)
 {
   std::shared_ptr<DataStructure> dataGraph = std::shared_ptr<DataStructure>(new DataStructure);
 
@@ -165,29 +619,41 @@ std::shared_ptr<DataStructure> CreateDataStructure()
   complex::SizeVec3 imageGeomDims = {100, 100, 100};
   imageGeom->setDimensions(imageGeomDims); // Listed from slowest to fastest (Z, Y, X)
 
-  std::cout << "Creating Data Structure" << std::endl;
+  if(ingestScheduler.isLoggingEnabled())
+  {
+    std::cout << "Creating Data Structure" << std::endl;
+  }
   // Create some DataArrays; The DataStructure keeps a shared_ptr<> to the DataArray so DO NOT put
   // it into another shared_ptr<>
   std::vector<size_t> compDims = {1};
   size_t tupleCount = imageGeom->getNumberOfElements();
 
-  std::string filePath =  complex::unit_test::k_ComplexSourceDir.str() + "/sandbox/test_data/";
-
-  std::string fileName = "ConfidenceIndex.raw";
-  ReadFromFile<float>(filePath + fileName, "Confidence Index", dataGraph.get(), tupleCount, compDims, scanData->getId());
-
-  fileName = "FeatureIds.raw";
-  ReadFromFile<int32_t>(filePath + fileName, "FeatureIds", dataGraph.get(), tupleCount, compDims, scanData->getId());
-
-  fileName = "ImageQuality.raw";
-  ReadFromFile<float>(filePath + fileName, "Image Quality", dataGraph.get(), tupleCount, compDims, scanData->getId());
-
-  fileName = "Phases.raw";
-  ReadFromFile<int32_t>(filePath + fileName, "Phases", dataGraph.get(), tupleCount, compDims, scanData->getId());
-
-  fileName = "IPFColors.raw";
+  std::string filePath = scanDirectory.string() + "/";
+  // Filters are free to modify the scan data so map it privately; untouched pages stay shared with the page cache.
+  constexpr RawReadMode k_ScanReadMode = RawReadMode::MemoryMapCopyOnWrite;
+
+  // Each file may also be stored as '<name>.raw.zst' or '<name>.raw.gz'; RawByteSource::Resolve() picks whichever exists.
+  // Every file is read concurrently. The arrays are still inserted in this order so the DataObject ids do not change from run to run.
+  // Image Quality and Confidence Index always get summarized; do it while the bytes are being read.
+  constexpr size_t k_NumHistogramBins = 256;
+  const fs::path confidenceIndexPath = RawByteSource::Resolve(filePath + "ConfidenceIndex.raw");
+  const fs::path featureIdsPath = RawByteSource::Resolve(filePath + "FeatureIds.raw");
+  const fs::path imageQualityPath = RawByteSource::Resolve(filePath + "ImageQuality.raw");
+  const fs::path phasesPath = RawByteSource::Resolve(filePath + "Phases.raw");
+  const fs::path ipfColorsPath = RawByteSource::Resolve(filePath + "IPFColors.raw");
+  ingestScheduler.push_back<float>(confidenceIndexPath, "Confidence Index", tupleCount, compDims, scanData->getId(), k_ScanReadMode, k_NumHistogramBins, ScanFileFormat<float>(confidenceIndexPath));
+  ingestScheduler.push_back<int32_t>(featureIdsPath, "FeatureIds", tupleCount, compDims, scanData->getId(), k_ScanReadMode, 0, ScanFileFormat<int32_t>(featureIdsPath));
+  ingestScheduler.push_back<float>(imageQualityPath, "Image Quality", tupleCount, compDims, scanData->getId(), k_ScanReadMode, k_NumHistogramBins, ScanFileFormat<float>(imageQualityPath));
+  ingestScheduler.push_back<int32_t>(phasesPath, "Phases", tupleCount, compDims, scanData->getId(), k_ScanReadMode, 0, ScanFileFormat<int32_t>(phasesPath));
   compDims = {3};
-  ReadFromFile<uint8_t>(filePath + fileName, "IPF Colors", dataGraph.get(), tupleCount, compDims, scanData->getId());
+  // No filter reads the IPF Colors so they are only loaded if something touches them (e.g. the HDF5 writer).
+  ingestScheduler.push_back_deferred<uint8_t>(ipfColorsPath, "IPF Colors", tupleCount, compDims, scanData->getId(), k_ScanReadMode, ScanFileFormat<uint8_t>(ipfColorsPath));
+  std::vector<DataObject*> scanArrays = ingestScheduler.insertInto(*dataGraph);
+  if(std::count(scanArrays.begin(), scanArrays.end(), nullptr) > 0)
+  {
+    std::cout << "Could not read the scan files in " << scanDirectory.string() << std::endl;
+    return nullptr;
+  }
 
   // Add in another group that is just information about the grid data.
   DataGroup* phaseGroup = complex::DataGroup::Create(*dataGraph, "Phase Data", group->getId());
@@ -198,6 +664,60 @@ std::shared_ptr<DataStructure> CreateDataStructure()
   return dataGraph;
 }
 
+/**
+ * @brief Executes the pipeline over every scan directory with the plugins loaded once and
+ * writes each result to <binary dir>/batch/<directory name>.h5.
+ * @param pipeline
+ * @param scanDirectories
+ * @param residentBytes What one dataset needs in memory
+ * @param maxResidentBytes How much the datasets loaded at the same time may need together
+ * @param ioPool Reads the scan files. Must not be the pool the datasets run on.
+ * @return EXIT_SUCCESS if every dataset succeeded
+ */
+int32_t RunBatch(const Pipeline& pipeline, const std::vector<std::string>& scanDirectories, size_t residentBytes, size_t maxResidentBytes, ThreadPool& ioPool)
+{
+  const fs::path outputDirectory = fmt::format("{}/batch", complex::unit_test::k_ComplexBinaryDir);
+  std::error_code errorCode;
+  fs::create_directories(outputDirectory, errorCode);
+
+  std::vector<BatchDataset> datasets;
+  for(const std::string& scanDirectory : scanDirectories)
+  {
+    fs::path scanPath = fs::path(scanDirectory);
+    BatchDataset dataset;
+    dataset.name = (scanPath.has_filename() ? scanPath : scanPath.parent_path()).filename().string();
+    dataset.residentBytes = residentBytes;
+    dataset.load = [&ioPool, scanPath]() {
+      RawIngestScheduler ingestScheduler(ioPool);
+      ingestScheduler.setLoggingEnabled(false);
+      return CreateDataStructure(ingestScheduler, scanPath);
+    };
+    dataset.store = [filePath = outputDirectory / (dataset.name + ".h5")](const DataStructure& dataStructure) {
+      return WriteDataStructureHdf5(dataStructure, filePath, H5WriteOptions{});
+    };
+    datasets.push_back(std::move(dataset));
+  }
+
+  BatchOptions batchOptions;
+  batchOptions.maxResidentBytes = maxResidentBytes;
+  ThreadPool batchPool;
+  PipelineBatchRunner batchRunner(batchPool, batchOptions);
+  auto startTime = std::chrono::steady_clock::now();
+  std::vector<BatchResult> results = batchRunner.run(pipeline, datasets);
+  const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+  size_t numSucceeded = 0;
+  for(const BatchResult& result : results)
+  {
+    std::cout << fmt::format("  {}: {} in {:.3f} s {}", result.name, result.succeeded ? "done" : "FAILED", result.seconds, result.message) << std::endl;
+    numSucceeded += result.succeeded ? 1 : 0;
+  }
+  std::cout << fmt::format("Batch: {} of {} datasets succeeded in {:.3f} s, up to {} at once ({:.1f} MB admitted at the peak)", numSucceeded, results.size(), seconds,
+                           batchRunner.getMaxConcurrency(), static_cast<double>(batchRunner.getPeakResidentBytes()) / (1024.0 * 1024.0))
+            << std::endl;
+  return numSucceeded == results.size() ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
 using namespace complex;
 namespace fs = std::filesystem;
 
@@ -278,8 +798,16 @@ int32_t main(int32_t argc, char** args)
   PrintFiltersPerPlugin();
   //PrintAllFilters();
 
-  // Create a shared pointer to a DataStructure instance
-  std::shared_ptr<DataStructure> dataGraph = CreateDataStructure();
+  // Create a shared pointer to a DataStructure instance. Preflight only needs shapes and types, so the
+  // scan files are not read until the structure is promoted for execute.
+  ThreadPool threadPool;
+  RawIngestScheduler ingestScheduler(threadPool);
+  ingestScheduler.setMetadataOnly(true);
+  std::shared_ptr<DataStructure> dataGraph = CreateDataStructure(ingestScheduler, complex::unit_test::k_ComplexSourceDir.str() + "/sandbox/test_data");
+  if(nullptr == dataGraph)
+  {
+    return EXIT_FAILURE;
+  }
 
   // Create a Pipeline
   Pipeline pipeline;
@@ -326,8 +854,12 @@ int32_t main(int32_t argc, char** args)
 
   std::cout << "pipeline.size(): " << pipeline.size() << std::endl;
 
-  // Preflight the pipeline
-  bool passed = pipeline.preflight(*dataGraph);
+  // Preflight the pipeline on a copy since preflight adds the filters' outputs to the structure.
+  // Copying is cheap: the arrays' stores have not loaded anything yet.
+  // Every filter's preflight and execution is timed; the trace is written next to the other outputs.
+  DataStructure preflightGraph = *dataGraph;
+  PipelineTracer tracer;
+  bool passed = tracer.preflight(pipeline, preflightGraph);
   std::cout << "Preflight Result: " << (passed ? "true" : "false") << std::endl;
   if(!passed)
   {
@@ -356,31 +888,151 @@ int32_t main(int32_t argc, char** args)
    // return EXIT_FAILURE;
   }
 
-  dataGraph = CreateDataStructure();
-  passed = pipeline.execute(*dataGraph);
+  // "sandbox --batch [--max-resident-mb=N] <scan directory>..." runs the pipeline over each directory of scan files
+  // instead; the preflight above tells how much memory one of them needs.
+  if(argc > 2 && std::string(args[1]) == "--batch")
+  {
+    if(!passed)
+    {
+      return EXIT_FAILURE;
+    }
+    const std::string k_MaxResidentOption = "--max-resident-mb=";
+    size_t maxResidentBytes = BatchOptions().maxResidentBytes;
+    int32_t firstDirectory = 2;
+    if(std::string(args[2]).rfind(k_MaxResidentOption, 0) == 0)
+    {
+      maxResidentBytes = std::stoull(std::string(args[2]).substr(k_MaxResidentOption.size())) * 1024 * 1024;
+      firstDirectory = 3;
+    }
+    return RunBatch(pipeline, std::vector<std::string>(args + firstDirectory, args + argc), PipelineBatchRunner::EstimateResidentBytes(preflightGraph), maxResidentBytes, threadPool);
+  }
+
+  // A plain run executes the filters one after another. "--checkpoint" saves the DataStructure after every filter and
+  // "--resume" continues after the last one that finished. "--filter-cache" keeps filter results on disk between runs and
+  // "--spill" writes intermediate arrays to disk once no later filter reads them. "--parallel" runs filters that touch
+  // disjoint DataPaths concurrently instead (without checkpoints).
+  const std::set<std::string> options(args + 1, args + argc);
+  const bool resume = (options.count("--resume") > 0);
+  const bool parallel = (options.count("--parallel") > 0);
+  CheckpointPolicy checkpointPolicy;
+  if(resume || options.count("--checkpoint") > 0)
+  {
+    checkpointPolicy.directory = fs::path(fmt::format("{}/pipeline_checkpoints", complex::unit_test::k_ComplexBinaryDir));
+  }
+  PipelineCheckpointer checkpointer(checkpointPolicy);
+  // Filters whose uuid, arguments and inputs match an earlier run restore that run's outputs instead of executing.
+  // Only filters whose outputs depend on nothing else are listed.
+  std::unique_ptr<FilterResultCache> resultCache;
+  if(options.count("--filter-cache") > 0)
+  {
+    FilterCacheOptions cacheOptions;
+    cacheOptions.directory = fs::path(fmt::format("{}/filter_cache", complex::unit_test::k_ComplexBinaryDir));
+    cacheOptions.cacheableFilters = {complex::ComplexCore::k_CreateDataArrayHandle.getFilterId(), complex::ComplexCore::k_ImportTextFilterHandle.getFilterId()};
+    resultCache = std::make_unique<FilterResultCache>(cacheOptions);
+  }
+  checkpointer.setResultCache(resultCache.get());
+  checkpointer.setTracer(&tracer);
+  // "Fit" is the pipeline's output and stays for the HDF5 writer below. Nothing is released if the analysis fails.
+  PipelineLiveness* livenessPtr = nullptr;
+  std::unique_ptr<PipelineLiveness> liveness;
+  if(options.count("--spill") > 0)
+  {
+    LivenessPolicy livenessPolicy;
+    livenessPolicy.mode = ArrayReleaseMode::Spill;
+    livenessPolicy.spillDirectory = fs::path(fmt::format("{}/pipeline_spill", complex::unit_test::k_ComplexBinaryDir));
+    livenessPolicy.outputs = {outputDataPath};
+    liveness = std::make_unique<PipelineLiveness>(livenessPolicy);
+    livenessPtr = liveness->analyze(pipeline, *dataGraph) ? liveness.get() : nullptr;
+  }
+  checkpointer.setLiveness(livenessPtr);
+  // A resumed run hashes the scan data to check that the checkpoint was made from it, so it is read either way
+  if(!ingestScheduler.promote(*dataGraph))
+  {
+    std::cout << "Could not read the scan data" << std::endl;
+    return EXIT_FAILURE;
+  }
+  if(parallel)
+  {
+    ParallelPipelineExecutor parallelExecutor(threadPool);
+    parallelExecutor.setResultCache(resultCache.get());
+    parallelExecutor.setTracer(&tracer);
+    parallelExecutor.setLiveness(livenessPtr);
+    passed = parallelExecutor.execute(pipeline, *dataGraph);
+    std::cout << "Filters executed concurrently: up to " << parallelExecutor.getMaxConcurrency() << std::endl;
+  }
+  else
+  {
+    passed = resume ? checkpointer.resume(pipeline, *dataGraph) : checkpointer.execute(pipeline, *dataGraph);
+  }
   std::cout << "Execute Result: " << static_cast<int32_t>(passed) << std::endl;
+  if(nullptr != resultCache)
+  {
+    const FilterCacheStatistics cacheStatistics = resultCache->getStatistics();
+    std::cout << "Filter cache: " << cacheStatistics.hits << " hits (" << cacheStatistics.diskHits << " from disk), " << cacheStatistics.misses << " misses, " << cacheStatistics.uncacheable
+              << " uncacheable, " << cacheStatistics.diskBytes << " bytes on disk" << std::endl;
+  }
+  if(nullptr != livenessPtr)
+  {
+    std::cout << "Released " << livenessPtr->getReleasedArrayCount() << " intermediate arrays (" << livenessPtr->getReleasedBytes() << " bytes) after their last reader" << std::endl;
+  }
+  for(const FilterTraceEvent& event : tracer.getEvents())
+  {
+    if(event.phase == FilterTraceEvent::Phase::Execute)
+    {
+      std::cout << "  " << event.index << " " << event.name << ": " << event.wallMicroseconds / 1000.0 << " ms, " << event.arraysCreated << " arrays created" << std::endl;
+    }
+  }
+  tracer.writeChromeTrace(fmt::format("{}/pipeline_trace.json", complex::unit_test::k_ComplexBinaryDir));
+
+  // The DataStructure is final now; write it on the I/O thread and only wait for it before the file is read back
+  AsyncH5Writer h5Writer;
+  fs::path filePath = fmt::format("{}/image_geometry_io.h5", complex::unit_test::k_ComplexBinaryDir);
+  std::future<bool> written;
+  {
+    std::cout << "Writing DataStructure File in the background ...  " << std::endl;
+    // One compressed chunk per Z-slice so slice-wise readers only decompress the slices they touch
+    H5WriteOptions writeOptions;
+    writeOptions.compression = H5Compression::Deflate;
+    if(const auto* imageGeom = dataGraph->getDataAs<ImageGeom>(DataPath({"Small IN100", "EBSD Scan Data", "Small IN100 Grid"})); nullptr != imageGeom)
+    {
+      writeOptions = H5WriteOptions::ForImageGeom(*imageGeom, H5Compression::Deflate);
+    }
+    written = h5Writer.write(dataGraph, filePath, writeOptions);
+  }
 
   DataObject* outputDataObject = dataGraph->getData(outputDataPath);
   std::cout << "Inserted DataObject: " << outputDataObject->getName() << " as a " << outputDataObject->getTypeName() << std::endl;
 
-  fs::path filePath = fmt::format("{}/image_geometry_io.h5", complex::unit_test::k_ComplexBinaryDir);
+  if(!written.get())
   {
-    std::cout << "Writing DataStructure File ...  " << std::endl;
-    Result<H5::FileWriter> result = H5::FileWriter::CreateFile(filePath);
-    H5::FileWriter fileWriter = std::move(result.value());
-    herr_t err = dataGraph->writeHdf5(fileWriter);
+    return EXIT_FAILURE;
   }
 
   {
-    auto fileReader = H5::FileReader(filePath);
-    herr_t err;
-    auto ds = DataStructure::readFromHdf5(fileReader, err);
-    std::cout << "Read Data Structure from HDF5 file: " << ds.getSize() << std::endl;
-    for(const auto& thing : ds)
+    // Listing the objects only needs the metadata; array values stay on disk until something reads them
+    auto startTime = std::chrono::steady_clock::now();
+    std::shared_ptr<DataStructure> ds = ReadDataStructureHdf5Lazy(filePath);
+    if(nullptr == ds)
+    {
+      return EXIT_FAILURE;
+    }
+    const double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+    std::cout << "Read Data Structure from HDF5 file: " << ds->getSize() << " objects in " << milliseconds << " ms" << std::endl;
+    for(const auto& thing : *ds)
     {
       std::cout << thing.second->getName() << std::endl;
     }
   }
 
+  {
+    // Pull just a region of interest out of the stored grid; only its voxels are read from disk
+    const ImageGeomBounds regionOfInterest = {{25, 25, 25}, {74, 74, 74}};
+    std::shared_ptr<DataStructure> subvolume = ReadImageGeomSubvolume(filePath, DataPath({"Small IN100", "EBSD Scan Data", "Small IN100 Grid"}), regionOfInterest);
+    if(nullptr != subvolume)
+    {
+      std::cout << "Read subvolume DataStructure: " << subvolume->getSize() << " objects" << std::endl;
+    }
+  }
+
   return 0;
 }
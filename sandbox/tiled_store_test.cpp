@@ -0,0 +1,168 @@
+/**
+ * Hammers one TiledDataStore from several threads through a TileCache that only holds a
+ * few tiles, so tiles are evicted and paged back in while other threads read and write
+ * them. Every thread owns an interleaved set of values (one value out of every
+ * k_NumThreads) so each tile is shared by all threads. Returns non-zero on any mismatch.
+ */
+
+#include "TiledDataStore.hpp"
+
+#include "sandbox_test_dirs.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+using namespace complex;
+
+namespace
+{
+constexpr size_t k_NumThreads = 8;
+constexpr size_t k_NumValues = 64 * 1024;
+constexpr size_t k_ValuesPerTile = 1024;
+constexpr size_t k_ResidentTiles = 3;
+constexpr size_t k_NumPasses = 4;
+
+uint32_t ExpectedValue(size_t index, size_t pass)
+{
+  return static_cast<uint32_t>(index * 7 + pass);
+}
+
+// -----------------------------------------------------------------------------
+bool WriteSourceFile(const fs::path& filePath)
+{
+  std::vector<uint32_t> values(k_NumValues);
+  for(size_t i = 0; i < k_NumValues; i++)
+  {
+    values[i] = static_cast<uint32_t>(i);
+  }
+  std::ofstream stream(filePath, std::ios::out | std::ios::binary | std::ios::trunc);
+  stream.write(reinterpret_cast<const char*>(values.data()), static_cast<std::streamsize>(values.size() * sizeof(uint32_t)));
+  return stream.good();
+}
+
+/**
+ * @brief Each thread checks the previous pass's value, writes the next one, and
+ * re-reads it through both getValue() and operator[].
+ */
+size_t RunThreads(TiledDataStore<uint32_t>& store)
+{
+  std::atomic<size_t> numErrors = 0;
+  std::vector<std::thread> threads;
+  for(size_t threadIndex = 0; threadIndex < k_NumThreads; threadIndex++)
+  {
+    threads.emplace_back([&store, &numErrors, threadIndex]() {
+      for(size_t pass = 0; pass < k_NumPasses; pass++)
+      {
+        for(size_t i = threadIndex; i < k_NumValues; i += k_NumThreads)
+        {
+          const uint32_t previous = (pass == 0) ? static_cast<uint32_t>(i) : ExpectedValue(i, pass - 1);
+          if(store.getValue(i) != previous)
+          {
+            numErrors++;
+          }
+          store.setValue(i, ExpectedValue(i, pass));
+          const TiledDataStore<uint32_t>& constStore = store;
+          if(constStore[i] != ExpectedValue(i, pass) || store.getValue(i) != ExpectedValue(i, pass))
+          {
+            numErrors++;
+          }
+        }
+      }
+    });
+  }
+  for(auto& thread : threads)
+  {
+    thread.join();
+  }
+  return numErrors;
+}
+
+// -----------------------------------------------------------------------------
+size_t CountMismatches(const TiledDataStore<uint32_t>& store, size_t pass)
+{
+  std::vector<uint32_t> values(k_NumValues);
+  store.copyTo(0, values.size(), values.data());
+  size_t numErrors = 0;
+  for(size_t i = 0; i < k_NumValues; i++)
+  {
+    if(values[i] != ExpectedValue(i, pass))
+    {
+      numErrors++;
+    }
+  }
+  return numErrors;
+}
+} // namespace
+
+// -----------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+  const fs::path testDir = fs::path(unit_test::k_ComplexBinaryDir.str()) / "tiled_store_test";
+  fs::create_directories(testDir);
+  const fs::path sourcePath = testDir / "source.raw";
+  if(!WriteSourceFile(sourcePath))
+  {
+    std::cout << "Could not write " << sourcePath.string() << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  auto tileCache = std::make_shared<TileCache>(k_ResidentTiles * k_ValuesPerTile * sizeof(uint32_t));
+  auto store = TiledDataStore<uint32_t>::Open(sourcePath, {k_NumValues}, {1}, tileCache, k_ValuesPerTile);
+  if(nullptr == store)
+  {
+    std::cout << "Could not open " << sourcePath.string() << " as a TiledDataStore" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  int result = EXIT_SUCCESS;
+  const size_t threadErrors = RunThreads(*store);
+  std::cout << "Concurrent get/set: " << threadErrors << " mismatches, " << tileCache->getEvictionCount() << " evictions" << std::endl;
+  if(threadErrors != 0 || tileCache->getEvictionCount() == 0)
+  {
+    result = EXIT_FAILURE;
+  }
+
+  const size_t finalErrors = CountMismatches(*store, k_NumPasses - 1);
+  std::cout << "Final values: " << finalErrors << " mismatches" << std::endl;
+  if(finalErrors != 0)
+  {
+    result = EXIT_FAILURE;
+  }
+
+  // The copy must see the modified tiles that were spilled to the scratch file
+  auto copy = store->deepCopy();
+  auto* tiledCopy = dynamic_cast<TiledDataStore<uint32_t>*>(copy.get());
+  const size_t copyErrors = (nullptr == tiledCopy) ? k_NumValues : CountMismatches(*tiledCopy, k_NumPasses - 1);
+  std::cout << "Deep copy: " << copyErrors << " mismatches" << std::endl;
+  if(copyErrors != 0)
+  {
+    result = EXIT_FAILURE;
+  }
+
+  // The raw file itself is never modified
+  std::ifstream source(sourcePath, std::ios::in | std::ios::binary);
+  uint32_t lastValue = 0;
+  source.seekg(static_cast<std::streamoff>((k_NumValues - 1) * sizeof(uint32_t)));
+  source.read(reinterpret_cast<char*>(&lastValue), sizeof(lastValue));
+  if(lastValue != k_NumValues - 1)
+  {
+    std::cout << "The source file was modified" << std::endl;
+    result = EXIT_FAILURE;
+  }
+
+  copy.reset();
+  store.reset();
+  std::error_code errorCode;
+  fs::remove_all(testDir, errorCode);
+  std::cout << (result == EXIT_SUCCESS ? "PASSED" : "FAILED") << std::endl;
+  return result;
+}